@@ -24,7 +24,8 @@ enum ObjectTypeId
 {
 	ObjectPoly,
 	ObjectSource,
-	ObjectPlain
+	ObjectPlain,
+	ObjectIndexedPoly //a poly object with a shared table of vertices referenced by the faces by indices
 };
 
 enum class ConstantDomainDataId
@@ -218,6 +218,4 @@ private:
 	buf_istream_buf m_buf;
 };
 
-std::string encode_string(const std::wstring& str);
-
 #endif // IMPL_BUF_OSTREAM_H
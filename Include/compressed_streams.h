@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <list>
+#include <future>
+#include <binary_streams.h>
+#include <mapped_file.h>
+
+#ifndef CONVERTERS_COMPRESSED_STREAMS_H
+#define CONVERTERS_COMPRESSED_STREAMS_H
+
+//A compressed stream is a sequence of blocks of COMPRESSED_BLOCK_SIZE bytes of the data (the last one may be shorter) compressed
+//independently of each other, so that any block can be read without reading the preceding ones. Layout:
+//	header: COMPRESSED_STREAM_MAGIC, COMPRESSED_STREAM_FORMAT_VERSION (uint32), block size (uint32)
+//	compressed blocks
+//	block table: position of the block relative to the header (uint64), size of the compressed block (uint32), compression
+//		method (uint32) for each block
+//	patch table: position in the data (uint64), size (uint32) and the bytes of each patch, applied in the order of the table
+//	footer: size of the data (uint64), positions of the block and the patch tables (uint64), block count (uint32), patch count
+//		(uint32), COMPRESSED_STREAM_FORMAT_VERSION (uint32), COMPRESSED_STREAM_MAGIC
+//Patches hold the data written to the blocks which have been compressed already (e.g. sizes written back by seekp).
+
+constexpr char COMPRESSED_STREAM_MAGIC[4] = {'X', '2', 'B', 'Z'};
+constexpr std::uint32_t COMPRESSED_STREAM_FORMAT_VERSION = 1;
+constexpr std::size_t COMPRESSED_BLOCK_SIZE = std::size_t(1) << 20;
+
+//compresses the data written to it block by block in parallel and writes the compressed stream to the underlying stream, which
+//must be empty. finish() must be called after the last write, otherwise the compressed stream is incomplete.
+class compressed_ostream:public binary_ostream
+{
+	struct compressed_block
+	{
+		std::vector<std::uint8_t> data;
+		std::uint32_t method;
+	};
+	struct block_entry
+	{
+		std::uint64_t pos;
+		std::uint32_t size;
+		std::uint32_t method;
+	};
+	struct patch
+	{
+		std::uint64_t pos;
+		std::vector<std::uint8_t> data;
+	};
+	binary_ostream* m_pOs;
+	pos_type m_base; //position of the header in the underlying stream
+	std::vector<std::uint8_t> m_block; //the block being written
+	std::uint64_t m_block_pos = 0; //position of the block being written in the data
+	std::uint64_t m_pos = 0;
+	std::list<std::future<compressed_block>> m_lstPending; //blocks being compressed in the order of the stream
+	std::size_t m_cMaxPending;
+	std::vector<block_entry> m_vBlocks; //blocks written to the underlying stream
+	std::list<patch> m_lstPatches;
+	bool m_fFinished = false;
+
+	void seal_block();
+	void write_pending_block();
+public:
+	explicit compressed_ostream(binary_ostream& os);
+	compressed_ostream(const compressed_ostream&) = delete;
+	compressed_ostream& operator=(const compressed_ostream&) = delete;
+	compressed_ostream& write(const void* pInput, std::size_t cbHowMany);
+	pos_type tellp() const;
+	compressed_ostream& seekp(pos_type pos);
+	compressed_ostream& seekp(std::ptrdiff_t off, std::ios_base::seekdir dir);
+	//compresses the rest of the data and writes the tables. The stream must not be written afterwards.
+	void finish();
+};
+
+//provides random access to the blocks of a compressed stream stored in a file
+class compressed_file
+{
+	struct block_entry
+	{
+		std::uint64_t pos;
+		std::uint32_t size;
+		std::uint32_t method;
+	};
+	struct patch_entry
+	{
+		std::uint64_t pos;
+		const std::uint8_t* pData;
+		std::uint32_t size;
+	};
+	mapped_file m_file;
+	std::string m_strPath;
+	std::uint64_t m_cbData;
+	std::size_t m_cbBlock;
+	std::vector<block_entry> m_vBlocks;
+	std::vector<patch_entry> m_vPatches;
+public:
+	explicit compressed_file(const std::string& strPath); //throws std::runtime_error, if the file is not a valid compressed stream
+	//checks the header only
+	static bool is_compressed_file(const std::string& strPath);
+	inline std::uint64_t size() const noexcept
+	{
+		return m_cbData;
+	}
+	inline std::size_t block_size() const noexcept
+	{
+		return m_cbBlock;
+	}
+	inline std::size_t block_count() const noexcept
+	{
+		return m_vBlocks.size();
+	}
+	//decompresses the block to pOut, which must be large enough for block_size() bytes. Returns the size of the block.
+	std::size_t read_block(std::size_t iBlock, void* pOut) const;
+	//decompresses all blocks in parallel
+	std::vector<std::uint8_t> read_all() const;
+};
+
+#endif //CONVERTERS_COMPRESSED_STREAMS_H
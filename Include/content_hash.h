@@ -0,0 +1,46 @@
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <type_traits>
+
+#ifndef CONVERTERS_CONTENT_HASH_H
+#define CONVERTERS_CONTENT_HASH_H
+
+//64-bit FNV-1a
+class content_hash
+{
+	static constexpr std::size_t READ_BLOCK = std::size_t(1) << 20;
+	std::uint64_t m_hash = 14695981039346656037ull;
+public:
+	content_hash& add(const void* pData, std::size_t cbData) noexcept
+	{
+		auto pBytes = static_cast<const std::uint8_t*>(pData);
+		for (std::size_t i = 0; i < cbData; ++i)
+			m_hash = (m_hash ^ pBytes[i]) * 1099511628211ull;
+		return *this;
+	}
+	template <class T>
+	auto add(const T& val) noexcept -> std::enable_if_t<std::is_arithmetic_v<T>, content_hash&>
+	{
+		return this->add(std::addressof(val), sizeof(T));
+	}
+	//adds the whole stream contents and rewinds the stream
+	content_hash& add(std::istream& is)
+	{
+		auto pBuf = std::make_unique<char[]>(READ_BLOCK);
+		is.clear();
+		is.seekg(0, std::ios_base::beg);
+		while (is.read(pBuf.get(), READ_BLOCK) || is.gcount() > 0)
+			this->add(pBuf.get(), std::size_t(is.gcount()));
+		is.clear();
+		is.seekg(0, std::ios_base::beg);
+		return *this;
+	}
+	inline std::uint64_t value() const noexcept
+	{
+		return m_hash;
+	}
+};
+
+#endif //CONVERTERS_CONTENT_HASH_H
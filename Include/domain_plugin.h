@@ -0,0 +1,98 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CONVERTERS_DOMAIN_PLUGIN_H_
+#define CONVERTERS_DOMAIN_PLUGIN_H_
+
+/*
+C interface of the domain converters loaded by xml2bin at runtime (see xml2bin --domain_plugin). A plugin is a shared object
+(a DLL on Windows) exporting the entry point CAMAAS_DOMAIN_PLUGIN_ENTRY of the type camaas_domain_plugin_entry_fn, which fills in
+the description of the converter of a domain.
+
+The data are passed by spans and never as C++ types:
+ - the domain data to convert are the UTF-8 text of the XML between the opening and the closing domain tags, as it is in the input
+   (the entities are not expanded). The text is usually a view of the buffer of the input stream and is valid during the call only.
+ - the converted data are written to the memory of the host obtained by camaas_domain_output::append.
+*/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*incremented whenever the layout or the semantics of the structures or the functions change*/
+#define CAMAAS_DOMAIN_PLUGIN_ABI_VERSION 2u
+#define CAMAAS_DOMAIN_PLUGIN_ENTRY "camaas_domain_plugin_entry"
+
+#ifdef _WIN32
+#define CAMAAS_DOMAIN_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define CAMAAS_DOMAIN_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+typedef struct camaas_text
+{
+	const char* data;
+	size_t size;
+} camaas_text;
+
+/*appends size bytes to the converted data and returns the pointer to them to be written by the plugin, or null, if the memory
+cannot be allocated. The pointer is valid until the next call or the return from the conversion.*/
+typedef unsigned char* (*camaas_append_fn)(void* context, size_t size);
+
+typedef struct camaas_domain_output
+{
+	void* context;
+	camaas_append_fn append;
+} camaas_domain_output;
+
+/*results of the conversion functions*/
+#define CAMAAS_DOMAIN_DATA_CONVERTED 0 /*the data have been written to the output*/
+#define CAMAAS_DOMAIN_DATA_UNSUPPORTED 1 /*the domain has no data of the kind, the data are discarded*/
+#define CAMAAS_DOMAIN_DATA_INVALID 2 /*the text does not specify valid domain data, see camaas_domain_plugin::last_error*/
+
+/*ids of the constant domain data of the HGT surfaces*/
+#define CAMAAS_CONSTANT_SURFACE_LAND 0u
+#define CAMAAS_CONSTANT_SURFACE_WATER 1u
+
+/*capabilities of the plugins, see camaas_domain_plugin::flags*/
+/*The conversion functions are pure: the result and the data written depend on the text only, not on the preceding calls, the
+order of the domain data in the input or any other state. The host converts the repeated identical domain data once then and
+writes the same converted data for each of them. Without the flag, the domain data are always converted one by one.*/
+#define CAMAAS_DOMAIN_PLUGIN_DETERMINISTIC 0x1u
+
+/*Converts the text of domain data. Unless the plugin sets CAMAAS_DOMAIN_PLUGIN_DETERMINISTIC, the function is called for each
+domain data of the input in order, and can depend on the preceding calls.*/
+typedef int (*camaas_convert_fn)(void* converter, camaas_text text, const camaas_domain_output* output);
+typedef int (*camaas_constant_fn)(void* converter, uint32_t id, const camaas_domain_output* output);
+
+typedef struct camaas_domain_plugin
+{
+	const char* domain_name; /*UTF-8, valid until release*/
+	void* converter; /*passed to the functions*/
+	/*a function is null, if the domain has no data of the kind*/
+	camaas_convert_fn model_domain_data;
+	camaas_convert_fn poly_domain_data;
+	camaas_convert_fn face_domain_data;
+	camaas_convert_fn source_domain_data;
+	camaas_convert_fn plain_domain_data;
+	camaas_constant_fn constant_poly_domain_data;
+	camaas_constant_fn constant_face_domain_data;
+	camaas_constant_fn constant_source_domain_data;
+	camaas_constant_fn constant_plain_domain_data;
+	/*UTF-8 description of the last CAMAAS_DOMAIN_DATA_INVALID result, valid until the next call. Can be null.*/
+	const char* (*last_error)(void* converter);
+	/*called before the shared object is unloaded. Can be null.*/
+	void (*release)(void* converter);
+	/*combination of the CAMAAS_DOMAIN_PLUGIN_* capabilities, zero if there are none*/
+	uint32_t flags;
+} camaas_domain_plugin;
+
+/*fills in the plugin and returns zero, if the plugin implements the ABI version of the host, or a non-zero value otherwise*/
+typedef int (*camaas_domain_plugin_entry_fn)(uint32_t abi_version, camaas_domain_plugin* plugin);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*CONVERTERS_DOMAIN_PLUGIN_H_*/
@@ -0,0 +1,36 @@
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#ifndef CONVERTERS_MAPPED_FILE_H
+#define CONVERTERS_MAPPED_FILE_H
+
+//Read-only memory mapping of a whole file
+class mapped_file
+{
+public:
+	mapped_file() = default;
+	explicit mapped_file(const std::string& strPath); //throws std::runtime_error, if the file cannot be mapped
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+	mapped_file(mapped_file&& right) noexcept;
+	mapped_file& operator=(mapped_file&& right) noexcept;
+	~mapped_file();
+	inline const std::uint8_t* data() const noexcept
+	{
+		return m_pData;
+	}
+	inline std::size_t size() const noexcept
+	{
+		return m_cbData;
+	}
+private:
+	const std::uint8_t* m_pData = nullptr;
+	std::size_t m_cbData = 0;
+#ifdef _WIN32
+	void* m_hMapping = nullptr;
+#endif
+	void unmap() noexcept;
+};
+
+#endif //CONVERTERS_MAPPED_FILE_H
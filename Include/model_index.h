@@ -0,0 +1,39 @@
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <content_hash.h>
+
+#ifndef CONVERTERS_MODEL_INDEX_H
+#define CONVERTERS_MODEL_INDEX_H
+
+//An optional index of the objects appended to a binary model after the objects (see xml2bin --object_index). Readers which walk the
+//objects sequentially stop before the index, hence the models having it remain readable by them. Layout:
+//	object_count entries: position of the object relative to the beginning of the model (uint64), size of the object in bytes (uint64)
+//	bucket_count buckets of the name table: index of a named object plus one (uint32), zero if the bucket is empty. A name is placed
+//		into the first empty bucket starting from model_index_name_hash(name) modulo bucket_count (linear probing). Unnamed objects
+//		are not in the table.
+//	footer: position of the index relative to the beginning of the model (uint64), object count (uint32), bucket count (uint32),
+//		MODEL_INDEX_FORMAT_VERSION (uint32), MODEL_INDEX_MAGIC
+//The footer ends the file, so that a reader locates the index from the end of the file.
+
+constexpr char MODEL_INDEX_MAGIC[4] = {'X', '2', 'B', 'I'};
+constexpr std::uint32_t MODEL_INDEX_FORMAT_VERSION = 1;
+constexpr std::size_t MODEL_INDEX_ENTRY_SIZE = 2 * sizeof(std::uint64_t);
+constexpr std::size_t MODEL_INDEX_BUCKET_SIZE = sizeof(std::uint32_t);
+constexpr std::size_t MODEL_INDEX_FOOTER_SIZE = sizeof(std::uint64_t) + 3 * sizeof(std::uint32_t) + sizeof(MODEL_INDEX_MAGIC);
+
+inline std::uint64_t model_index_name_hash(std::string_view strName) noexcept
+{
+	return content_hash().add(strName.data(), strName.size()).value();
+}
+
+//a power of two at least twice as large as the number of the named objects
+inline std::uint32_t model_index_bucket_count(std::size_t cNamed) noexcept
+{
+	std::uint32_t cBuckets = 1;
+	while (cBuckets < 2 * cNamed)
+		cBuckets <<= 1;
+	return cBuckets;
+}
+
+#endif //CONVERTERS_MODEL_INDEX_H
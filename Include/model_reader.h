@@ -0,0 +1,398 @@
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <optional>
+#include <iterator>
+#include <basedefs.h>
+#include <point.h>
+#include <mapped_file.h>
+
+#ifndef CONVERTERS_MODEL_READER_H
+#define CONVERTERS_MODEL_READER_H
+
+//Views of the parts of a binary model written by xml2bin. They reference the mapped (or decompressed) data of model_reader and
+//remain valid as long as the reader exists. The data is not aligned, hence values are copied out rather than referenced.
+
+namespace Implementation
+{
+	template <class T>
+	inline T read_model_value(const std::uint8_t* pData) noexcept
+	{
+		T val;
+		std::memcpy(&val, pData, sizeof(T));
+		return val;
+	}
+	const std::uint8_t* skip_model_domain_data(const std::uint8_t* pData) noexcept;
+}
+
+//a serialized point: the number of coordinates (3) followed by the coordinates
+constexpr std::size_t MODEL_POINT_SIZE = sizeof(std::uint32_t) + 3 * sizeof(double);
+
+class model_points_view
+{
+	const std::uint8_t* m_pData = nullptr;
+	std::size_t m_cPoints = 0;
+public:
+	model_points_view() = default;
+	model_points_view(const std::uint8_t* pData, std::size_t cPoints) noexcept:m_pData(pData), m_cPoints(cPoints) {}
+	inline std::size_t size() const noexcept
+	{
+		return m_cPoints;
+	}
+	inline bool empty() const noexcept
+	{
+		return m_cPoints == 0;
+	}
+	inline point_t operator[](std::size_t i) const noexcept
+	{
+		auto pCoords = m_pData + i * MODEL_POINT_SIZE + sizeof(std::uint32_t);
+		return {Implementation::read_model_value<double>(pCoords), Implementation::read_model_value<double>(pCoords + sizeof(double)),
+			Implementation::read_model_value<double>(pCoords + 2 * sizeof(double))};
+	}
+};
+
+class model_indices_view
+{
+	const std::uint8_t* m_pData = nullptr;
+	std::size_t m_cIndices = 0;
+public:
+	model_indices_view() = default;
+	model_indices_view(const std::uint8_t* pData, std::size_t cIndices) noexcept:m_pData(pData), m_cIndices(cIndices) {}
+	inline std::size_t size() const noexcept
+	{
+		return m_cIndices;
+	}
+	inline bool empty() const noexcept
+	{
+		return m_cIndices == 0;
+	}
+	inline std::uint32_t operator[](std::size_t i) const noexcept
+	{
+		return Implementation::read_model_value<std::uint32_t>(m_pData + i * sizeof(std::uint32_t));
+	}
+};
+
+struct model_domain_datum
+{
+	std::string_view domain;
+	const std::uint8_t* data;
+	std::size_t size;
+};
+
+//domain data map: a sequence of the domain names with the opaque data, ordered by the names
+class model_domain_data_view
+{
+	const std::uint8_t* m_pData = nullptr; //points to the number of entries
+public:
+	class const_iterator
+	{
+		const std::uint8_t* m_pEntry = nullptr;
+		std::uint32_t m_iEntry = 0;
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef model_domain_datum value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const model_domain_datum* pointer;
+		typedef model_domain_datum reference;
+
+		const_iterator() = default;
+		const_iterator(const std::uint8_t* pEntry, std::uint32_t iEntry) noexcept:m_pEntry(pEntry), m_iEntry(iEntry) {}
+		model_domain_datum operator*() const noexcept
+		{
+			auto cbDomain = Implementation::read_model_value<std::uint32_t>(m_pEntry);
+			auto pData = m_pEntry + sizeof(std::uint32_t) + cbDomain;
+			return {std::string_view(reinterpret_cast<const char*>(m_pEntry + sizeof(std::uint32_t)), cbDomain), pData + sizeof(std::uint32_t),
+				Implementation::read_model_value<std::uint32_t>(pData)};
+		}
+		const_iterator& operator++() noexcept
+		{
+			auto entry = **this;
+			m_pEntry = entry.data + entry.size;
+			++m_iEntry;
+			return *this;
+		}
+		const_iterator operator++(int) noexcept
+		{
+			auto it = *this;
+			++*this;
+			return it;
+		}
+		bool operator==(const const_iterator& right) const noexcept
+		{
+			return m_iEntry == right.m_iEntry;
+		}
+		bool operator!=(const const_iterator& right) const noexcept
+		{
+			return m_iEntry != right.m_iEntry;
+		}
+	};
+	model_domain_data_view() = default;
+	explicit model_domain_data_view(const std::uint8_t* pData) noexcept:m_pData(pData) {}
+	inline std::size_t size() const noexcept
+	{
+		return m_pData?Implementation::read_model_value<std::uint32_t>(m_pData):0;
+	}
+	inline bool empty() const noexcept
+	{
+		return this->size() == 0;
+	}
+	inline const_iterator begin() const noexcept
+	{
+		return const_iterator(m_pData?m_pData + sizeof(std::uint32_t):nullptr, 0);
+	}
+	inline const_iterator end() const noexcept
+	{
+		return const_iterator(nullptr, std::uint32_t(this->size()));
+	}
+	std::optional<model_domain_datum> find(std::string_view strDomain) const noexcept
+	{
+		for (auto datum:*this)
+		{
+			if (datum.domain == strDomain)
+				return datum;
+		}
+		return std::nullopt;
+	}
+	//points past the map
+	inline const std::uint8_t* end_data() const noexcept
+	{
+		return Implementation::skip_model_domain_data(m_pData);
+	}
+};
+
+//a face of a poly object specifies the coordinates of its vertices, a face of an indexed poly object specifies the indices of its
+//vertices in the table of the object
+class model_face_view
+{
+	const std::uint8_t* m_pData = nullptr;
+	bool m_fIndexed = false;
+public:
+	model_face_view() = default;
+	model_face_view(const std::uint8_t* pData, bool fIndexed) noexcept:m_pData(pData), m_fIndexed(fIndexed) {}
+	inline bool is_indexed() const noexcept
+	{
+		return m_fIndexed;
+	}
+	inline std::size_t vertex_count() const noexcept
+	{
+		return Implementation::read_model_value<std::uint32_t>(m_pData);
+	}
+	//empty for the faces of indexed poly objects
+	inline model_points_view vertices() const noexcept
+	{
+		return m_fIndexed?model_points_view():model_points_view(m_pData + sizeof(std::uint32_t), this->vertex_count());
+	}
+	//empty for the faces of poly objects
+	inline model_indices_view indices() const noexcept
+	{
+		return m_fIndexed?model_indices_view(m_pData + sizeof(std::uint32_t), this->vertex_count()):model_indices_view();
+	}
+	inline model_domain_data_view domain_data() const noexcept
+	{
+		return model_domain_data_view(m_pData + sizeof(std::uint32_t) + this->vertex_count() * (m_fIndexed?sizeof(std::uint32_t):MODEL_POINT_SIZE));
+	}
+	//points past the face
+	inline const std::uint8_t* end_data() const noexcept
+	{
+		return this->domain_data().end_data();
+	}
+};
+
+class model_faces_view
+{
+	const std::uint8_t* m_pData = nullptr; //points to the first face
+	std::size_t m_cFaces = 0;
+	bool m_fIndexed = false;
+public:
+	class const_iterator
+	{
+		model_face_view m_face;
+		std::size_t m_iFace = 0;
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef model_face_view value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const model_face_view* pointer;
+		typedef const model_face_view& reference;
+
+		const_iterator() = default;
+		const_iterator(model_face_view face, std::size_t iFace) noexcept:m_face(face), m_iFace(iFace) {}
+		const model_face_view& operator*() const noexcept
+		{
+			return m_face;
+		}
+		const model_face_view* operator->() const noexcept
+		{
+			return &m_face;
+		}
+		const_iterator& operator++() noexcept
+		{
+			m_face = model_face_view(m_face.end_data(), m_face.is_indexed());
+			++m_iFace;
+			return *this;
+		}
+		const_iterator operator++(int) noexcept
+		{
+			auto it = *this;
+			++*this;
+			return it;
+		}
+		bool operator==(const const_iterator& right) const noexcept
+		{
+			return m_iFace == right.m_iFace;
+		}
+		bool operator!=(const const_iterator& right) const noexcept
+		{
+			return m_iFace != right.m_iFace;
+		}
+	};
+	model_faces_view() = default;
+	model_faces_view(const std::uint8_t* pData, std::size_t cFaces, bool fIndexed) noexcept:m_pData(pData), m_cFaces(cFaces), m_fIndexed(fIndexed) {}
+	inline std::size_t size() const noexcept
+	{
+		return m_cFaces;
+	}
+	inline bool empty() const noexcept
+	{
+		return m_cFaces == 0;
+	}
+	inline const_iterator begin() const noexcept
+	{
+		return const_iterator(model_face_view(m_pData, m_fIndexed), 0);
+	}
+	inline const_iterator end() const noexcept
+	{
+		return const_iterator(model_face_view(), m_cFaces);
+	}
+};
+
+struct MODEL_OBJECT_ENTRY
+{
+	const std::uint8_t* pBegin; //the serialized object
+	const std::uint8_t* pEnd;
+	const std::uint8_t* pDomainData;
+	const std::uint8_t* pBody; //the part following the type id
+	std::string_view name;
+	ObjectTypeId type;
+};
+
+class model_object_view
+{
+	const MODEL_OBJECT_ENTRY* m_pEntry;
+public:
+	explicit model_object_view(const MODEL_OBJECT_ENTRY& entry) noexcept:m_pEntry(&entry) {}
+	inline std::string_view name() const noexcept
+	{
+		return m_pEntry->name;
+	}
+	inline ObjectTypeId type() const noexcept
+	{
+		return m_pEntry->type;
+	}
+	inline model_domain_data_view domain_data() const noexcept
+	{
+		return model_domain_data_view(m_pEntry->pDomainData);
+	}
+	//the serialized object as written by xml2bin
+	inline const std::uint8_t* data() const noexcept
+	{
+		return m_pEntry->pBegin;
+	}
+	inline std::size_t size() const noexcept
+	{
+		return std::size_t(m_pEntry->pEnd - m_pEntry->pBegin);
+	}
+	inline bool is_poly() const noexcept
+	{
+		return m_pEntry->type == ObjectPoly || m_pEntry->type == ObjectIndexedPoly;
+	}
+	//the shared table of vertices of an indexed poly object, empty for other objects
+	inline model_points_view vertices() const noexcept
+	{
+		if (m_pEntry->type != ObjectIndexedPoly)
+			return model_points_view();
+		return model_points_view(m_pEntry->pBody + sizeof(std::uint32_t), Implementation::read_model_value<std::uint32_t>(m_pEntry->pBody));
+	}
+	//faces of a poly object, empty for sources and plains
+	inline model_faces_view faces() const noexcept
+	{
+		const std::uint8_t* pFaces;
+		if (m_pEntry->type == ObjectPoly)
+			pFaces = m_pEntry->pBody;
+		else if (m_pEntry->type == ObjectIndexedPoly)
+			pFaces = m_pEntry->pBody + sizeof(std::uint32_t) + this->vertices().size() * MODEL_POINT_SIZE;
+		else
+			return model_faces_view();
+		return model_faces_view(pFaces + sizeof(std::uint32_t), Implementation::read_model_value<std::uint32_t>(pFaces), m_pEntry->type == ObjectIndexedPoly);
+	}
+	//position of a source or a plain
+	inline point_t position() const noexcept
+	{
+		return model_points_view(m_pEntry->pBody, 1)[0];
+	}
+	//vectors of a source (the direction and the top) or of a plain (v1 and v2), empty for poly objects
+	inline model_points_view vectors() const noexcept
+	{
+		if (this->is_poly())
+			return model_points_view();
+		auto pVectors = m_pEntry->pBody + MODEL_POINT_SIZE;
+		return model_points_view(pVectors + sizeof(std::uint32_t), Implementation::read_model_value<std::uint32_t>(pVectors));
+	}
+};
+
+//Random-access reader of a binary model written by xml2bin. The file is mapped to memory and validated, and an index of the objects
+//is built in a single pass on construction. Objects are then accessed by index or by name in constant time without deserialization.
+class model_reader
+{
+	mapped_file m_file;
+	std::vector<std::uint8_t> m_vDecompressed; //the model, if the file is compressed (see compressed_streams.h)
+	const std::uint8_t* m_pModel;
+	std::size_t m_cbModel;
+	std::string_view m_strName;
+	Units m_units;
+	point_t m_size;
+	const std::uint8_t* m_pDomainData;
+	std::vector<MODEL_OBJECT_ENTRY> m_vObjects;
+	std::unordered_map<std::string_view, std::size_t> m_mapNamed; //unused, if the model has the index of the objects
+	const std::uint8_t* m_pNameBuckets = nullptr; //name table of the index of the objects (see model_index.h), if the model has it
+	std::size_t m_cNameBuckets = 0;
+
+	//locates the objects by the index of the objects, if the model has it. Returns false otherwise.
+	bool read_object_index(const std::uint8_t* pObjects, std::size_t cObjects, const std::string& strPath);
+public:
+	explicit model_reader(const std::string& strPath); //throws std::runtime_error, if the file is not a valid binary model
+	model_reader(const model_reader&) = delete;
+	model_reader& operator=(const model_reader&) = delete;
+	inline std::string_view name() const noexcept
+	{
+		return m_strName;
+	}
+	inline Units units() const noexcept
+	{
+		return m_units;
+	}
+	inline const point_t& size() const noexcept
+	{
+		return m_size;
+	}
+	inline model_domain_data_view domain_data() const noexcept
+	{
+		return model_domain_data_view(m_pDomainData);
+	}
+	inline std::size_t object_count() const noexcept
+	{
+		return m_vObjects.size();
+	}
+	inline model_object_view object(std::size_t iObject) const noexcept
+	{
+		return model_object_view(m_vObjects[iObject]);
+	}
+	//returns nullopt, if there is no object with the name. Unnamed objects cannot be found by name.
+	std::optional<model_object_view> find(std::string_view strName) const;
+};
+
+#endif //CONVERTERS_MODEL_READER_H
@@ -0,0 +1,56 @@
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+
+#ifndef CONVERTERS_REPORT_FORMAT_H
+#define CONVERTERS_REPORT_FORMAT_H
+
+//Formatting of the numbers and strings of the reports, and of the text produced by the tools
+
+inline double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//shortest representation which reads back to the same value
+inline void append_double(std::string& str, double val)
+{
+	char buf[32];
+	auto res = std::to_chars(std::begin(buf), std::end(buf), val);
+	str.append(buf, res.ptr);
+}
+
+//JSON has no representation of NaN and infinities, null is written for them
+inline void append_json_number(std::string& str, double val)
+{
+	if (std::isfinite(val))
+		append_double(str, val);
+	else
+		str += "null";
+}
+
+inline void append_json_string(std::string& str, std::string_view strValue)
+{
+	static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+	str += '"';
+	for (auto ch:strValue)
+	{
+		if (ch == '"' || ch == '\\')
+		{
+			str += '\\';
+			str += ch;
+		}else if (static_cast<unsigned char>(ch) < 0x20)
+		{
+			str += "\\u00";
+			str += HEX_DIGITS[static_cast<unsigned char>(ch) >> 4];
+			str += HEX_DIGITS[static_cast<unsigned char>(ch) & 0xF];
+		}else
+			str += ch;
+	}
+	str += '"';
+}
+
+#endif //CONVERTERS_REPORT_FORMAT_H
@@ -1,13 +1,13 @@
 #include <basedefs.h>
 #include <istream>
-#include <locale>
 #include <streambuf>
 #include <memory>
-#include <climits>
 #include <ostream>
 
 #include <fstream>
 #include <string_view>
+#include <optional>
+#include <vector>
 #if CPP17_FILESYSTEM_SUPPORT
 #include <filesystem>
 #endif
@@ -39,11 +39,19 @@ enum class TextEncoding
 	Windows_1251
 };
 
-class text_istream:public std::wistream
+//the supported encoding named by the encoding attribute of an XML declaration (the names are compared case-insensitively), nullopt
+//if the name is not supported
+std::optional<TextEncoding> xml_encoding_by_name(std::string_view strName);
+//the name of the encoding in an XML declaration, Default is UTF-8
+std::string_view xml_encoding_name(TextEncoding encoding);
+
+//A text in any of the encodings is read as UTF-8: UTF-8 bytes are validated and passed through, the other encodings are transcoded
+//to UTF-8 by blocks. The column of the locator counts the characters rather than the bytes.
+class text_istream:public std::istream
 {
 	typedef std::istream stream_type;
 public:
-	typedef wchar_t char_type;
+	typedef char char_type;
 	typedef std::char_traits<char_type> traits_type;
 	typedef traits_type::int_type int_type;
 	typedef traits_type::off_type off_type;
@@ -54,7 +62,8 @@ public:
 	};
 
 
-	struct streambuf:std::wstreambuf
+	//Reads the bytes of the underlying buffer by blocks with the built-in decoder of the encoding, no locale is involved
+	struct streambuf:std::streambuf
 	{
 		virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out);
 		virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out);
@@ -63,17 +72,59 @@ public:
 		streambuf(std::streambuf* pBuf, TextEncoding encoding = TextEncoding::UTF8);
 		streambuf(streambuf&&) = default;
 		streambuf& operator=(streambuf&&) = default;
+		//the bytes not extracted yet are decoded anew with the encoding
 		void set_encoding(TextEncoding encoding);
+		inline TextEncoding encoding() const noexcept
+		{
+			return m_encoding;
+		}
 		inline const locator& get_locator() const noexcept
 		{
+			this->sync_locator();
 			return m_locator;
 		}
+		//the bytes read and not extracted yet, the next block is read if there are none. Empty at the end of the text.
+		inline std::string_view buffered()
+		{
+			if (traits_type::eq_int_type(this->sgetc(), traits_type::eof()))
+				return std::string_view();
+			return std::string_view(this->gptr(), std::size_t(this->egptr() - this->gptr()));
+		}
+		//extracts the first cb of the buffered bytes
+		inline void consume(std::size_t cb) noexcept
+		{
+			this->gbump(int(cb));
+		}
+		//a transcoder converts the complete characters at the beginning of the bytes to UTF-8 and stops at an invalid sequence. The
+		//output must have room for TRANSCODED_SIZE_MAX bytes per input byte.
+		struct decode_result
+		{
+			const unsigned char* pIn; //the first byte not decoded
+			char* pOut; //the end of the UTF-8 output
+			bool fInvalid; //the decoding has stopped at an invalid sequence
+		};
+		typedef decode_result (*transcoder)(const unsigned char* pIn, const unsigned char* pInEnd, char* pOut);
+		static constexpr std::size_t TRANSCODED_SIZE_MAX = 3;
 	private:
-		char m_mb_buf[MB_LEN_MAX];
-		std::size_t m_mb_buf_off = sizeof(m_mb_buf);
-		std::size_t m_mb_buf_len = sizeof(m_mb_buf); //number of bytes in the buffer
-		std::mbstate_t m_conv_state = std::mbstate_t();
-		char_type m_chLast = char_type();
+		static constexpr std::size_t BLOCK_SIZE = 8192; //bytes read from the underlying buffer at once
+		static constexpr std::size_t PUTBACK_SIZE = 8; //bytes of the previous block kept for putback
+
+		//the putback area followed by the bytes decoded into the block and the bytes not decoded yet. The UTF-8 block is the get area.
+		std::vector<unsigned char> m_vBytes;
+		std::size_t m_cbBytes = 0;
+		std::size_t m_cbDecoded = 0;
+		bool m_fInvalid = false; //the bytes not decoded yet start with an invalid sequence
+		std::vector<char> m_vTranscoded; //the putback area followed by the block transcoded to UTF-8
+		transcoder m_pTranscoder = nullptr; //null for UTF-8
+		//numbers of the source bytes of the characters by the first byte of their UTF-8 sequences, zero for the continuation bytes
+		const unsigned char* m_pSourceSizes = nullptr;
+		TextEncoding m_encoding = TextEncoding::Default;
+		//number of the source bytes of the characters of the block before m_pMeasured
+		const char* m_pMeasured = nullptr;
+		std::size_t m_cbMeasured = 0;
+		//the locator accounts for the characters before m_pLocated
+		mutable locator m_locator = {0u, 1u};
+		mutable const char* m_pLocated = nullptr;
 
 		typedef std::streambuf implbuf;
 		typedef implbuf::char_type impl_char_type;
@@ -84,10 +135,18 @@ public:
 
 		std::streambuf* m_pBufImpl = nullptr;
 
-		locator m_locator = {0u, 1u};
-		unsigned m_prev_col = 0u;
-
-		int_type readone();
+		inline unsigned char* bytes_begin() noexcept
+		{
+			return m_vBytes.data() + PUTBACK_SIZE;
+		}
+		inline char* block_begin() noexcept
+		{
+			return m_pTranscoder == nullptr?reinterpret_cast<char*>(this->bytes_begin()):m_vTranscoded.data() + PUTBACK_SIZE;
+		}
+		//number of the source bytes between the beginning of the block and the byte, negative for the bytes put back
+		off_type source_bytes_before(const char* pByte);
+		void reset_block();
+		void sync_locator() const noexcept;
 	public:
 		inline std::streambuf* rdbuf() const noexcept
 		{
@@ -101,18 +160,20 @@ public:
 		}
 	};
 protected:
-	inline text_istream():std::wistream(nullptr) {}
+	inline text_istream():std::istream(nullptr) {}
 	enum class use_bom_t {use_bom};
 public:
 	static constexpr use_bom_t use_bom = use_bom_t::use_bom;
-	inline explicit text_istream(std::istream& is, TextEncoding enc = TextEncoding::UTF8):std::wistream(nullptr), m_buf(is.rdbuf(), enc)
+	inline explicit text_istream(std::istream& is, TextEncoding enc = TextEncoding::UTF8):std::istream(nullptr), m_buf(is.rdbuf(), enc)
 	{
 		this->rdbuf(&m_buf);
 		if (is.fail())
 			this->setfail();
 	}
-	text_istream(std::istream& is, use_bom_t);
-	inline text_istream(text_istream&& right):std::wistream(std::move(right)), m_buf(std::move(right.m_buf))
+	//the encoding is detected by the byte order mark, which is skipped, or, in its absence, by the layout and the encoding attribute
+	//of the XML declaration the text starts with. UTF-8 is assumed, if neither is there.
+	inline text_istream(std::istream& is, use_bom_t):text_istream(is, detect_encoding(is)) {}
+	inline text_istream(text_istream&& right):std::istream(std::move(right)), m_buf(std::move(right.m_buf))
 	{
 		auto state = this->rdstate();
 		this->rdbuf(&m_buf);
@@ -127,11 +188,16 @@ public:
 		m_buf.set_encoding(encoding);
 		return *this;
 	}
+	inline TextEncoding encoding() const
+	{
+		return m_buf.encoding();
+	}
 	inline const locator& get_locator() const
 	{
 		return m_buf.get_locator();
 	}
-	virtual const std::wstring& get_resource_id() const;
+	//UTF-8
+	virtual const std::string& get_resource_id() const;
 	resource_locator get_resource_locator() const;
 	inline const streambuf* rdbuf() const noexcept
 	{
@@ -143,13 +209,17 @@ public:
 	}
 	inline streambuf* rdbuf(streambuf* pNewBuf)
 	{
-		if (pNewBuf != nullptr)
+		if (pNewBuf != nullptr && pNewBuf != &m_buf)
 			m_buf = std::move(*pNewBuf);
-		return static_cast<streambuf*>(this->std::wistream::rdbuf(pNewBuf));
+		return static_cast<streambuf*>(this->std::istream::rdbuf(pNewBuf));
 	}
 private:
 	mutable streambuf m_buf;
-	static const std::wstring m_strUnknownResourceId;
+	static const std::string m_strUnknownResourceId;
+
+	//the stream fails, if the encoding is not specified, i.e. the detected encoding is not supported
+	text_istream(std::istream& is, std::optional<TextEncoding> encoding);
+	static std::optional<TextEncoding> detect_encoding(std::istream& is);
 
 	inline void setfail()
 	{
@@ -159,37 +229,28 @@ private:
 	}
 };
 
+//The path is UTF-8 and is passed to the file stream as it is, so that opening a file involves no locale
 class text_ifstream:public text_istream
 {
 public:
-	virtual const std::wstring& get_resource_id() const;
+	virtual const std::string& get_resource_id() const;
 	inline text_ifstream(std::string_view path, TextEncoding encoding)
-		:m_path(path_init(path)), m_is(stream_init(path))
+		:m_path(path), m_is(m_path, std::ios_base::in)
 	{
 		static_cast<text_istream&>(*this) = text_istream(m_is, encoding);
 	}
 	inline text_ifstream(std::string_view path)
-		:m_path(path_init(path)), m_is(stream_init(path))
+		:m_path(path), m_is(m_path, std::ios_base::in)
 	{
 		static_cast<text_istream&>(*this) = text_istream(m_is, text_istream::use_bom);
 	}
-        inline text_ifstream(std::wstring_view path, TextEncoding encoding)
-                :m_path(path_init(path)), m_is(stream_init(path))
-        {
-                static_cast<text_istream&>(*this) = text_istream(m_is, encoding);
-        }
-        inline text_ifstream(std::wstring_view path)
-                :m_path(path_init(path)), m_is(stream_init(path))
-        {
-                static_cast<text_istream&>(*this) = text_istream(m_is, text_istream::use_bom);
-        }
 
 #if CPP17_FILESYSTEM_SUPPORT
-	inline text_ifstream(std::filesystem::path path, TextEncoding encoding):m_path(path.wstring()), m_is(path, std::ios_base::in) 
+	inline text_ifstream(std::filesystem::path path, TextEncoding encoding):m_path(path.u8string()), m_is(path, std::ios_base::in) 
 	{
 		static_cast<text_istream&>(*this) = text_istream(m_is, encoding);
 	}
-	inline text_ifstream(std::filesystem::path path):m_path(path.wstring()), m_is(path, std::ios_base::in) 
+	inline text_ifstream(std::filesystem::path path):m_path(path.u8string()), m_is(path, std::ios_base::in) 
 	{
 		static_cast<text_istream&>(*this) = text_istream(m_is, text_istream::use_bom);
 	}
@@ -200,19 +261,8 @@ public:
 	}
 	text_ifstream& operator=(text_ifstream&&) = default;
 private:
-	std::wstring m_path;
+	std::string m_path;
 	std::ifstream m_is;
-
-	static std::wstring path_init(std::string_view path);
-	static inline std::ifstream stream_init(std::string_view path)
-	{
-		return std::ifstream{std::string(path), std::ios_base::in};
-	}
-	static inline std::wstring path_init(std::wstring_view path)
-	{
-		return std::wstring(path);
-	}
-	static std::ifstream stream_init(std::wstring_view path);
 };
 
 #endif //TEXT_STREAMS_H_
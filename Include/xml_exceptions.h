@@ -16,28 +16,16 @@ inline std::string make_exception_message(std::string&& what)
 	return std::move(what);
 }
 
-std::string make_exception_message(const std::wstring& what);
-
 inline std::string make_exception_message(std::string_view what)
 {
 	return std::string(what);
 }
 
-inline std::string make_exception_message(std::wstring_view what)
-{
-	return make_exception_message(std::wstring(what));
-}
-
 inline std::string make_exception_message(const char* what)
 {
 	return std::string(what);
 }
 
-inline std::string make_exception_message(const wchar_t* what)
-{
-	return make_exception_message(std::wstring(what));
-}
-
 template <class Locator, class WhatString>
 std::string make_exception_message(const Locator& locator, WhatString&& what)
 {
@@ -54,16 +42,16 @@ struct xml_error:std::runtime_error
 struct xml_attribute_already_specified:xml_error
 {
 	inline xml_attribute_already_specified():xml_error(make_exception_message("Attribute is not unique")) {}
-	inline xml_attribute_already_specified(std::wstring_view attr):xml_error(make_exception_message(form_what(attr))) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
+	inline xml_attribute_already_specified(std::string_view attr):xml_error(make_exception_message(form_what(attr))) {}
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
 	inline xml_attribute_already_specified(const ResourceLocatorT& resource):xml_error(make_exception_message(resource, "Attribute is not unique")) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
-	inline xml_attribute_already_specified(const ResourceLocatorT& resource, std::wstring_view attr):xml_error(make_exception_message(resource, form_what(attr))) {}
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
+	inline xml_attribute_already_specified(const ResourceLocatorT& resource, std::string_view attr):xml_error(make_exception_message(resource, form_what(attr))) {}
 private:
-	inline static std::wstring form_what(std::wstring_view attr)
+	inline static std::string form_what(std::string_view attr)
 	{
-		std::wostringstream os;
-		os << L"Attribute " << attr << L" was not unique";
+		std::ostringstream os;
+		os << "Attribute " << attr << " was not unique";
 		return os.str();
 	}
 };
@@ -71,7 +59,7 @@ private:
 struct xml_invalid_syntax:xml_error
 {
 	inline xml_invalid_syntax():xml_error(make_exception_message("Invalid xml syntax")) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
 	inline xml_invalid_syntax(const ResourceLocatorT& resource):xml_error(make_exception_message(resource, "Invalid xml syntax")) {}
 };
 
@@ -83,16 +71,16 @@ struct xml_model_error:xml_error
 struct improper_xml_tag:xml_model_error
 {
 	inline improper_xml_tag():xml_model_error(make_exception_message("Improper XML tag")) {}
-	inline improper_xml_tag(std::wstring_view tag):xml_model_error(make_exception_message(form_what(tag))) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
+	inline improper_xml_tag(std::string_view tag):xml_model_error(make_exception_message(form_what(tag))) {}
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
 	inline improper_xml_tag(const ResourceLocatorT& resource):xml_model_error(make_exception_message(resource, "Improper XML tag")) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
-	inline improper_xml_tag(const ResourceLocatorT& resource, std::wstring_view tag):xml_model_error(make_exception_message(resource, form_what(tag))) {}
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
+	inline improper_xml_tag(const ResourceLocatorT& resource, std::string_view tag):xml_model_error(make_exception_message(resource, form_what(tag))) {}
 private:
-	inline static std::wstring form_what(std::wstring_view tag)
+	inline static std::string form_what(std::string_view tag)
 	{
-		std::wostringstream ss;
-		ss << L"Improper XML tag \"" << tag << L"\"";
+		std::ostringstream ss;
+		ss << "Improper XML tag \"" << tag << "\"";
 		return ss.str();
 	}
 };
@@ -100,16 +88,16 @@ private:
 struct xml_attribute_not_found:xml_model_error
 {
 	inline xml_attribute_not_found():xml_model_error(make_exception_message("Attribute is not found")) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
 	inline xml_attribute_not_found(const ResourceLocatorT& resource):xml_model_error(make_exception_message(resource, "Attribute is not found")) {}
-	inline xml_attribute_not_found(std::wstring_view attr):xml_model_error(make_exception_message(form_what(attr))) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
-	inline xml_attribute_not_found(const ResourceLocatorT& resource, std::wstring_view attr):xml_model_error(make_exception_message(resource, form_what(attr))) {}
+	inline xml_attribute_not_found(std::string_view attr):xml_model_error(make_exception_message(form_what(attr))) {}
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
+	inline xml_attribute_not_found(const ResourceLocatorT& resource, std::string_view attr):xml_model_error(make_exception_message(resource, form_what(attr))) {}
 private:
-	inline static std::wstring form_what(std::wstring_view attr)
+	inline static std::string form_what(std::string_view attr)
 	{
-		std::wostringstream os;
-		os << L"Attribute " << attr << L" was not found";
+		std::ostringstream os;
+		os << "Attribute " << attr << " was not found";
 		return os.str();
 	}
 };
@@ -117,16 +105,16 @@ private:
 struct xml_tag_not_found:xml_model_error
 {
 	inline xml_tag_not_found():xml_model_error(make_exception_message("Tag is not found")) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
 	inline xml_tag_not_found(const ResourceLocatorT& resource):xml_model_error(make_exception_message(resource, "Tag is not found")) {}
-	inline xml_tag_not_found(std::wstring_view tag):xml_model_error(make_exception_message(form_what(tag))) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
-	inline xml_tag_not_found(const ResourceLocatorT& resource, std::wstring_view tag):xml_model_error(make_exception_message(resource, form_what(tag))) {}
+	inline xml_tag_not_found(std::string_view tag):xml_model_error(make_exception_message(form_what(tag))) {}
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
+	inline xml_tag_not_found(const ResourceLocatorT& resource, std::string_view tag):xml_model_error(make_exception_message(resource, form_what(tag))) {}
 private:
-	inline static std::wstring form_what(std::wstring_view attr)
+	inline static std::string form_what(std::string_view attr)
 	{
-		std::wostringstream os;
-		os << L"Tag " << attr << L" was not found";
+		std::ostringstream os;
+		os << "Tag " << attr << " was not found";
 		return os.str();
 	}
 };
@@ -134,27 +122,27 @@ private:
 struct invalid_xml_model:xml_model_error
 {
 	inline invalid_xml_model():xml_model_error(make_exception_message("Invalid xml data")) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
 	inline invalid_xml_model(const ResourceLocatorT& resource):xml_model_error(make_exception_message(resource, "Invalid xml data")) {}
-	inline invalid_xml_model(std::wstring_view strWhat):xml_model_error(make_exception_message(strWhat)) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
-	inline invalid_xml_model(const ResourceLocatorT& resource, std::wstring_view strWhat):xml_model_error(make_exception_message(resource, strWhat)) {}
+	inline invalid_xml_model(std::string_view strWhat):xml_model_error(make_exception_message(strWhat)) {}
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
+	inline invalid_xml_model(const ResourceLocatorT& resource, std::string_view strWhat):xml_model_error(make_exception_message(resource, strWhat)) {}
 };
 
 struct ambiguous_specification:xml_model_error
 {
 	inline ambiguous_specification():xml_model_error(make_exception_message("Ambiguous model specification")) {}
-	inline ambiguous_specification(std::wstring_view xml_entity):xml_model_error(make_exception_message(form_what(xml_entity))) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
+	inline ambiguous_specification(std::string_view xml_entity):xml_model_error(make_exception_message(form_what(xml_entity))) {}
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
 	inline ambiguous_specification(const ResourceLocatorT& resource):xml_model_error(make_exception_message(resource, "Ambiguous model specification")) {}
-	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::wstring_view>>>
-	inline ambiguous_specification(const ResourceLocatorT& resource, std::wstring_view xml_entity):xml_model_error(make_exception_message(resource, form_what(xml_entity))) {}
+	template <class ResourceLocatorT, class = std::enable_if_t<!std::is_convertible_v<const ResourceLocatorT&, std::string_view>>>
+	inline ambiguous_specification(const ResourceLocatorT& resource, std::string_view xml_entity):xml_model_error(make_exception_message(resource, form_what(xml_entity))) {}
 private:
 	template <class XmlEntityString>
-	inline static std::wstring form_what(const XmlEntityString& xml_entity)
+	inline static std::string form_what(const XmlEntityString& xml_entity)
 	{
-		std::wostringstream ss;
-		ss << L"Ambiguous " << xml_entity;
+		std::ostringstream ss;
+		ss << "Ambiguous " << xml_entity;
 		return ss.str();
 	}
 };
@@ -6,9 +6,7 @@
 #include <tuple>
 #include <algorithm>
 #include <iterator>
-#include <locale>
 #include <text_streams.h>
-#include <cwctype>
 #include <xml_exceptions.h>
 
 #ifndef IMPL_XML_PARSER_H_
@@ -16,27 +14,36 @@
 
 namespace xml
 {
-	namespace Implementation
+	//The classification of the characters of a UTF-8 text does not depend on the locale. The bytes of the multibyte sequences are neither
+	//spaces nor digits, but are the characters of the words.
+	struct isspace_t
 	{
-		template <int (*is_f)(std::wint_t /*char, const std::locale&*/)>
-		struct is_functor
+		inline bool operator()(char ch) const
 		{
-			inline bool operator()(std::wint_t ch) const
-			{
-				return is_f(ch);
-			}
-		};
-	}
-	typedef Implementation::is_functor<&std::iswspace> isspace_t;
-	typedef Implementation::is_functor<&std::iswdigit> isdigit_t;
-	typedef Implementation::is_functor<&std::iswprint> isprint_t;
+			return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\v' || ch == '\f';
+		}
+	};
+	struct isdigit_t
+	{
+		inline bool operator()(char ch) const
+		{
+			return ch >= '0' && ch <= '9';
+		}
+	};
+	struct isword_t
+	{
+		inline bool operator()(char ch) const
+		{
+			return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || isdigit_t()(ch) || ch == '_' || static_cast<unsigned char>(ch) >= 0x80;
+		}
+	};
 
 	text_istream& skip_whitespace(text_istream& is);
 
 	class tag
 	{
-		std::wstring m_strTag;
-		std::map<std::wstring, std::wstring> m_mpAttributes;
+		std::string m_strTag;
+		std::map<std::string, std::string> m_mpAttributes;
 		bool m_fIsComment = false;
 		bool m_fIsClosing = false;
 		bool m_fIsUnary = false;
@@ -68,7 +75,7 @@ namespace xml
 		}
 		//returns tag string
 		//for comment returns the "<comment>" string
-		inline const std::wstring& name() const
+		inline const std::string& name() const
 		{
 			return m_strTag;
 		}
@@ -77,24 +84,24 @@ namespace xml
 			return m_fIsHeader;
 		}
 		template <class AttributeName>
-		const std::wstring& attribute(const AttributeName& attr) const
+		const std::string& attribute(const AttributeName& attr) const
 		{
-			static const std::wstring strDefault;
+			static const std::string strDefault;
 			auto it = m_mpAttributes.find(attr);
 			if (it == m_mpAttributes.end())
 				return strDefault;
 			return it->second;
 		}
 	private:
-		static std::wstring get_xml_word(text_istream& is);
-		static std::wstring get_string_in_quotes(text_istream& is); //quotes are extracted from the stream and discarded
+		static std::string get_xml_word(text_istream& is);
+		static std::string get_string_in_quotes(text_istream& is); //quotes are extracted from the stream and discarded
 
 		class istream_state
 		{
-			std::wistream *m_pIs;
-			std::wistream::iostate m_prev;
+			std::istream *m_pIs;
+			std::istream::iostate m_prev;
 		public:
-			inline istream_state(std::wistream& is, std::wistream::iostate newmask = std::wistream::iostate()):m_pIs(&is), m_prev(m_pIs->exceptions()) 
+			inline istream_state(std::istream& is, std::istream::iostate newmask = std::istream::iostate()):m_pIs(&is), m_prev(m_pIs->exceptions()) 
 			{
 				m_pIs->exceptions(newmask);
 			}
@@ -108,7 +115,7 @@ namespace xml
 	//is must correspond to a position to read from. Leading white spaces will be ignored. After the value is read, the following closing XML
 	//tag will be read, ignoring any preceding white space characters, and, if tag_name is not empty, will be checked against tag_name to match it.
 	template <class T>
-	auto get_tag_value(text_istream& is, std::wstring_view tag_name = std::string_view())
+	auto get_tag_value(text_istream& is, std::string_view tag_name = std::string_view())
 	-> std::enable_if_t<std::is_arithmetic_v<T>, T>
 	{
 		T val;
@@ -120,7 +127,7 @@ namespace xml
 	}
 
 	template <class T>
-	auto get_tag_value(text_istream& is, std::wstring_view tag_name = std::wstring_view(), bool fDiscardBoundingSpaces = true)
+	auto get_tag_value(text_istream& is, std::string_view tag_name = std::string_view(), bool fDiscardBoundingSpaces = true)
 	-> std::enable_if_t<std::is_same_v<std::basic_string<text_istream::char_type, text_istream::traits_type, typename T::allocator_type>, T>, T>
 	{
 		std::basic_string<text_istream::char_type, text_istream::traits_type, typename T::allocator_type> str;
@@ -129,7 +136,7 @@ namespace xml
 		text_istream::traits_type::int_type curr;
 		while ((curr = is.get()) != text_istream::traits_type::eof())
 		{
-			if (curr == text_istream::traits_type::to_int_type(L'<'))
+			if (curr == text_istream::traits_type::to_int_type('<'))
 			{
 				is.putback(text_istream::traits_type::to_char_type(curr));
 				if (fDiscardBoundingSpaces)
@@ -0,0 +1,372 @@
+#include "bench_generators.h"
+#include "xml2bin.h"
+#include "hgt_optimizer.h"
+#include "radio_hf_domain_xml2bin.h"
+#include "bin2text.h"
+#include <xml_parser.h>
+#include <binary_streams.h>
+#include <text_streams.h>
+#include <report_format.h>
+#include <list>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <filesystem>
+
+struct invalid_usage:std::runtime_error
+{
+	invalid_usage():std::runtime_error("Invalid program usage") {}
+};
+
+struct failed_to_open_a_file:std::runtime_error
+{
+	failed_to_open_a_file(const std::string& file):std::runtime_error(form_what(file)) {}
+private:
+	static std::string form_what(const std::string& file)
+	{
+		std::ostringstream os;
+		os << "Failed to open the file \"" << file << "\".";
+		return os.str();
+	}
+};
+
+//durations (in seconds) of the stages of a single run of a benchmark
+typedef std::vector<std::pair<std::string, double>> stage_times;
+
+struct bench_case
+{
+	std::string name;
+	std::string parameters; //a JSON object
+	std::uint64_t cbInput;
+	std::function<stage_times()> run;
+};
+
+struct stage_result
+{
+	std::string stage;
+	std::vector<double> vTimes;
+};
+
+//a file in the temporary directory removed with the object
+struct bench_file
+{
+	std::filesystem::path path;
+	explicit bench_file(const std::string& strName):path(std::filesystem::temp_directory_path() / strName) {}
+	bench_file(const bench_file&) = delete;
+	bench_file& operator=(const bench_file&) = delete;
+	~bench_file()
+	{
+		std::error_code ec;
+		std::filesystem::remove(path, ec);
+	}
+};
+
+//discards the text written by bin2txt
+struct null_streambuf:std::streambuf
+{
+protected:
+	virtual int_type overflow(int_type ch)
+	{
+		return traits_type::not_eof(ch);
+	}
+	virtual std::streamsize xsputn(const char_type*, std::streamsize cch)
+	{
+		return cch;
+	}
+};
+
+static std::string rename_domain(const std::string& strXml, const std::string& strFrom, const std::string& strTo)
+{
+	auto strOpeningTag = "<domain name=\"" + strFrom + "\">";
+	auto strRenamedTag = "<domain name=\"" + strTo + "\">";
+	std::string strRet;
+	strRet.reserve(strXml.size());
+	std::size_t pos = 0;
+	for (auto posTag = strXml.find(strOpeningTag); posTag != std::string::npos; pos = posTag + strOpeningTag.size(), posTag = strXml.find(strOpeningTag, pos))
+		strRet.append(strXml, pos, posTag - pos).append(strRenamedTag);
+	return strRet.append(strXml, pos, std::string::npos);
+}
+
+class Program
+{
+public:
+	Program(int argc, char** argv)
+	{
+		bool fDomainPlugin = false;
+		for (int i = 1; i < argc; ++i)
+		{
+			if (std::string_view(argv[i]) == "--help")
+			{
+				if (argc > 2)
+					throw invalid_usage();
+				std::cout << m_help_str;
+				m_fHelp = true;
+				return;
+			}else if (std::string_view(argv[i]) == "--repetitions")
+			{
+				if (i == argc - 1 || m_cRepetitions != 0)
+					throw invalid_usage();
+				char* pEnd;
+				auto cRepetitions = std::strtol(argv[++i], &pEnd, 10);
+				if (*pEnd != '\0' || cRepetitions <= 0)
+					throw invalid_usage();
+				m_cRepetitions = std::size_t(cRepetitions);
+			}else if (std::string_view(argv[i]) == "--scale")
+			{
+				if (i == argc - 1 || m_eScale > 0)
+					throw invalid_usage();
+				char* pEnd;
+				m_eScale = std::strtod(argv[++i], &pEnd);
+				if (*pEnd != '\0' || !(m_eScale > 0) || !std::isfinite(m_eScale))
+					throw invalid_usage();
+			}else if (std::string_view(argv[i]) == "--filter")
+			{
+				if (i == argc - 1 || !m_filter.empty())
+					throw invalid_usage();
+				m_filter = argv[++i];
+			}else if (std::string_view(argv[i]) == "--output")
+			{
+				if (i == argc - 1 || !m_output.empty())
+					throw invalid_usage();
+				m_output = argv[++i];
+			}else if (std::string_view(argv[i]) == "--domain_plugin")
+			{
+				if (i == argc - 1 || fDomainPlugin)
+					throw invalid_usage();
+				m_domain_plugin = argv[++i];
+				fDomainPlugin = true;
+			}else
+				throw invalid_usage();
+		}
+		if (m_cRepetitions == 0)
+			m_cRepetitions = 3;
+		if (!(m_eScale > 0))
+			m_eScale = 1;
+	}
+	bool is_ready() const
+	{
+		return !m_fHelp;
+	}
+	Program& run()
+	{
+		std::ofstream osFile;
+		if (!m_output.empty())
+		{
+			osFile.open(m_output, std::ios_base::out | std::ios_base::trunc);
+			if (osFile.fail())
+				throw failed_to_open_a_file(m_output);
+		}
+		auto& os = m_output.empty()?std::cout:osFile;
+		std::string str = "{\n\t\"benchmark\": \"converters_bench\",\n\t\"hardware_concurrency\": " + std::to_string(std::thread::hardware_concurrency())
+			+ ",\n\t\"repetitions\": " + std::to_string(m_cRepetitions) + ",\n\t\"scale\": ";
+		append_json_number(str, m_eScale);
+		str += ",\n\t\"results\": [";
+		bool fFirst = true;
+		for (auto& bench:this->cases())
+		{
+			if (!m_filter.empty() && bench.name.find(m_filter) == std::string::npos)
+				continue;
+			std::list<stage_result> lstStages;
+			for (std::size_t iRepetition = 0; iRepetition < m_cRepetitions; ++iRepetition)
+			{
+				for (auto& prStage:bench.run())
+				{
+					auto it = std::find_if(lstStages.begin(), lstStages.end(), [&prStage](const stage_result& res) {return res.stage == prStage.first;});
+					if (it == lstStages.end())
+						it = lstStages.emplace(lstStages.end(), stage_result{prStage.first, {}});
+					it->vTimes.emplace_back(prStage.second);
+				}
+			}
+			for (auto& res:lstStages)
+			{
+				str += fFirst?"\n\t\t":",\n\t\t";
+				fFirst = false;
+				this->append_result(str, bench, res);
+			}
+			os << str << std::flush;
+			str.clear();
+		}
+		os << str << "\n\t]\n}\n";
+		return *this;
+	}
+private:
+	std::size_t m_cRepetitions = 0;
+	double m_eScale = 0;
+	std::string m_filter;
+	std::string m_output;
+#ifdef CONVERTERS_BENCH_DOMAIN_PLUGIN
+	std::string m_domain_plugin = CONVERTERS_BENCH_DOMAIN_PLUGIN;
+#else
+	std::string m_domain_plugin;
+#endif
+	bool m_fHelp = false;
+	static std::string m_help_str;
+
+	static void append_result(std::string& str, const bench_case& bench, stage_result& res)
+	{
+		std::sort(res.vTimes.begin(), res.vTimes.end());
+		auto cTimes = res.vTimes.size();
+		auto eMedian = cTimes % 2 != 0?res.vTimes[cTimes / 2]:(res.vTimes[cTimes / 2 - 1] + res.vTimes[cTimes / 2]) / 2;
+		str += "{\"case\": \"" + bench.name + "\", \"stage\": \"" + res.stage + "\", \"parameters\": " + bench.parameters
+			+ ", \"input_bytes\": " + std::to_string(bench.cbInput) + ", \"min_seconds\": ";
+		append_json_number(str, res.vTimes.front());
+		str += ", \"median_seconds\": ";
+		append_json_number(str, eMedian);
+		str += ", \"mean_seconds\": ";
+		append_json_number(str, std::accumulate(res.vTimes.begin(), res.vTimes.end(), 0.0) / double(cTimes));
+		str += ", \"max_seconds\": ";
+		append_json_number(str, res.vTimes.back());
+		str += "}";
+	}
+
+	std::list<bench_case> cases() const
+	{
+		std::list<bench_case> lstCases;
+		SYNTHETIC_MODEL_PARAMETERS model_params;
+		model_params.cPolyObjects = std::max(std::size_t(std::lround(double(model_params.cPolyObjects) * m_eScale)), std::size_t(1));
+		auto pXml = std::make_shared<const std::string>(generate_model_xml(model_params));
+		auto strModelParameters = "{\"poly_objects\": " + std::to_string(model_params.cPolyObjects) + ", \"faces_per_object\": "
+			+ std::to_string(model_params.cFacesPerObject) + "}";
+		lstCases.emplace_back(bench_case{"xml_tokenize", strModelParameters, pXml->size(), [pXml]() -> stage_times
+		{
+			std::istringstream iss(*pXml);
+			text_istream is(iss);
+			auto start = std::chrono::steady_clock::now();
+			while (!xml::skip_whitespace(is).eof())
+			{
+				if (is.peek() == text_istream::traits_type::to_int_type('<'))
+					xml::tag tag(is);
+				else
+					is.ignore(std::numeric_limits<std::streamsize>::max(), '<').unget();
+			}
+			return {{"tokenize", seconds_since(start)}};
+		}});
+		for (auto pszDomain:{"radio_hf", "arch_ac"})
+		{
+			lstCases.emplace_back(bench_case{std::string("xml2bin/") + pszDomain, strModelParameters, pXml->size(), [pXml, pszDomain]() -> stage_times
+			{
+				buf_ostream os;
+				auto state = Implementation::xml2bin_set(pszDomain, os);
+				std::istringstream iss(*pXml);
+				text_istream is(iss);
+				auto start = std::chrono::steady_clock::now();
+				Implementation::xml2bin_next_xml(state, is);
+				auto convert_time = seconds_since(start);
+				start = std::chrono::steady_clock::now();
+				Implementation::xml2bin_finalize(state);
+				return {{"convert_model", convert_time}, {"finalize", seconds_since(start)}};
+			}});
+		}
+		if (!m_domain_plugin.empty())
+		{
+			//the arch_ac domain data of the model are converted by the example plugin as the data of its own domain
+			auto pPluginXml = std::make_shared<const std::string>(rename_domain(*pXml, "arch_ac", "passthrough"));
+			MODEL_OUTPUT_OPTIONS options;
+			options.vDomainPlugins.emplace_back(m_domain_plugin);
+			lstCases.emplace_back(bench_case{"xml2bin/passthrough_plugin", strModelParameters, pPluginXml->size(), [pPluginXml, options]() -> stage_times
+			{
+				buf_ostream os;
+				auto state = Implementation::xml2bin_set("passthrough", os, options);
+				std::istringstream iss(*pPluginXml);
+				text_istream is(iss);
+				auto start = std::chrono::steady_clock::now();
+				Implementation::xml2bin_next_xml(state, is);
+				auto convert_time = seconds_since(start);
+				start = std::chrono::steady_clock::now();
+				Implementation::xml2bin_finalize(state);
+				return {{"convert_model", convert_time}, {"finalize", seconds_since(start)}};
+			}});
+		}
+		for (auto terrain:{SyntheticTerrain::FlatOcean, SyntheticTerrain::Ramp, SyntheticTerrain::NoisyMountains, SyntheticTerrain::Voids})
+		{
+			auto pHgt = std::make_shared<const std::string>(generate_hgt(terrain, HGT_3).data(), HGT_3.cColumns * HGT_3.cRows * sizeof(short));
+			for (bool fIndexed:{false, true})
+			{
+				HGT_CONVERSION_OPTIONS options;
+				options.fIndexedFaces = fIndexed;
+				lstCases.emplace_back(bench_case{std::string("hgt/") + synthetic_terrain_name(terrain) + (fIndexed?"/indexed":""),
+					"{\"columns\": " + std::to_string(HGT_3.cColumns) + ", \"rows\": " + std::to_string(HGT_3.cRows) + "}", pHgt->size(),
+					[pHgt, options]() -> stage_times
+				{
+					std::istringstream is(*pHgt);
+					buf_ostream os;
+					ConverterImpl<radio_hf_convert> converter{radio_hf_convert()};
+					auto start = std::chrono::steady_clock::now();
+					auto stats = convert_hgt(HGT_3, options, {}, is, converter, os);
+					auto total_time = seconds_since(start);
+					return {{"matrix_init", stats.matrix_init_time},
+						{"parse_matrix", *std::max_element(stats.parse_times.begin(), stats.parse_times.end())},
+						{"parse_matrix_total", std::accumulate(stats.parse_times.begin(), stats.parse_times.end(), 0.0)},
+						{"convert_hgt", total_time}};
+				}});
+			}
+		}
+		SYNTHETIC_RESULTS_PARAMETERS results_params;
+		results_params.cRows = std::max(std::size_t(std::lround(double(results_params.cRows) * m_eScale)), std::size_t(1));
+		for (auto pszDomain:{"radio_hf", "arch_ac"})
+		{
+			auto pResults = std::make_shared<const bench_file>(std::string("converters_bench_") + pszDomain + ".bin");
+			{
+				auto vResults = generate_results(pszDomain, results_params);
+				std::ofstream os(pResults->path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+				os.write(reinterpret_cast<const char*>(vResults.data()), std::streamsize(vResults.size()));
+				if (os.fail())
+					throw failed_to_open_a_file(pResults->path.string());
+			}
+			lstCases.emplace_back(bench_case{std::string("bin2txt/") + pszDomain, "{\"plains\": " + std::to_string(results_params.cPlains) + ", \"columns\": "
+				+ std::to_string(results_params.cColumns) + ", \"rows\": " + std::to_string(results_params.cRows) + "}",
+				std::uint64_t(std::filesystem::file_size(pResults->path)), [pResults, pszDomain]() -> stage_times
+			{
+				null_streambuf buf;
+				std::ostream os(&buf);
+				auto start = std::chrono::steady_clock::now();
+				bin2text(std::string_view(pszDomain), pResults->path.string(), os);
+				auto text_time = seconds_since(start);
+				start = std::chrono::steady_clock::now();
+				bin2statistics(std::string_view(pszDomain), pResults->path.string(), os);
+				return {{"text", text_time}, {"statistics", seconds_since(start)}};
+			}});
+		}
+		return lstCases;
+	}
+};
+
+std::string Program::m_help_str =
+"converters_bench [--repetitions <count>] [--scale <factor>] [--filter <substring>] [--output <json_file>] [--domain_plugin <path>]|<--help>\n"\
+" Runs the benchmarks of the converters on deterministic synthetic inputs and writes the timings as a JSON document. Each stage of\n"\
+" each benchmark case (e.g. convert_model and finalize of xml2bin/radio_hf, matrix_init and parse_matrix of hgt/voids) is reported\n"\
+" separately with the minimum, median, mean and maximum durations over the repetitions.\n"\
+" --repetitions specifies how many times each case runs, 3 by default.\n"\
+" --scale multiplies the number of the objects of the synthetic model and the number of the rows of the synthetic results.\n"\
+" --filter specifies a substring of the names of the cases to run, e.g. \"hgt/\" or \"bin2txt\".\n"\
+" --output specifies a path to the output file. If not set, the document is written to the standard output.\n"\
+" --domain_plugin specifies a path to the example domain plugin (see passthrough_plugin), which converts the arch_ac domain data\n"\
+"       of the synthetic model as its own in the xml2bin/passthrough_plugin case. By default, the plugin built with the benchmark is\n"\
+"       loaded. If the path is empty, the case is not run.\n"\
+" --help displays this message.\n";
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		Program pr(argc, argv);
+		if (pr.is_ready())
+			pr.run();
+	}catch (std::exception& ex)
+	{
+		std::cerr << ex.what() << "\n";
+		return -1;
+	}
+	return 0;
+}
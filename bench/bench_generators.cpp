@@ -0,0 +1,241 @@
+#include "bench_generators.h"
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <report_format.h>
+
+//the value of a lattice point, so that the data depends on the seed and the position only
+static std::uint64_t hash_value(std::uint64_t seed, std::uint64_t a, std::uint64_t b = 0)
+{
+	//splitmix64 finalizer
+	auto x = seed ^ (a * 0x9E3779B97F4A7C15ull) ^ (b * 0xC2B2AE3D27D4EB4Full);
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+	return x ^ (x >> 31);
+}
+
+//uniform in [0, 1)
+static double hash_double(std::uint64_t seed, std::uint64_t a, std::uint64_t b = 0)
+{
+	return double(hash_value(seed, a, b) >> 11) * (1.0 / double(std::uint64_t(1) << 53));
+}
+
+static void append_point(std::string& str, const char* pszTag, double x, double y, double z)
+{
+	str += '<';
+	str += pszTag;
+	str += " x=\"";
+	append_double(str, x);
+	str += "\" y=\"";
+	append_double(str, y);
+	str += "\" z=\"";
+	append_double(str, z);
+	str += "\"/>";
+}
+
+std::string generate_model_xml(const SYNTHETIC_MODEL_PARAMETERS& params)
+{
+	constexpr double MODEL_SIZE = 10000, MODEL_HEIGHT = 1000, OBJECT_SIZE = 100;
+	std::string str = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<model name=\"synthetic\" cx=\"10000\" cy=\"10000\" cz=\"1000\">\n";
+	str += "  <domain name=\"radio_hf\">\n"
+		"    <minimalFieldAmplitude>1e-6</minimalFieldAmplitude>\n"
+		"    <iterationAverageResultingChange>0.01</iterationAverageResultingChange>\n"
+		"    <iterationAverageResultingStep>10</iterationAverageResultingStep>\n"
+		"    <frequencySet> <frequency>1e6</frequency> <frequency>2e6</frequency> </frequencySet>\n"
+		"    <modelMedium> <refractionChange>0</refractionChange> <medium> <permittivity>1</permittivity> </medium> </modelMedium>\n"
+		"  </domain>\n"
+		"  <domain name=\"arch_ac\"> <attenuation>0.5</attenuation> </domain>\n";
+	std::uint64_t iValue = 0;
+	for (std::size_t iObject = 0; iObject < params.cPolyObjects; ++iObject)
+	{
+		str += "  <polyobject name=\"poly" + std::to_string(iObject) + "\">\n";
+		str += "    <domain name=\"radio_hf\"> <medium> <permittivity>";
+		append_double(str, 1 + std::floor(hash_double(params.seed, iValue++) * 10));
+		str += "</permittivity> <conductivity>0.01</conductivity> </medium> </domain>\n";
+		auto x0 = hash_double(params.seed, iValue++) * (MODEL_SIZE - OBJECT_SIZE);
+		auto y0 = hash_double(params.seed, iValue++) * (MODEL_SIZE - OBJECT_SIZE);
+		for (std::size_t iFace = 0; iFace < params.cFacesPerObject; ++iFace)
+		{
+			str += "    <face>\n      ";
+			for (int iVertex = 0; iVertex < 3; ++iVertex)
+			{
+				auto x = std::floor(x0 + hash_double(params.seed, iValue++) * OBJECT_SIZE);
+				auto y = std::floor(y0 + hash_double(params.seed, iValue++) * OBJECT_SIZE);
+				auto z = std::floor(hash_double(params.seed, iValue++) * MODEL_HEIGHT / 10);
+				append_point(str, "vertex", x, y, z);
+				str += ' ';
+			}
+			str += "\n      <domain name=\"arch_ac\"> <absorption>";
+			for (int iFreq = 0, eFreq = 125; iFreq < 6; ++iFreq, eFreq *= 2)
+			{
+				str += " <absorption_row frequency=\"" + std::to_string(eFreq) + "\">";
+				append_double(str, std::floor(hash_double(params.seed, iValue++) * 100) / 100);
+				str += "</absorption_row>";
+			}
+			str += " </absorption> </domain>\n    </face>\n";
+		}
+		str += "  </polyobject>\n";
+	}
+	for (std::size_t iSource = 0; iSource < params.cSources; ++iSource)
+	{
+		str += "  <sourceobject name=\"tx" + std::to_string(iSource) + "\">\n    ";
+		auto x = std::floor(hash_double(params.seed, iValue++) * MODEL_SIZE);
+		auto y = std::floor(hash_double(params.seed, iValue++) * MODEL_SIZE);
+		append_point(str, "position", x, y, 10);
+		str += " <direction x=\"1\" y=\"0\" z=\"0\"/> <top x=\"0\" y=\"0\" z=\"1\"/>\n"
+			"    <domain name=\"radio_hf\"> <input_power>1</input_power> <antenna> <antenna_type>\n"
+			"      <frequency_response> <expressionFrequencyResponse>1</expressionFrequencyResponse> </frequency_response>\n"
+			"      <radiation_pattern> <expressionRadiationPattern>1</expressionRadiationPattern> </radiation_pattern>\n"
+			"      <antenna_gain> <magnitude>1</magnitude> </antenna_gain> <polarization_angle>0</polarization_angle>\n"
+			"    </antenna_type> </antenna> </domain>\n"
+			"    <domain name=\"arch_ac\"> <afc> <function>1</function> </afc> <rp> <function>1</function> </rp> </domain>\n"
+			"  </sourceobject>\n";
+	}
+	for (std::size_t iPlain = 0; iPlain < params.cPlains; ++iPlain)
+	{
+		str += "  <plainobject name=\"rx" + std::to_string(iPlain) + "\">\n    ";
+		auto x = std::floor(hash_double(params.seed, iValue++) * MODEL_SIZE);
+		auto y = std::floor(hash_double(params.seed, iValue++) * MODEL_SIZE);
+		append_point(str, "position", x, y, 2);
+		str += " <v1 x=\"100\" y=\"0\" z=\"0\"/> <v2 x=\"0\" y=\"100\" z=\"0\"/>\n  </plainobject>\n";
+	}
+	str += "</model>\n";
+	return str;
+}
+
+const char* synthetic_terrain_name(SyntheticTerrain terrain)
+{
+	switch (terrain)
+	{
+	case SyntheticTerrain::FlatOcean:
+		return "flat_ocean";
+	case SyntheticTerrain::Ramp:
+		return "ramp";
+	case SyntheticTerrain::NoisyMountains:
+		return "noisy_mountains";
+	default:
+		return "voids";
+	}
+}
+
+//value noise of a few octaves in [0, 1)
+static double fractal_noise(std::uint64_t seed, double x, double y)
+{
+	constexpr int OCTAVES = 5;
+	auto smooth = [](double t) -> double {return t * t * (3 - 2 * t);};
+	double val = 0, amplitude = 0.5, total = 0;
+	for (int iOctave = 0; iOctave < OCTAVES; ++iOctave, x *= 2, y *= 2, amplitude /= 2)
+	{
+		auto x0 = std::floor(x), y0 = std::floor(y);
+		auto tx = smooth(x - x0), ty = smooth(y - y0);
+		auto ix = std::uint64_t(std::int64_t(x0)), iy = std::uint64_t(std::int64_t(y0));
+		auto octave_seed = seed + std::uint64_t(iOctave);
+		auto v00 = hash_double(octave_seed, ix, iy), v10 = hash_double(octave_seed, ix + 1, iy);
+		auto v01 = hash_double(octave_seed, ix, iy + 1), v11 = hash_double(octave_seed, ix + 1, iy + 1);
+		val += amplitude * ((v00 * (1 - tx) + v10 * tx) * (1 - ty) + (v01 * (1 - tx) + v11 * tx) * ty);
+		total += amplitude;
+	}
+	return val / total;
+}
+
+std::vector<char> generate_hgt(SyntheticTerrain terrain, const HGT_RESOLUTION_DATA& resolution, std::uint64_t seed)
+{
+	constexpr double MOUNTAIN_HEIGHT = 3000, NOISE_CELL = 128, RAMP_HEIGHT = 2000;
+	constexpr short VOID_HEIGHT = -32768;
+	std::vector<short> vHeights(resolution.cColumns * resolution.cRows);
+	for (std::size_t iRow = 0; iRow < resolution.cRows; ++iRow)
+	{
+		for (std::size_t iCol = 0; iCol < resolution.cColumns; ++iCol)
+		{
+			double height;
+			switch (terrain)
+			{
+			case SyntheticTerrain::FlatOcean:
+				height = 0;
+				break;
+			case SyntheticTerrain::Ramp:
+				//the first quarter of the columns is water
+				height = std::max(0.0, (double(iCol) / double(resolution.cColumns) - 0.25) * RAMP_HEIGHT);
+				break;
+			default:
+				height = std::max(0.0, (fractal_noise(seed, double(iCol) / NOISE_CELL, double(iRow) / NOISE_CELL) - 0.3) * MOUNTAIN_HEIGHT);
+				break;
+			}
+			vHeights[iRow * resolution.cColumns + iCol] = short(std::lround(height));
+		}
+	}
+	if (terrain == SyntheticTerrain::Voids)
+	{
+		constexpr std::size_t VOID_COUNT = 16, MAX_VOID_SIZE = 64;
+		for (std::size_t iVoid = 0; iVoid < VOID_COUNT; ++iVoid)
+		{
+			auto cColumns = 1 + std::size_t(hash_double(seed, iVoid, 0) * MAX_VOID_SIZE);
+			auto cRows = 1 + std::size_t(hash_double(seed, iVoid, 1) * MAX_VOID_SIZE);
+			auto iFirstColumn = std::size_t(hash_double(seed, iVoid, 2) * double(resolution.cColumns - cColumns));
+			auto iFirstRow = std::size_t(hash_double(seed, iVoid, 3) * double(resolution.cRows - cRows));
+			for (auto iRow = iFirstRow; iRow < iFirstRow + cRows; ++iRow)
+				std::fill_n(&vHeights[iRow * resolution.cColumns + iFirstColumn], cColumns, VOID_HEIGHT);
+		}
+	}
+	std::vector<char> vData(vHeights.size() * sizeof(short));
+	for (std::size_t iPoint = 0; iPoint < vHeights.size(); ++iPoint)
+	{
+		auto height = static_cast<unsigned short>(vHeights[iPoint]);
+		vData[2 * iPoint] = char(height >> 8);
+		vData[2 * iPoint + 1] = char(height & 0xFF);
+	}
+	return vData;
+}
+
+template <class T>
+static void append_value(std::vector<std::uint8_t>& vData, T val)
+{
+	auto cb = vData.size();
+	vData.resize(cb + sizeof(T));
+	std::memcpy(vData.data() + cb, &val, sizeof(T));
+}
+
+std::vector<std::uint8_t> generate_results(const std::string& strDomain, const SYNTHETIC_RESULTS_PARAMETERS& params)
+{
+	bool fArchAc = strDomain == "arch_ac";
+	if (!fArchAc && strDomain != "radio_hf")
+		throw std::invalid_argument("Invalid domain name");
+	auto cFrequencies = fArchAc?std::size_t(6):params.cFrequencies;
+	auto cPoints = params.cColumns * params.cRows;
+	std::vector<std::uint8_t> vData;
+	vData.reserve(params.cPlains * cPoints * (fArchAc?(sizeof(std::uint32_t) + 3 * sizeof(double) + cFrequencies * sizeof(double)):(3 + 6 * cFrequencies) * sizeof(double)));
+	std::uint64_t iValue = 0;
+	append_value(vData, std::uint32_t(params.cPlains));
+	for (std::size_t iPlain = 0; iPlain < params.cPlains; ++iPlain)
+	{
+		auto strName = "plain" + std::to_string(iPlain);
+		append_value(vData, std::uint32_t(strName.size()));
+		vData.insert(vData.end(), strName.begin(), strName.end());
+		append_value(vData, std::uint32_t(params.cColumns));
+		append_value(vData, std::uint32_t(params.cRows));
+		for (std::size_t iPoint = 0; iPoint < cPoints; ++iPoint)
+		{
+			if (fArchAc)
+				append_value(vData, std::uint32_t(3));
+			append_value(vData, double(iPoint % params.cColumns));
+			append_value(vData, double(iPoint / params.cColumns));
+			append_value(vData, 2.0);
+		}
+		if (!fArchAc)
+			append_value(vData, std::uint32_t(cFrequencies));
+		for (std::size_t iFreq = 0; iFreq < cFrequencies; ++iFreq)
+		{
+			append_value(vData, fArchAc?double(125 << iFreq):1e6 * double(iFreq + 1));
+			if (fArchAc)
+			{
+				append_value(vData, std::uint32_t(params.cColumns));
+				append_value(vData, std::uint32_t(params.cRows));
+			}
+			for (std::size_t iPoint = 0; iPoint < cPoints * (fArchAc?1:6); ++iPoint)
+				append_value(vData, hash_double(params.seed, iValue++) * 100);
+		}
+	}
+	return vData;
+}
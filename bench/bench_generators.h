@@ -0,0 +1,49 @@
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "xml2bin.h"
+
+#ifndef BENCH_GENERATORS_H_
+#define BENCH_GENERATORS_H_
+
+//Deterministic generators of the inputs of the converters. The same parameters and seed produce the same data on any platform.
+
+struct SYNTHETIC_MODEL_PARAMETERS
+{
+	std::size_t cPolyObjects = 200;
+	std::size_t cFacesPerObject = 50;
+	std::size_t cSources = 4;
+	std::size_t cPlains = 4;
+	std::uint64_t seed = 1;
+};
+
+//a model XML with the model, object and face domain data of both radio_hf and arch_ac
+std::string generate_model_xml(const SYNTHETIC_MODEL_PARAMETERS& params);
+
+enum class SyntheticTerrain
+{
+	FlatOcean, //zero heights only
+	Ramp, //a plane rising from a coast line
+	NoisyMountains, //fractal noise with the valleys below the sea level flattened into water
+	Voids //noisy mountains with rectangular voids of missing heights
+};
+
+const char* synthetic_terrain_name(SyntheticTerrain terrain);
+
+//an SRTM tile (big-endian 16-bit heights) of resolution.cColumns x resolution.cRows points
+std::vector<char> generate_hgt(SyntheticTerrain terrain, const HGT_RESOLUTION_DATA& resolution, std::uint64_t seed = 1);
+
+struct SYNTHETIC_RESULTS_PARAMETERS
+{
+	std::size_t cPlains = 4;
+	std::size_t cColumns = 300;
+	std::size_t cRows = 300;
+	std::size_t cFrequencies = 4; //radio_hf only, arch_ac results always have 6 frequencies
+	std::uint64_t seed = 1;
+};
+
+//a results file of the domain (arch_ac or radio_hf) as read by bin2txt
+std::vector<std::uint8_t> generate_results(const std::string& strDomain, const SYNTHETIC_RESULTS_PARAMETERS& params);
+
+#endif //BENCH_GENERATORS_H_
@@ -1,121 +1,822 @@
 #include "bin2text.h"
+#include <basedefs.h>
 #include <type_traits>
+#include <vector>
+#include <list>
+#include <future>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <array>
+#include <limits>
+#include <cmath>
+#include <mapped_file.h>
+#include <model_reader.h>
+#include <report_format.h>
 
-template <class T>
-static auto read_as(std::istream& is) -> std::enable_if_t<std::is_pod_v<T>, T>
+//A results file is read into the list of its plains, each having the grid of its control points followed by the grids of the results
+//at each frequency. The grids are formatted by blocks of rows in parallel into separate buffers, which are written in the order of the
+//file, or split into the column files of their fields.
+
+typedef std::uint32_t results_size_type;
+
+//the rows of a grid make blocks of about that many bytes of the input
+static constexpr std::size_t RESULTS_BLOCK_INPUT_SIZE = std::size_t(1) << 20;
+
+enum class ResultsGridType
 {
-	T val;
-	is.read(reinterpret_cast<char*>(std::addressof(val)), sizeof(T));
-	return val;
+	ArchAcPoints, //number of coordinates (3) and the coordinates of each control point
+	ArchAcIntensity, //intensity at each control point
+	RadioHfPoints, //coordinates of each control point
+	RadioHfField //amplitudes and arguments of Ex, Ey and Ez at each control point
+};
+
+struct results_field
+{
+	const char* name;
+	std::size_t offset; //in a point of the grid
+};
+
+static constexpr results_field ARCH_AC_POINT_FIELDS[] = {{"x", sizeof(results_size_type)}, {"y", sizeof(results_size_type) + sizeof(double)}, 
+	{"z", sizeof(results_size_type) + 2 * sizeof(double)}};
+static constexpr results_field ARCH_AC_INTENSITY_FIELDS[] = {{"intensity", 0}};
+static constexpr results_field RADIO_HF_POINT_FIELDS[] = {{"x", 0}, {"y", sizeof(double)}, {"z", 2 * sizeof(double)}};
+static constexpr results_field RADIO_HF_FIELD_FIELDS[] = {{"ex_amp", 0}, {"ex_arg", sizeof(double)}, {"ey_amp", 2 * sizeof(double)}, 
+	{"ey_arg", 3 * sizeof(double)}, {"ez_amp", 4 * sizeof(double)}, {"ez_arg", 5 * sizeof(double)}};
+
+static constexpr std::size_t results_point_size(ResultsGridType type)
+{
+	switch (type)
+	{
+	case ResultsGridType::ArchAcPoints:
+		return sizeof(results_size_type) + 3 * sizeof(double);
+	case ResultsGridType::ArchAcIntensity:
+		return sizeof(double);
+	case ResultsGridType::RadioHfPoints:
+		return 3 * sizeof(double);
+	default:
+		return 6 * sizeof(double);
+	}
 }
 
-template <class T>
-static auto read_buf(std::istream& is, T* buf, std::size_t cBuf) -> std::enable_if_t<std::is_void_v<T> || std::is_pod_v<T>>
+static std::pair<const results_field*, std::size_t> results_fields(ResultsGridType type)
 {
-	is.read(reinterpret_cast<char*>(buf), cBuf * sizeof(T));
+	switch (type)
+	{
+	case ResultsGridType::ArchAcPoints:
+		return {std::begin(ARCH_AC_POINT_FIELDS), std::size(ARCH_AC_POINT_FIELDS)};
+	case ResultsGridType::ArchAcIntensity:
+		return {std::begin(ARCH_AC_INTENSITY_FIELDS), std::size(ARCH_AC_INTENSITY_FIELDS)};
+	case ResultsGridType::RadioHfPoints:
+		return {std::begin(RADIO_HF_POINT_FIELDS), std::size(RADIO_HF_POINT_FIELDS)};
+	default:
+		return {std::begin(RADIO_HF_FIELD_FIELDS), std::size(RADIO_HF_FIELD_FIELDS)};
+	}
 }
 
-namespace Implementation
+//a window of a grid of the file, the whole grid unless filtered
+struct results_grid
+{
+	ResultsGridType type;
+	double frequency; //of the results, not used for control points
+	std::size_t iFrequency; //index of the frequency in the file, not used for control points
+	const std::uint8_t* pData; //first point of the window
+	std::size_t cbRow; //distance between the rows of the grid in the file
+	std::size_t iFirstColumn; //position of the window in the grid
+	std::size_t iFirstRow;
+	std::size_t cColumns;
+	std::size_t cRows;
+	inline const std::uint8_t* row(std::size_t iRow) const noexcept
+	{
+		return pData + iRow * cbRow;
+	}
+	inline bool is_control_points() const noexcept
+	{
+		return type == ResultsGridType::ArchAcPoints || type == ResultsGridType::RadioHfPoints;
+	}
+};
+
+struct results_plain
 {
+	std::size_t index; //in the file
+	std::string_view name;
+	std::vector<results_grid> vGrids; //control points, then the results at each frequency
+};
 
-void bin2text_arch_ac(std::istream& is, std::ostream& os)
+namespace
 {
-	typedef std::uint32_t size_type;
-	auto cPlainCount = read_as<size_type>(is);
-	for (size_type iPlain = 0; iPlain < cPlainCount; ++iPlain)
+	//walks through a mapped results file checking that the data being read is within the file
+	class results_cursor
 	{
-		auto cbName = read_as<size_type>(is);
-		auto strName = std::string(cbName, char());
-		read_buf(is, strName.data(), cbName);
-		os << "Plain name: " << strName << "\n";
+		const std::uint8_t* m_pCur;
+		const std::uint8_t* m_pEnd;
+	public:
+		results_cursor(const std::uint8_t* pData, std::size_t cbData):m_pCur(pData), m_pEnd(pData + cbData) {}
+		const std::uint8_t* skip(std::size_t cItems, std::size_t cbItem)
 		{
-			os << "Control points:\n";
-			auto cColumns = read_as<size_type>(is), cRows = read_as<size_type>(is);
-			for (size_type iRow = 0; iRow < cRows; ++iRow)
-			{
-				for (size_type iCol = 0; iCol < cColumns; ++iCol)
-				{
-					auto cDims = read_as<size_type>(is);
-					if (cDims != 3)
-						throw std::logic_error("Unexpected size of results");
-					auto x = read_as<double>(is);
-					auto y = read_as<double>(is);
-					auto z = read_as<double>(is);
-					if (iCol != 0) os << ",\t";
-					os << '{' << x << ", " << y << ", " << z << "}";
-				}
-				os << "\n";
-			}
+			if (cItems != 0 && std::size_t(m_pEnd - m_pCur) / cItems < cbItem)
+				throw std::logic_error("Unexpected size of results");
+			auto pData = m_pCur;
+			m_pCur += cItems * cbItem;
+			return pData;
+		}
+		template <class T>
+		T read()
+		{
+			T val;
+			std::memcpy(&val, this->skip(1, sizeof(T)), sizeof(T));
+			return val;
+		}
+		std::string_view read_string()
+		{
+			auto cb = this->read<results_size_type>();
+			return std::string_view(reinterpret_cast<const char*>(this->skip(cb, 1)), cb);
+		}
+		//skips the grid without reading it
+		results_grid read_grid(ResultsGridType type, double frequency, std::size_t iFrequency, std::size_t cColumns, std::size_t cRows)
+		{
+			auto cbPoint = results_point_size(type);
+			if (cColumns != 0 && cColumns * cbPoint / cColumns != cbPoint)
+				throw std::logic_error("Unexpected size of results");
+			return results_grid{type, frequency, iFrequency, this->skip(cRows, cColumns * cbPoint), cColumns * cbPoint, 0, 0, cColumns, cRows};
+		}
+	};
+}
+
+static bool is_plain_selected(std::string_view strName, const RESULTS_FILTER& filter)
+{
+	return filter.setPlains.empty() || filter.setPlains.find(strName) != filter.setPlains.end();
+}
+
+static bool is_frequency_selected(double frequency, const RESULTS_FILTER& filter)
+{
+	return frequency >= filter.eMinFrequency && frequency <= filter.eMaxFrequency;
+}
+
+//narrows the grid to the window of the filter
+static results_grid select_window(results_grid grid, const RESULTS_FILTER& filter)
+{
+	auto iFirstColumn = std::min(filter.iFirstColumn, grid.cColumns), iFirstRow = std::min(filter.iFirstRow, grid.cRows);
+	grid.pData += iFirstRow * grid.cbRow + iFirstColumn * results_point_size(grid.type);
+	grid.iFirstColumn = iFirstColumn;
+	grid.iFirstRow = iFirstRow;
+	grid.cColumns = std::min(filter.cColumns, grid.cColumns - iFirstColumn);
+	grid.cRows = std::min(filter.cRows, grid.cRows - iFirstRow);
+	return grid;
+}
+
+//The grids are skipped by their sizes, so that the data of the plains, the frequencies and the rows which are not selected is not read.
+static std::vector<results_plain> read_arch_ac_results(const mapped_file& input, const RESULTS_FILTER& filter)
+{
+	results_cursor cursor(input.data(), input.size());
+	std::vector<results_plain> vPlains;
+	auto cPlainCount = cursor.read<results_size_type>();
+	for (results_size_type iPlain = 0; iPlain < cPlainCount; ++iPlain)
+	{
+		results_plain plain{iPlain, cursor.read_string()};
+		auto fSelected = is_plain_selected(plain.name, filter);
+		{
+			auto cColumns = cursor.read<results_size_type>(), cRows = cursor.read<results_size_type>();
+			plain.vGrids.emplace_back(select_window(cursor.read_grid(ResultsGridType::ArchAcPoints, 0, 0, cColumns, cRows), filter));
 		}
 		for (auto iFreq = 0; iFreq < 6 /*frequencies*/; ++iFreq)
 		{
-			auto eF = read_as<double>(is);
-			os << "Results at " << eF << "Hz:\n";
-			auto cColumns = read_as<size_type>(is), cRows = read_as<size_type>(is);
-			for (size_type iRow = 0; iRow < cRows; ++iRow)
+			auto eF = cursor.read<double>();
+			auto cColumns = cursor.read<results_size_type>(), cRows = cursor.read<results_size_type>();
+			auto grid = cursor.read_grid(ResultsGridType::ArchAcIntensity, eF, iFreq, cColumns, cRows);
+			if (fSelected && is_frequency_selected(eF, filter))
+				plain.vGrids.emplace_back(select_window(grid, filter));
+		}
+		if (fSelected)
+			vPlains.emplace_back(std::move(plain));
+	}
+	return vPlains;
+}
+
+static std::vector<results_plain> read_radio_hf_results(const mapped_file& input, const RESULTS_FILTER& filter)
+{
+	results_cursor cursor(input.data(), input.size());
+	std::vector<results_plain> vPlains;
+	auto cPlainCount = cursor.read<results_size_type>();
+	for (results_size_type iPlain = 0; iPlain < cPlainCount; ++iPlain)
+	{
+		results_plain plain{iPlain, cursor.read_string()};
+		auto fSelected = is_plain_selected(plain.name, filter);
+		auto cColumns = cursor.read<results_size_type>();
+		auto cRows = cursor.read<results_size_type>();
+		plain.vGrids.emplace_back(select_window(cursor.read_grid(ResultsGridType::RadioHfPoints, 0, 0, cColumns, cRows), filter));
+		auto cFrequencies = cursor.read<results_size_type>();
+		for (results_size_type iFreq = 0; iFreq < cFrequencies /*frequencies*/; ++iFreq)
+		{
+			auto eF = cursor.read<double>();
+			auto grid = cursor.read_grid(ResultsGridType::RadioHfField, eF, iFreq, cColumns, cRows);
+			if (fSelected && is_frequency_selected(eF, filter))
+				plain.vGrids.emplace_back(select_window(grid, filter));
+		}
+		if (fSelected)
+			vPlains.emplace_back(std::move(plain));
+	}
+	return vPlains;
+}
+
+static double load_double(const std::uint8_t* pData)
+{
+	double val;
+	std::memcpy(&val, pData, sizeof(double));
+	return val;
+}
+
+//the rows [iFirstRow, iFirstRow + cRows) of a grid
+struct results_block
+{
+	std::string header; //the text preceding the rows
+	const results_grid* pGrid;
+	std::size_t iFirstRow;
+	std::size_t cRows;
+};
+
+static std::size_t results_block_rows(const results_grid& grid)
+{
+	auto cbRow = grid.cColumns * results_point_size(grid.type);
+	return cbRow == 0?std::max(grid.cRows, std::size_t(1)):std::max(RESULTS_BLOCK_INPUT_SIZE / cbRow, std::size_t(1));
+}
+
+//splits the grid into the blocks of rows, the first of which has the header
+static void add_results_blocks(std::vector<results_block>& vBlocks, std::string&& strHeader, const results_grid& grid)
+{
+	auto cBlockRows = results_block_rows(grid);
+	std::size_t iRow = 0;
+	do
+	{
+		auto cRowsInBlock = std::min(cBlockRows, grid.cRows - iRow);
+		vBlocks.emplace_back(results_block{std::move(strHeader), &grid, iRow, cRowsInBlock});
+		strHeader.clear();
+		iRow += cRowsInBlock;
+	}while (iRow < grid.cRows);
+}
+
+static void check_arch_ac_point(const std::uint8_t* pPoint)
+{
+	results_size_type cDims;
+	std::memcpy(&cDims, pPoint, sizeof(cDims));
+	if (cDims != 3)
+		throw std::logic_error("Unexpected size of results");
+}
+
+static void format_results_block(const results_block& block, std::string& str)
+{
+	const auto& grid = *block.pGrid;
+	auto cbPoint = results_point_size(grid.type);
+	str.reserve(block.header.size() + block.cRows * grid.cColumns * cbPoint * 3);
+	str = block.header;
+	for (std::size_t iRow = 0; iRow < block.cRows; ++iRow)
+	{
+		auto pPoint = grid.row(block.iFirstRow + iRow);
+		for (std::size_t iCol = 0; iCol < grid.cColumns; ++iCol, pPoint += cbPoint)
+		{
+			switch (grid.type)
 			{
-				for (size_type iCol = 0; iCol < cColumns; ++iCol)
+			case ResultsGridType::ArchAcPoints:
+				check_arch_ac_point(pPoint);
+				if (iCol != 0) str += ",\t";
+				str += '{';
+				append_double(str, load_double(pPoint + sizeof(results_size_type)));
+				str += ", ";
+				append_double(str, load_double(pPoint + sizeof(results_size_type) + sizeof(double)));
+				str += ", ";
+				append_double(str, load_double(pPoint + sizeof(results_size_type) + 2 * sizeof(double)));
+				str += '}';
+				break;
+			case ResultsGridType::ArchAcIntensity:
+				if (iCol != 0) str += '\t';
+				append_double(str, load_double(pPoint));
+				break;
+			case ResultsGridType::RadioHfPoints:
+				if (iCol != 0) str += ",\t";
+				str += '{';
+				append_double(str, load_double(pPoint));
+				str += ", ";
+				append_double(str, load_double(pPoint + sizeof(double)));
+				str += ", ";
+				append_double(str, load_double(pPoint + 2 * sizeof(double)));
+				str += '}';
+				break;
+			case ResultsGridType::RadioHfField:
+				if (iCol != 0) str += ",\t";
+				for (std::size_t iComponent = 0; iComponent < 3; ++iComponent)
 				{
-					auto eIntensity = read_as<double>(is);;
-					if (iCol != 0) os << "\t";
-					os << eIntensity;
+					str += iComponent == 0?"({":"}, {";
+					append_double(str, load_double(pPoint + 2 * iComponent * sizeof(double)));
+					str += ", ";
+					append_double(str, load_double(pPoint + (2 * iComponent + 1) * sizeof(double)));
 				}
-				os << "\n";
+				str += "})";
+				break;
 			}
 		}
+		str += '\n';
 	}
 }
 
-void bin2text_radio_hf(std::istream& is, std::ostream& os)
+static void write_results_blocks(const std::vector<results_block>& vBlocks, std::ostream& os)
 {
-	typedef std::uint32_t size_type;
-	auto cPlainCount = read_as<size_type>(is);
-	for (size_type iPlain = 0; iPlain < cPlainCount; ++iPlain)
+	auto cMaxPending = 2 * std::size_t(std::max(std::thread::hardware_concurrency(), 1u));
+	std::list<std::future<std::string>> lstPending;
+	auto write_pending_block = [&lstPending, &os]() -> void
 	{
-		auto cbName = read_as<size_type>(is);
-		auto strName = std::string(cbName, char());
-		read_buf(is, strName.data(), cbName);
-		os << "Plain name: " << strName << "\n";
-		auto cColumns = read_as<size_type>(is);
-		auto cRows = read_as<size_type>(is);
-		os << "Control points:\n";
-		for (size_type iRow = 0; iRow < cRows; ++iRow)
+		auto str = lstPending.front().get();
+		lstPending.pop_front();
+		os.write(str.data(), std::streamsize(str.size()));
+	};
+	for (const auto& block:vBlocks)
+	{
+		lstPending.emplace_back(std::async(std::launch::async, [&block]() -> std::string
 		{
-			for (size_type iCol = 0; iCol < cColumns; ++iCol)
+			std::string str;
+			format_results_block(block, str);
+			return str;
+		}));
+		if (lstPending.size() >= cMaxPending)
+			write_pending_block();
+	}
+	while (!lstPending.empty())
+		write_pending_block();
+}
+
+static void results_to_text(const std::vector<results_plain>& vPlains, std::ostream& os)
+{
+	std::vector<results_block> vBlocks;
+	for (const auto& plain:vPlains)
+	{
+		for (const auto& grid:plain.vGrids)
+		{
+			std::string strHeader;
+			if (grid.is_control_points())
 			{
-				auto x = read_as<double>(is);
-				auto y = read_as<double>(is);
-				auto z = read_as<double>(is);
-				if (iCol != 0) os << ",\t";
-				os << '{' << x;
-				os << ", " << y;
-				os << ", " << z << "}";
+				strHeader = "Plain name: ";
+				strHeader.append(plain.name);
+				strHeader += "\nControl points:\n";
+			}else
+			{
+				strHeader = "Results at ";
+				append_double(strHeader, grid.frequency);
+				strHeader += "Hz:\n";
 			}
-			os << "\n";
+			add_results_blocks(vBlocks, std::move(strHeader), grid);
 		}
-		auto cFrequencies = read_as<size_type>(is);
-		for (size_type iFreq = 0; iFreq < cFrequencies /*frequencies*/; ++iFreq)
+	}
+	write_results_blocks(vBlocks, os);
+}
+
+//Writes each field of each grid into its own file of doubles in the order of the rows, named after the manifest. The manifest lists the
+//plains, the grids and the names of the files relative to the manifest.
+static void results_to_columns(const char* pszDomain, const std::vector<results_plain>& vPlains, std::ostream& osManifest, 
+	const std::string& strManifestPath, bool fDiscardOutput)
+{
+	auto iName = strManifestPath.find_last_of("/\\");
+	auto strDirectory = iName == std::string::npos?std::string():strManifestPath.substr(0, iName + 1);
+	auto strFilePrefix = iName == std::string::npos?strManifestPath:strManifestPath.substr(iName + 1);
+	std::string strManifest = "{\n\t\"domain\": \"";
+	strManifest += pszDomain;
+	strManifest += "\",\n\t\"value_type\": \"float64\",\n\t\"byte_order\": \"little\",\n\t\"plains\": [";
+	std::vector<double> vColumn;
+	for (std::size_t iPlain = 0; iPlain < vPlains.size(); ++iPlain)
+	{
+		const auto& plain = vPlains[iPlain];
+		strManifest += iPlain == 0?"\n\t\t{\"index\": ":",\n\t\t{\"index\": ";
+		strManifest += std::to_string(plain.index) + ", \"name\": ";
+		append_json_string(strManifest, plain.name);
+		for (std::size_t iGrid = 0; iGrid < plain.vGrids.size(); ++iGrid)
 		{
-			auto eFrequency = read_as<double>(is);
-			os << "Results at " << eFrequency << "Hz:\n";
-			for (size_type iRow = 0; iRow < cRows; ++iRow)
+			const auto& grid = plain.vGrids[iGrid];
+			std::string strGridFile = strFilePrefix + "." + std::to_string(plain.index) + ".";
+			if (grid.is_control_points())
+			{
+				strGridFile += "points.";
+				strManifest += ", \"control_points\": {";
+			}else
 			{
-				for (size_type iCol = 0; iCol < cColumns; ++iCol)
+				strGridFile += std::to_string(grid.iFrequency) + ".";
+				strManifest += iGrid == 1?"\n\t\t\t{\"index\": ":",\n\t\t\t{\"index\": ";
+				strManifest += std::to_string(grid.iFrequency) + ", \"frequency\": ";
+				append_json_number(strManifest, grid.frequency);
+				strManifest += ", ";
+			}
+			strManifest += "\"first_column\": " + std::to_string(grid.iFirstColumn) + ", \"first_row\": " + std::to_string(grid.iFirstRow) 
+				+ ", \"columns\": " + std::to_string(grid.cColumns) + ", \"rows\": " + std::to_string(grid.cRows) + ", \"fields\": {";
+			auto [pFields, cFields] = results_fields(grid.type);
+			auto cbPoint = results_point_size(grid.type);
+			auto cBlockRows = grid.cColumns == 0?std::max(grid.cRows, std::size_t(1)):std::max(RESULTS_BLOCK_INPUT_SIZE / sizeof(double) / grid.cColumns, std::size_t(1));
+			for (std::size_t iField = 0; iField < cFields; ++iField)
+			{
+				auto strFile = strGridFile + pFields[iField].name + ".f64";
+				binary_ofstream os(strDirectory + strFile, fDiscardOutput);
+				if (!os)
+					throw std::runtime_error("Failed to open the file \"" + strDirectory + strFile + "\".");
+				for (std::size_t iRow = 0; iRow < grid.cRows; iRow += cBlockRows)
 				{
-					auto eExAmp = read_as<double>(is);
-					auto eExArg = read_as<double>(is);
-					auto eEyAmp = read_as<double>(is);
-					auto eEyArg = read_as<double>(is);
-					auto eEzAmp = read_as<double>(is);
-					auto eEzArg = read_as<double>(is);
-					if (iCol != 0) os << ",\t";
-					os << "({" 
-						<< eExAmp << ", " << eExArg << "}, {"
-						<< eEyAmp << ", " << eEyArg << "}, {"
-						<< eEzAmp << ", " << eEzArg << "})";
+					auto cRowsInBlock = std::min(cBlockRows, grid.cRows - iRow);
+					vColumn.resize(cRowsInBlock * grid.cColumns);
+					auto pVal = vColumn.data();
+					for (std::size_t iRowInBlock = 0; iRowInBlock < cRowsInBlock; ++iRowInBlock)
+					{
+						auto pPoint = grid.row(iRow + iRowInBlock);
+						for (std::size_t iCol = 0; iCol < grid.cColumns; ++iCol, pPoint += cbPoint)
+						{
+							if (grid.type == ResultsGridType::ArchAcPoints && iField == 0)
+								check_arch_ac_point(pPoint);
+							*pVal++ = load_double(pPoint + pFields[iField].offset);
+						}
+					}
+					os.write(vColumn.data(), vColumn.size() * sizeof(double));
 				}
-				os << "\n";
+				if (!os)
+					throw std::runtime_error("Failed to write the file \"" + strDirectory + strFile + "\".");
+				strManifest += iField == 0?"\"":", \"";
+				strManifest += pFields[iField].name;
+				strManifest += "\": ";
+				append_json_string(strManifest, strFile);
 			}
+			strManifest += grid.is_control_points()?"}}, \"frequencies\": [":"}}";
+		}
+		strManifest += plain.vGrids.size() > 1?"\n\t\t]}":"]}";
+	}
+	strManifest += "\n\t]\n}\n";
+	osManifest.write(strManifest.data(), std::streamsize(strManifest.size()));
+}
+
+//the coordinates are written as the results are: the shortest representation which reads back to the same value
+static std::ostream& operator<<(std::ostream& os, const point_t& pt)
+{
+	std::string str;
+	str += '{';
+	append_double(str, pt.x);
+	str += ", ";
+	append_double(str, pt.y);
+	str += ", ";
+	append_double(str, pt.z);
+	str += '}';
+	return os.write(str.data(), std::streamsize(str.size()));
+}
+
+//Domain data is opaque to the text representation, so only the domain names and the data sizes are written
+static void model_domain_data_to_text(const model_domain_data_view& domain_data, std::ostream& os, const char* indent)
+{
+	for (auto datum:domain_data)
+		os << indent << "Domain data: " << datum.domain << " (" << datum.size << " bytes)\n";
+}
+
+static void model_face_to_text(const model_face_view& face, const model_points_view& vertices, std::ostream& os)
+{
+	os << "  Face:";
+	if (face.is_indexed())
+	{
+		auto indices = face.indices();
+		for (std::size_t iVertex = 0; iVertex < indices.size(); ++iVertex)
+			os << (iVertex == 0?" ":",\t") << vertices[indices[iVertex]];
+	}else
+	{
+		auto face_vertices = face.vertices();
+		for (std::size_t iVertex = 0; iVertex < face_vertices.size(); ++iVertex)
+			os << (iVertex == 0?" ":",\t") << face_vertices[iVertex];
+	}
+	os << "\n";
+	model_domain_data_to_text(face.domain_data(), os, "   ");
+}
+
+//Statistics of a field of a grid of results. The values are reduced by RESULTS_STATISTICS_LANES independent accumulators over the rows
+//of the field loaded into a contiguous buffer, so that the reductions are vectorized by the compiler.
+
+static constexpr std::size_t RESULTS_STATISTICS_LANES = 4;
+static constexpr std::size_t RESULTS_HISTOGRAM_BINS = 32;
+static constexpr double RESULTS_PERCENTILES[] = {1, 5, 25, 50, 75, 95, 99};
+
+static constexpr results_field RADIO_HF_AMPLITUDE_FIELDS[] = {{"ex_amp", 0}, {"ey_amp", 2 * sizeof(double)}, {"ez_amp", 4 * sizeof(double)}};
+
+//intensities of arch_ac and amplitudes of the field components of radio_hf
+static std::pair<const results_field*, std::size_t> results_statistics_fields(ResultsGridType type)
+{
+	if (type == ResultsGridType::ArchAcIntensity)
+		return {std::begin(ARCH_AC_INTENSITY_FIELDS), std::size(ARCH_AC_INTENSITY_FIELDS)};
+	return {std::begin(RADIO_HF_AMPLITUDE_FIELDS), std::size(RADIO_HF_AMPLITUDE_FIELDS)};
+}
+
+//NaN and infinite values are counted separately and do not take part in the other statistics
+struct field_statistics
+{
+	std::size_t count = 0; //of the finite values
+	std::size_t non_finite = 0;
+	double min = std::numeric_limits<double>::infinity();
+	double max = -std::numeric_limits<double>::infinity();
+	double sum = 0;
+	std::array<std::uint64_t, RESULTS_HISTOGRAM_BINS> histogram = {}; //of [min, max] divided into bins of the same width
+};
+
+static void load_field_row(const results_grid& grid, std::size_t iRow, std::size_t offset, double* pOut)
+{
+	auto cbPoint = results_point_size(grid.type);
+	auto pPoint = grid.row(iRow) + offset;
+	for (std::size_t iCol = 0; iCol < grid.cColumns; ++iCol, pPoint += cbPoint)
+		pOut[iCol] = load_double(pPoint);
+}
+
+struct min_max_sum
+{
+	double min;
+	double max;
+	double sum;
+	std::size_t count;
+};
+
+//with fSkipNonFinite == false all values are assumed to be finite
+template <bool fSkipNonFinite>
+static min_max_sum reduce_lanes(const double* pValues, std::size_t cValues, double eMin, double eMax)
+{
+	double lo[RESULTS_STATISTICS_LANES], hi[RESULTS_STATISTICS_LANES], sum[RESULTS_STATISTICS_LANES];
+	std::size_t count[RESULTS_STATISTICS_LANES];
+	for (std::size_t iLane = 0; iLane < RESULTS_STATISTICS_LANES; ++iLane)
+	{
+		lo[iLane] = eMin;
+		hi[iLane] = eMax;
+		sum[iLane] = 0;
+		count[iLane] = 0;
+	}
+	auto reduce = [pValues, &lo, &hi, &sum, &count](std::size_t iValue, std::size_t iLane) -> void
+	{
+		auto val = pValues[iValue];
+		if constexpr (fSkipNonFinite)
+		{
+			auto fFinite = std::isfinite(val);
+			lo[iLane] = fFinite && val < lo[iLane]?val:lo[iLane];
+			hi[iLane] = fFinite && val > hi[iLane]?val:hi[iLane];
+			sum[iLane] += fFinite?val:0.0;
+			count[iLane] += fFinite?1:0;
+		}else
+		{
+			lo[iLane] = val < lo[iLane]?val:lo[iLane];
+			hi[iLane] = val > hi[iLane]?val:hi[iLane];
+			sum[iLane] += val;
+		}
+	};
+	std::size_t iValue = 0;
+	for (; iValue + RESULTS_STATISTICS_LANES <= cValues; iValue += RESULTS_STATISTICS_LANES)
+	{
+		for (std::size_t iLane = 0; iLane < RESULTS_STATISTICS_LANES; ++iLane)
+			reduce(iValue + iLane, iLane);
+	}
+	for (; iValue < cValues; ++iValue)
+		reduce(iValue, 0);
+	min_max_sum res = {eMin, eMax, 0, fSkipNonFinite?0:cValues};
+	for (std::size_t iLane = 0; iLane < RESULTS_STATISTICS_LANES; ++iLane)
+	{
+		res.min = std::min(res.min, lo[iLane]);
+		res.max = std::max(res.max, hi[iLane]);
+		res.sum += sum[iLane];
+		res.count += count[iLane];
+	}
+	return res;
+}
+
+//The values are checked for being finite only if the sum of the row is not, which is the case if any of them is NaN or infinite.
+static void reduce_min_max_sum(const double* pValues, std::size_t cValues, field_statistics& stats)
+{
+	auto res = reduce_lanes<false>(pValues, cValues, stats.min, stats.max);
+	if (!std::isfinite(res.sum))
+		res = reduce_lanes<true>(pValues, cValues, stats.min, stats.max);
+	stats.min = res.min;
+	stats.max = res.max;
+	stats.sum += res.sum;
+	stats.count += res.count;
+	stats.non_finite += cValues - res.count;
+}
+
+//with fSkipNonFinite == false all values are assumed to be finite
+template <bool fSkipNonFinite>
+static void add_to_histogram(const double* pValues, std::size_t cValues, field_statistics& stats)
+{
+	//the halves keep the range of finite values finite
+	auto eHalfMin = stats.min / 2;
+	auto scale = stats.max > stats.min?double(RESULTS_HISTOGRAM_BINS) / (stats.max / 2 - eHalfMin):0.0;
+	for (std::size_t iValue = 0; iValue < cValues; ++iValue)
+	{
+		auto bin = (pValues[iValue] / 2 - eHalfMin) * scale;
+		//NaN and infinities, the finite values are within [0, RESULTS_HISTOGRAM_BINS] up to the rounding
+		if (fSkipNonFinite && !(bin >= 0 && bin < double(RESULTS_HISTOGRAM_BINS + 1)))
+			continue;
+		++stats.histogram[std::min(std::size_t(bin), RESULTS_HISTOGRAM_BINS - 1)];
+	}
+}
+
+//the values are assumed to be evenly distributed within the bins of the histogram
+static double histogram_percentile(const field_statistics& stats, double ePercentile)
+{
+	std::uint64_t cTotal = 0;
+	for (auto cInBin:stats.histogram)
+		cTotal += cInBin;
+	auto eRank = ePercentile / 100 * double(cTotal);
+	std::uint64_t cBelow = 0;
+	for (std::size_t iBin = 0; iBin < RESULTS_HISTOGRAM_BINS; ++iBin)
+	{
+		auto cInBin = stats.histogram[iBin];
+		if (cInBin != 0 && double(cBelow + cInBin) >= eRank)
+		{
+			//interpolated between min and max, which does not overflow for any finite range
+			auto ePosition = (double(iBin) + (eRank - double(cBelow)) / double(cInBin)) / double(RESULTS_HISTOGRAM_BINS);
+			return stats.min * (1 - ePosition) + stats.max * ePosition;
+		}
+		cBelow += cInBin;
+	}
+	return stats.max;
+}
+
+static void append_field_statistics(std::string& str, const field_statistics& stats)
+{
+	str += "{\"count\": " + std::to_string(stats.count) + ", \"non_finite\": " + std::to_string(stats.non_finite);
+	if (stats.count != 0)
+	{
+		str += ", \"min\": ";
+		append_json_number(str, stats.min);
+		str += ", \"max\": ";
+		append_json_number(str, stats.max);
+		str += ", \"mean\": ";
+		append_json_number(str, stats.sum / double(stats.count));
+		str += ", \"percentiles\": {";
+		for (std::size_t iPercentile = 0; iPercentile < std::size(RESULTS_PERCENTILES); ++iPercentile)
+		{
+			str += iPercentile == 0?"\"":", \"";
+			append_double(str, RESULTS_PERCENTILES[iPercentile]);
+			str += "\": ";
+			append_json_number(str, histogram_percentile(stats, RESULTS_PERCENTILES[iPercentile]));
+		}
+		str += "}, \"histogram\": [";
+		for (std::size_t iBin = 0; iBin < RESULTS_HISTOGRAM_BINS; ++iBin)
+		{
+			if (iBin != 0)
+				str += ", ";
+			str += std::to_string(stats.histogram[iBin]);
+		}
+		str += "]";
+	}
+	str += "}";
+}
+
+//the part of the statistics document describing the plain
+static std::string plain_statistics(const results_plain& plain)
+{
+	std::string str = "{\"index\": " + std::to_string(plain.index) + ", \"name\": ";
+	append_json_string(str, plain.name);
+	str += ", \"frequencies\": [";
+	std::vector<double> vRow;
+	bool fFirst = true;
+	for (const auto& grid:plain.vGrids)
+	{
+		if (grid.is_control_points())
+			continue;
+		str += fFirst?"\n\t\t\t{\"index\": ":",\n\t\t\t{\"index\": ";
+		fFirst = false;
+		str += std::to_string(grid.iFrequency) + ", \"frequency\": ";
+		append_json_number(str, grid.frequency);
+		str += ", \"fields\": {";
+		auto [pFields, cFields] = results_statistics_fields(grid.type);
+		vRow.resize(grid.cColumns);
+		for (std::size_t iField = 0; iField < cFields; ++iField)
+		{
+			field_statistics stats;
+			for (std::size_t iRow = 0; iRow < grid.cRows; ++iRow)
+			{
+				load_field_row(grid, iRow, pFields[iField].offset, vRow.data());
+				reduce_min_max_sum(vRow.data(), vRow.size(), stats);
+			}
+			//the bins depend on the range of the values, hence the second pass
+			for (std::size_t iRow = 0; iRow < grid.cRows; ++iRow)
+			{
+				load_field_row(grid, iRow, pFields[iField].offset, vRow.data());
+				if (stats.non_finite == 0)
+					add_to_histogram<false>(vRow.data(), vRow.size(), stats);
+				else
+					add_to_histogram<true>(vRow.data(), vRow.size(), stats);
+			}
+			str += iField == 0?"\"":", \"";
+			str += pFields[iField].name;
+			str += "\": ";
+			append_field_statistics(str, stats);
+		}
+		str += "}}";
+	}
+	str += fFirst?"]}":"\n\t\t]}";
+	return str;
+}
+
+//The plains are processed in parallel, the statistics are written in the order of the file.
+static void results_to_statistics(const char* pszDomain, const std::vector<results_plain>& vPlains, std::ostream& os)
+{
+	std::string str = "{\n\t\"domain\": \"";
+	str += pszDomain;
+	str += "\",\n\t\"plains\": [";
+	os.write(str.data(), std::streamsize(str.size()));
+	auto cMaxPending = 2 * std::size_t(std::max(std::thread::hardware_concurrency(), 1u));
+	std::list<std::future<std::string>> lstPending;
+	bool fFirst = true;
+	auto write_pending_plain = [&lstPending, &os, &fFirst]() -> void
+	{
+		auto str = std::string(fFirst?"\n\t\t":",\n\t\t") + lstPending.front().get();
+		lstPending.pop_front();
+		fFirst = false;
+		os.write(str.data(), std::streamsize(str.size()));
+	};
+	for (const auto& plain:vPlains)
+	{
+		lstPending.emplace_back(std::async(std::launch::async, [&plain]() -> std::string
+		{
+			return plain_statistics(plain);
+		}));
+		if (lstPending.size() >= cMaxPending)
+			write_pending_plain();
+	}
+	while (!lstPending.empty())
+		write_pending_plain();
+	str = "\n\t]\n}\n";
+	os.write(str.data(), std::streamsize(str.size()));
+}
+
+namespace Implementation
+{
+
+void bin2text_arch_ac(const std::string& strInput, std::ostream& os, const RESULTS_FILTER& filter)
+{
+	mapped_file input(strInput);
+	results_to_text(read_arch_ac_results(input, filter), os);
+}
+
+void bin2text_radio_hf(const std::string& strInput, std::ostream& os, const RESULTS_FILTER& filter)
+{
+	mapped_file input(strInput);
+	results_to_text(read_radio_hf_results(input, filter), os);
+}
+
+void bin2columns_arch_ac(const std::string& strInput, std::ostream& osManifest, const std::string& strManifestPath, bool fDiscardOutput, 
+	const RESULTS_FILTER& filter)
+{
+	mapped_file input(strInput);
+	results_to_columns("arch_ac", read_arch_ac_results(input, filter), osManifest, strManifestPath, fDiscardOutput);
+}
+
+void bin2columns_radio_hf(const std::string& strInput, std::ostream& osManifest, const std::string& strManifestPath, bool fDiscardOutput, 
+	const RESULTS_FILTER& filter)
+{
+	mapped_file input(strInput);
+	results_to_columns("radio_hf", read_radio_hf_results(input, filter), osManifest, strManifestPath, fDiscardOutput);
+}
+
+void bin2statistics_arch_ac(const std::string& strInput, std::ostream& os, const RESULTS_FILTER& filter)
+{
+	mapped_file input(strInput);
+	results_to_statistics("arch_ac", read_arch_ac_results(input, filter), os);
+}
+
+void bin2statistics_radio_hf(const std::string& strInput, std::ostream& os, const RESULTS_FILTER& filter)
+{
+	mapped_file input(strInput);
+	results_to_statistics("radio_hf", read_radio_hf_results(input, filter), os);
+}
+
+void bin2text_model(const std::string& strInput, std::ostream& os)
+{
+	model_reader model(strInput);
+	os << "Model name: " << model.name() << "\n";
+	os << "Units: " << model.units() << "\n";
+	os << "Size: " << model.size() << "\n";
+	model_domain_data_to_text(model.domain_data(), os, "");
+	for (std::size_t iObject = 0; iObject < model.object_count(); ++iObject)
+	{
+		auto object = model.object(iObject);
+		switch (object.type())
+		{
+		case ObjectPoly:
+		case ObjectIndexedPoly: //vertices of indexed objects are expanded, so that both representations produce the same text
+		{
+			os << "Poly object: " << object.name() << "\n";
+			model_domain_data_to_text(object.domain_data(), os, " ");
+			auto faces = object.faces();
+			os << " Faces: " << faces.size() << "\n";
+			auto vertices = object.vertices();
+			for (const auto& face:faces)
+				model_face_to_text(face, vertices, os);
+			break;
+		}
+		default:
+		{
+			os << (object.type() == ObjectSource?"Source object: ":"Plain object: ") << object.name() << "\n";
+			model_domain_data_to_text(object.domain_data(), os, " ");
+			os << " Position: " << object.position() << "\n";
+			auto vectors = object.vectors();
+			os << " Vectors:";
+			for (std::size_t iVector = 0; iVector < vectors.size(); ++iVector)
+				os << (iVector == 0?" ":",\t") << vectors[iVector];
+			os << "\n";
+			break;
+		}
 		}
 	}
 }
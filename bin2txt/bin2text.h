@@ -2,27 +2,91 @@
 #include <iostream>
 #include <string>
 #include <stdexcept>
+#include <set>
+#include <limits>
 #include <binary_streams.h>
 
 #ifndef BIN2TEXT_H_
 #define BIN2TEXT_H_
 
+//selects a part of a results file to convert
+struct RESULTS_FILTER
+{
+	//names of the plains to convert, all plains if empty
+	std::set<std::string, std::less<>> setPlains;
+	//results at the frequencies (in Hz) outside of [eMinFrequency, eMaxFrequency] are not converted. Control points of the plains
+	//are converted regardless of the frequencies.
+	double eMinFrequency = -std::numeric_limits<double>::infinity();
+	double eMaxFrequency = std::numeric_limits<double>::infinity();
+	//window of each grid (control points and results) to convert, clipped to the size of the grid
+	std::size_t iFirstColumn = 0;
+	std::size_t cColumns = std::numeric_limits<std::size_t>::max();
+	std::size_t iFirstRow = 0;
+	std::size_t cRows = std::numeric_limits<std::size_t>::max();
+};
+
 namespace Implementation
 {
-	void bin2text_arch_ac(std::istream& is, std::ostream& os);
-	void bin2text_radio_hf(std::istream& is, std::ostream& os);
+	void bin2text_arch_ac(const std::string& strInput, std::ostream& os, const RESULTS_FILTER& filter);
+	void bin2text_radio_hf(const std::string& strInput, std::ostream& os, const RESULTS_FILTER& filter);
+	void bin2columns_arch_ac(const std::string& strInput, std::ostream& osManifest, const std::string& strManifestPath, bool fDiscardOutput, 
+		const RESULTS_FILTER& filter);
+	void bin2columns_radio_hf(const std::string& strInput, std::ostream& osManifest, const std::string& strManifestPath, bool fDiscardOutput, 
+		const RESULTS_FILTER& filter);
+	void bin2statistics_arch_ac(const std::string& strInput, std::ostream& os, const RESULTS_FILTER& filter);
+	void bin2statistics_radio_hf(const std::string& strInput, std::ostream& os, const RESULTS_FILTER& filter);
+	void bin2text_model(const std::string& strInput, std::ostream& os);
+}
+
+//writes a text representation of a results file. Numbers are written in the shortest form which reads back to the same value.
+template <class DomainString>
+void bin2text(const DomainString& strDomain, const std::string& strInput, std::ostream& os, const RESULTS_FILTER& filter = {})
+{
+	using namespace Implementation;
+	if (strDomain == "arch_ac")
+		bin2text_arch_ac(strInput, os, filter);
+	else if (strDomain == "radio_hf")
+		bin2text_radio_hf(strInput, os, filter);
+	else
+		throw std::invalid_argument("Invalid domain name");
 }
 
+//writes each field of each grid of a results file (coordinates of the control points, intensities or amplitudes and arguments of the
+//field components) into a separate file of little-endian doubles in the row-major order. The files are named after the manifest
+//path and placed next to it, the manifest written to osManifest is a JSON document describing the plains, the grids and the files.
+//Unless fDiscardOutput is set, existing non-empty column files are not overwritten and std::runtime_error is thrown.
 template <class DomainString>
-void bin2text(const DomainString& strDomain, std::istream& is, std::ostream& os)
+void bin2columns(const DomainString& strDomain, const std::string& strInput, std::ostream& osManifest, const std::string& strManifestPath, 
+	bool fDiscardOutput, const RESULTS_FILTER& filter = {})
 {
 	using namespace Implementation;
 	if (strDomain == "arch_ac")
-		bin2text_arch_ac(is, os);
+		bin2columns_arch_ac(strInput, osManifest, strManifestPath, fDiscardOutput, filter);
 	else if (strDomain == "radio_hf")
-		bin2text_radio_hf(is, os);
+		bin2columns_radio_hf(strInput, osManifest, strManifestPath, fDiscardOutput, filter);
 	else
 		throw std::invalid_argument("Invalid domain name");
 }
 
+//writes a JSON document with the statistics of the intensities (arch_ac) or the amplitudes of the field components (radio_hf) of
+//each plain at each frequency: count, min, max, mean, percentiles and a histogram of [min, max] divided into bins of the same width.
+//The percentiles are estimated from the histogram. NaN and infinite values are excluded from these and counted separately.
+template <class DomainString>
+void bin2statistics(const DomainString& strDomain, const std::string& strInput, std::ostream& os, const RESULTS_FILTER& filter = {})
+{
+	using namespace Implementation;
+	if (strDomain == "arch_ac")
+		bin2statistics_arch_ac(strInput, os, filter);
+	else if (strDomain == "radio_hf")
+		bin2statistics_radio_hf(strInput, os, filter);
+	else
+		throw std::invalid_argument("Invalid domain name");
+}
+
+//writes a text representation of a binary model produced by xml2bin. Faces of indexed poly objects are expanded to their vertices.
+inline void model2text(const std::string& strInput, std::ostream& os)
+{
+	Implementation::bin2text_model(strInput, os);
+}
+
 #endif //BIN2TEXT_H_
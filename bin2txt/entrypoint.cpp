@@ -5,9 +5,8 @@
 #include <fstream>
 #include <algorithm>
 #include <sstream>
-
-#include <locale>
-#include <codecvt>
+#include <cstdlib>
+#include <cmath>
 
 struct invalid_usage:std::runtime_error
 {
@@ -50,6 +49,49 @@ public:
 				if (m_fDiscardOutput)
 					throw invalid_usage();
 				m_fDiscardOutput = true;
+			}else if (std::string_view(argv[i]) == "--model")
+			{
+				if (m_fModel)
+					throw invalid_usage();
+				m_fModel = true;
+			}else if (std::string_view(argv[i]) == "--columns")
+			{
+				if (m_fColumns)
+					throw invalid_usage();
+				m_fColumns = true;
+			}else if (std::string_view(argv[i]) == "--statistics")
+			{
+				if (m_fStatistics)
+					throw invalid_usage();
+				m_fStatistics = true;
+			}else if (std::string_view(argv[i]) == "--plain")
+			{
+				if (i == argc - 1 || !m_filter.setPlains.emplace(argv[++i]).second)
+					throw invalid_usage();
+				m_fFiltered = true;
+			}else if (std::string_view(argv[i]) == "--frequency_range")
+			{
+				if (argc - i <= 2 || m_filter.eMinFrequency > -std::numeric_limits<double>::infinity())
+					throw invalid_usage();
+				m_filter.eMinFrequency = parse_frequency(argv[++i]);
+				m_filter.eMaxFrequency = parse_frequency(argv[++i]);
+				if (m_filter.eMinFrequency > m_filter.eMaxFrequency)
+					throw invalid_usage();
+				m_fFiltered = true;
+			}else if (std::string_view(argv[i]) == "--row_range")
+			{
+				if (argc - i <= 2 || m_filter.cRows != std::numeric_limits<std::size_t>::max())
+					throw invalid_usage();
+				m_filter.iFirstRow = parse_size(argv[++i]);
+				m_filter.cRows = parse_size(argv[++i]);
+				m_fFiltered = true;
+			}else if (std::string_view(argv[i]) == "--column_range")
+			{
+				if (argc - i <= 2 || m_filter.cColumns != std::numeric_limits<std::size_t>::max())
+					throw invalid_usage();
+				m_filter.iFirstColumn = parse_size(argv[++i]);
+				m_filter.cColumns = parse_size(argv[++i]);
+				m_fFiltered = true;
 			}else if (argv[i][0] == '-' && argv[i][1] == '-')
 				throw invalid_usage();
 			else
@@ -66,22 +108,23 @@ public:
 	}
 	bool is_ready() const
 	{
-		return !m_input.empty() && !m_output.empty() && !m_domain.empty();
+		return !m_input.empty() && !m_output.empty() && (m_domain.empty() == m_fModel) && !(m_fModel && (m_fColumns || m_fStatistics || m_fFiltered)) 
+			&& !(m_fColumns && m_fStatistics);
 	}
 	Program& run()
 	{
-		std::ifstream is(m_input, std::ios_base::in | std::ios_base::binary);
-		if (is.fail())
-			throw failed_to_open_a_file(m_input);
+		//the input is mapped by the conversion, which fails, if the file cannot be opened
 		std::ofstream os(m_output, std::ios_base::out | (m_fDiscardOutput?std::ios_base::trunc:std::ios_base::app));
-#ifdef _MSC_VER
-		os.imbue(std::locale(std::locale(""), new std::codecvt_utf8<wchar_t>()));
-#else
-		os.imbue(std::locale(""));
-#endif
 		if (os.fail() || os.rdbuf()->pubseekoff(std::ofstream::off_type(), std::ios_base::end, std::ios_base::out) != std::ofstream::pos_type())
 			throw failed_to_open_a_file(m_output);
-		bin2text(m_domain, is, os);
+		if (m_fModel)
+			model2text(m_input, os);
+		else if (m_fColumns)
+			bin2columns(m_domain, m_input, os, m_output, m_fDiscardOutput, m_filter);
+		else if (m_fStatistics)
+			bin2statistics(m_domain, m_input, os, m_filter);
+		else
+			bin2text(m_domain, m_input, os, m_filter);
 		return *this;
 	}
 private:
@@ -90,7 +133,28 @@ private:
 	std::string m_output;
 	static std::string m_help_str;
 	bool m_fDiscardOutput = false;
+	bool m_fModel = false;
+	bool m_fColumns = false;
+	bool m_fStatistics = false;
+	RESULTS_FILTER m_filter;
+	bool m_fFiltered = false;
 
+	static double parse_frequency(const char* psz)
+	{
+		char* pEnd;
+		auto val = std::strtod(psz, &pEnd);
+		if (*pEnd != '\0' || pEnd == psz || std::isnan(val))
+			throw invalid_usage();
+		return val;
+	}
+	static std::size_t parse_size(const char* psz)
+	{
+		char* pEnd;
+		auto val = std::strtoull(psz, &pEnd, 10);
+		if (*pEnd != '\0' || pEnd == psz || *psz == '-')
+			throw invalid_usage();
+		return std::size_t(val);
+	}
 	void add_file(std::string str)
 	{
 		if (m_input.empty())
@@ -103,11 +167,31 @@ private:
 };
 
 std::string Program::m_help_str =
-"bin2txt <--domain <domain_name> [--discard_output] <input_binary_file> <output_text_file>>|<--help>\n"\
+"bin2txt <<--domain <domain_name> [--columns|--statistics] [--plain <name>]... [--frequency_range <min> <max>] [--row_range <first> <count>]\n"\
+"       [--column_range <first> <count>]|--model> [--discard_output] <input_binary_file> <output_text_file>>|<--help>\n"\
 " --domain specifies a domain system id for which the program should perform the conversion.\n"\
+" --model is a switch which makes the program convert a binary model produced by xml2bin instead of the simulation results. Faces\n"\
+"       of indexed polygonal objects (see xml2bin --indexed_hgt) are expanded to the coordinates of their vertices. The model may\n"\
+"       be compressed (see xml2bin --compress).\n"\
+" --columns is a switch which makes the program write each field of the results (coordinates of the control points, intensities,\n"\
+"       amplitudes and arguments of the field components) of each grid into a separate file of raw little-endian doubles, instead\n"\
+"       of the text. The files are placed next to output_text_file and named after it, e.g. <output_text_file>.0.points.x.f64 and\n"\
+"       <output_text_file>.0.1.ex_amp.f64 for the plain 0 and the frequency 1, while output_text_file receives a JSON manifest\n"\
+"       describing the plains, the grids and the files. Not allowed with --model.\n"\
+" --statistics is a switch which makes the program write, instead of the text, a JSON document with the statistics of the\n"\
+"       intensities (arch_ac) or the amplitudes of Ex, Ey and Ez (radio_hf) of each plain at each frequency: count, min, max,\n"\
+"       mean, a histogram of 32 bins of the same width between min and max, and the percentiles estimated from the histogram.\n"\
+"       NaN and infinite values are excluded from these and counted as non_finite. Not allowed with --columns and --model.\n"\
+" --plain specifies a name of a plain to convert. May be repeated. If not set, all plains are converted.\n"\
+" --frequency_range specifies the lowest and the highest frequency (in Hz) of the results to convert. Control points of the plains\n"\
+"       are converted regardless of the range.\n"\
+" --row_range and --column_range specify the first row (column) and the number of rows (columns) of each grid of control points\n"\
+"       and results to convert. The ranges are clipped to the size of each grid.\n"\
+"       The parts of the results which are not selected by --plain, --frequency_range, --row_range and --column_range are skipped\n"\
+"       without being read. These options are not allowed with --model.\n"\
 " --discard_output is a switch which allows to truncate the output file before the processing, should the file exist. Otherwise, if\n"\
-"       the output file exists and not empty, the program will fail.\n"\
-" input_binary_file specifies a path to raw results of CAMaaS simulation to convert to text.\n"\
+"       the output file (or a column file) exists and not empty, the program will fail.\n"\
+" input_binary_file specifies a path to raw results of CAMaaS simulation, or to a binary model if --model is set, to convert to text.\n"\
 " output_text_file specifies a path to the output text file.\n"\
 " --help displays this message.\n";
 
@@ -0,0 +1,42 @@
+#include <domain_plugin.h>
+#include <cstring>
+#include <cstdint>
+
+//An example of a domain plugin (see domain_plugin.h). The domain "passthrough" has the data of every kind, which are written
+//unchanged: the 32-bit little-endian number of the bytes of the text followed by the text. There are no constant domain data. The
+//conversion is pure, so the identical domain data can be converted once.
+
+static int passthrough_domain_data(void*, camaas_text text, const camaas_domain_output* output)
+{
+	if (text.size > UINT32_MAX)
+		return CAMAAS_DOMAIN_DATA_INVALID;
+	auto pData = output->append(output->context, sizeof(std::uint32_t) + text.size);
+	if (pData == nullptr)
+		return CAMAAS_DOMAIN_DATA_INVALID;
+	auto cb = std::uint32_t(text.size);
+	for (std::size_t iByte = 0; iByte < sizeof(cb); ++iByte)
+		pData[iByte] = static_cast<unsigned char>(cb >> (8 * iByte));
+	std::memcpy(pData + sizeof(cb), text.data, text.size);
+	return CAMAAS_DOMAIN_DATA_CONVERTED;
+}
+
+static const char* passthrough_last_error(void*)
+{
+	return "the domain data are too long or the memory cannot be allocated";
+}
+
+extern "C" CAMAAS_DOMAIN_PLUGIN_EXPORT int camaas_domain_plugin_entry(std::uint32_t abi_version, camaas_domain_plugin* plugin)
+{
+	if (abi_version != CAMAAS_DOMAIN_PLUGIN_ABI_VERSION)
+		return 1;
+	*plugin = camaas_domain_plugin{};
+	plugin->domain_name = "passthrough";
+	plugin->model_domain_data = &passthrough_domain_data;
+	plugin->poly_domain_data = &passthrough_domain_data;
+	plugin->face_domain_data = &passthrough_domain_data;
+	plugin->source_domain_data = &passthrough_domain_data;
+	plugin->plain_domain_data = &passthrough_domain_data;
+	plugin->last_error = &passthrough_last_error;
+	plugin->flags = CAMAAS_DOMAIN_PLUGIN_DETERMINISTIC;
+	return 0;
+}
@@ -1,6 +1,4 @@
 #include <binary_streams.h>
-#include <locale>
-#include <codecvt>
 
 #if FILESYSTEM_CPP17
 unsigned temp_path::suffix = unsigned();
@@ -16,6 +14,12 @@ buf_ostream& buf_ostream::write(const void* pInput, std::size_t cbHowMany)
 		std::copy(static_cast<const std::uint8_t*>(pInput), static_cast<const std::uint8_t*>(pInput) + cbHowMany,
 			std::back_inserter(m_buf));
 		m_cbOffset += cbHowMany;
+	}else if (m_lst_buf.empty() && m_cbOffset >= m_buf.size() && cb <= m_buf.capacity())
+	{
+		//the buffer is reused, hence the appended data fit into its capacity without a list block
+		m_buf.resize(m_cbOffset);
+		m_buf.insert(m_buf.end(), static_cast<const std::uint8_t*>(pInput), static_cast<const std::uint8_t*>(pInput) + cbHowMany);
+		m_cbOffset = cb;
 	}else if (m_cbOffset >= this->size())
 	{
 		auto cbFill = m_cbOffset - this->size();
@@ -200,9 +204,3 @@ buf_istream& buf_istream::operator=(buf_istream&& right)
 	this->rdbuf(&m_buf);
 	return *this;
 }
-
-std::string encode_string(const std::wstring& str)
-{
-	typedef std::codecvt_utf8<wchar_t> codecvt;
-	return std::wstring_convert<codecvt>().to_bytes(str);
-}
@@ -0,0 +1,381 @@
+#include <compressed_streams.h>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <fstream>
+
+static constexpr std::size_t COMPRESSED_STREAM_HEADER_SIZE = sizeof(COMPRESSED_STREAM_MAGIC) + 2 * sizeof(std::uint32_t);
+static constexpr std::size_t COMPRESSED_STREAM_FOOTER_SIZE = 3 * sizeof(std::uint64_t) + 3 * sizeof(std::uint32_t) + sizeof(COMPRESSED_STREAM_MAGIC);
+static constexpr std::size_t COMPRESSED_BLOCK_ENTRY_SIZE = sizeof(std::uint64_t) + 2 * sizeof(std::uint32_t);
+
+namespace
+{
+	enum CompressionMethod:std::uint32_t
+	{
+		CompressionStored, //the block is stored as is, since it does not compress
+		CompressionLz
+	};
+
+	//An LZ77 block codec with the LZ4 block format: a sequence of a token (literal count in the high nibble, match length minus
+	//LZ_MIN_MATCH in the low one, 15 meaning that more length bytes follow, each 255 meaning one more), the literals, the offset of
+	//the match (uint16) and the match length bytes. The last sequence of a block has literals only.
+	constexpr std::size_t LZ_MIN_MATCH = 4;
+	constexpr std::size_t LZ_MAX_OFFSET = 0xFFFF;
+	constexpr std::size_t LZ_LAST_LITERALS = 5; //matches end that many bytes before the end of the block at least
+	constexpr std::size_t LZ_MATCH_LIMIT = 12; //matches start that many bytes before the end of the block at least
+	constexpr unsigned LZ_HASH_BITS = 16;
+	constexpr unsigned LZ_SKIP_TRIGGER = 6; //the search steps faster through the data which does not compress
+
+	template <class T>
+	inline T load(const std::uint8_t* pData) noexcept
+	{
+		T val;
+		std::memcpy(&val, pData, sizeof(T));
+		return val;
+	}
+
+	inline std::size_t lz_hash(std::uint32_t seq) noexcept
+	{
+		return std::size_t((seq * 2654435761u) >> (32 - LZ_HASH_BITS));
+	}
+
+	void lz_write_length(std::vector<std::uint8_t>& vOut, std::size_t cb)
+	{
+		for (; cb >= 255; cb -= 255)
+			vOut.push_back(255);
+		vOut.push_back(std::uint8_t(cb));
+	}
+
+	//the last sequence has cbMatch equal to zero
+	void lz_write_sequence(std::vector<std::uint8_t>& vOut, const std::uint8_t* pLiterals, std::size_t cLiterals, std::size_t offset, std::size_t cbMatch)
+	{
+		auto token_pos = vOut.size();
+		vOut.push_back(0);
+		auto token = std::uint8_t(std::min(cLiterals, std::size_t(15)) << 4);
+		if (cLiterals >= 15)
+			lz_write_length(vOut, cLiterals - 15);
+		vOut.insert(vOut.end(), pLiterals, pLiterals + cLiterals);
+		if (cbMatch != 0)
+		{
+			vOut.push_back(std::uint8_t(offset));
+			vOut.push_back(std::uint8_t(offset >> 8));
+			token |= std::uint8_t(std::min(cbMatch - LZ_MIN_MATCH, std::size_t(15)));
+			if (cbMatch - LZ_MIN_MATCH >= 15)
+				lz_write_length(vOut, cbMatch - LZ_MIN_MATCH - 15);
+		}
+		vOut[token_pos] = token;
+	}
+
+	//returns false, if the data does not compress
+	bool lz_compress(const std::uint8_t* pData, std::size_t cbData, std::vector<std::uint8_t>& vOut)
+	{
+		vOut.clear();
+		vOut.reserve(cbData);
+		std::size_t anchor = 0;
+		if (cbData > LZ_MATCH_LIMIT)
+		{
+			std::vector<std::uint32_t> vTable(std::size_t(1) << LZ_HASH_BITS); //positions of the last occurrences of the hashes
+			auto ip_limit = cbData - LZ_MATCH_LIMIT, match_limit = cbData - LZ_LAST_LITERALS;
+			std::size_t ip = 1;
+			while (ip < ip_limit)
+			{
+				auto seq = load<std::uint32_t>(pData + ip);
+				auto& slot = vTable[lz_hash(seq)];
+				std::size_t ref = slot;
+				slot = std::uint32_t(ip);
+				if (ip - ref > LZ_MAX_OFFSET || load<std::uint32_t>(pData + ref) != seq)
+				{
+					ip += 1 + ((ip - anchor) >> LZ_SKIP_TRIGGER);
+					continue;
+				}
+				auto cbMatch = LZ_MIN_MATCH;
+				while (ip + cbMatch + sizeof(std::uint64_t) <= match_limit && load<std::uint64_t>(pData + ref + cbMatch) == load<std::uint64_t>(pData + ip + cbMatch))
+					cbMatch += sizeof(std::uint64_t);
+				while (ip + cbMatch < match_limit && pData[ref + cbMatch] == pData[ip + cbMatch])
+					++cbMatch;
+				while (ip > anchor && ref > 0 && pData[ip - 1] == pData[ref - 1])
+				{
+					--ip;
+					--ref;
+					++cbMatch;
+				}
+				lz_write_sequence(vOut, pData + anchor, ip - anchor, ip - ref, cbMatch);
+				ip += cbMatch;
+				anchor = ip;
+				if (vOut.size() >= cbData)
+					return false;
+			}
+		}
+		lz_write_sequence(vOut, pData + anchor, cbData - anchor, 0, 0);
+		return vOut.size() < cbData;
+	}
+
+	//returns false, if the compressed data is invalid or does not decompress to exactly cbOut bytes
+	bool lz_decompress(const std::uint8_t* pData, std::size_t cbData, std::uint8_t* pOut, std::size_t cbOut)
+	{
+		auto pEnd = pData + cbData;
+		auto pCur = pOut, pOutEnd = pOut + cbOut;
+		auto read_length = [&pData, pEnd](std::size_t& cb) -> bool
+		{
+			std::uint8_t b;
+			do
+			{
+				if (pData == pEnd)
+					return false;
+				b = *pData++;
+				cb += b;
+			}while (b == 255);
+			return true;
+		};
+		while (pData != pEnd)
+		{
+			auto token = *pData++;
+			std::size_t cLiterals = token >> 4;
+			if (cLiterals == 15 && !read_length(cLiterals))
+				return false;
+			if (std::size_t(pEnd - pData) < cLiterals || std::size_t(pOutEnd - pCur) < cLiterals)
+				return false;
+			std::memcpy(pCur, pData, cLiterals);
+			pCur += cLiterals;
+			pData += cLiterals;
+			if (pData == pEnd)
+				return pCur == pOutEnd;
+			if (pEnd - pData < 2)
+				return false;
+			auto offset = std::size_t(pData[0]) | (std::size_t(pData[1]) << 8);
+			pData += 2;
+			std::size_t cbMatch = token & 0x0F;
+			if (cbMatch == 15 && !read_length(cbMatch))
+				return false;
+			cbMatch += LZ_MIN_MATCH;
+			if (offset == 0 || offset > std::size_t(pCur - pOut) || std::size_t(pOutEnd - pCur) < cbMatch)
+				return false;
+			auto pMatch = pCur - offset;
+			if (offset >= cbMatch)
+				std::memcpy(pCur, pMatch, cbMatch);
+			else
+			{
+				for (std::size_t i = 0; i < cbMatch; ++i)
+					pCur[i] = pMatch[i];
+			}
+			pCur += cbMatch;
+		}
+		return false;
+	}
+}
+
+compressed_ostream::compressed_ostream(binary_ostream& os)
+	:m_pOs(std::addressof(os)), m_base(os.tellp()), m_cMaxPending(std::max(std::thread::hardware_concurrency(), 1u))
+{
+	m_block.reserve(COMPRESSED_BLOCK_SIZE);
+	m_pOs->write(COMPRESSED_STREAM_MAGIC, sizeof(COMPRESSED_STREAM_MAGIC));
+	*m_pOs << COMPRESSED_STREAM_FORMAT_VERSION << std::uint32_t(COMPRESSED_BLOCK_SIZE);
+}
+
+compressed_ostream& compressed_ostream::write(const void* pInput, std::size_t cbHowMany)
+{
+	auto pData = static_cast<const std::uint8_t*>(pInput);
+	while (cbHowMany != 0)
+	{
+		std::size_t cbChunk;
+		if (m_pos < m_block_pos)
+		{
+			cbChunk = std::size_t(std::min(std::uint64_t(cbHowMany), m_block_pos - m_pos));
+			m_lstPatches.emplace_back(patch{m_pos, std::vector<std::uint8_t>(pData, pData + cbChunk)});
+		}else
+		{
+			auto offset = std::size_t(m_pos - m_block_pos);
+			if (offset == COMPRESSED_BLOCK_SIZE)
+			{
+				this->seal_block();
+				continue;
+			}
+			cbChunk = std::min(cbHowMany, COMPRESSED_BLOCK_SIZE - offset);
+			if (m_block.size() < offset + cbChunk)
+				m_block.resize(offset + cbChunk);
+			std::memcpy(m_block.data() + offset, pData, cbChunk);
+		}
+		m_pos += cbChunk;
+		pData += cbChunk;
+		cbHowMany -= cbChunk;
+	}
+	return *this;
+}
+
+compressed_ostream::pos_type compressed_ostream::tellp() const
+{
+	return pos_type(m_pos);
+}
+
+compressed_ostream& compressed_ostream::seekp(pos_type pos)
+{
+	if (pos > m_block_pos + m_block.size())
+		throw std::out_of_range("Seeking beyond the end of a compressed stream");
+	m_pos = pos;
+	return *this;
+}
+
+compressed_ostream& compressed_ostream::seekp(std::ptrdiff_t off, std::ios_base::seekdir dir)
+{
+	switch (dir)
+	{
+	case std::ios_base::beg:
+		return this->seekp(pos_type(off));
+	case std::ios_base::cur:
+		return this->seekp(pos_type(m_pos + off));
+	default:
+		return this->seekp(pos_type(m_block_pos + m_block.size() + off));
+	}
+}
+
+void compressed_ostream::seal_block()
+{
+	auto cbBlock = m_block.size();
+	m_lstPending.emplace_back(std::async(std::launch::async, [block = std::move(m_block)]() mutable -> compressed_block
+	{
+		compressed_block res;
+		if (lz_compress(block.data(), block.size(), res.data))
+			res.method = CompressionLz;
+		else
+		{
+			res.data = std::move(block);
+			res.method = CompressionStored;
+		}
+		return res;
+	}));
+	m_block_pos += cbBlock;
+	m_block = std::vector<std::uint8_t>();
+	m_block.reserve(COMPRESSED_BLOCK_SIZE);
+	if (m_lstPending.size() >= m_cMaxPending)
+		this->write_pending_block();
+}
+
+void compressed_ostream::write_pending_block()
+{
+	auto block = m_lstPending.front().get();
+	m_lstPending.pop_front();
+	m_vBlocks.emplace_back(block_entry{std::uint64_t(m_pOs->tellp() - m_base), std::uint32_t(block.data.size()), block.method});
+	m_pOs->write(block.data.data(), block.data.size());
+}
+
+void compressed_ostream::finish()
+{
+	if (m_fFinished)
+		return;
+	if (!m_block.empty())
+		this->seal_block();
+	while (!m_lstPending.empty())
+		this->write_pending_block();
+	auto block_table_pos = std::uint64_t(m_pOs->tellp() - m_base);
+	for (auto& block:m_vBlocks)
+		*m_pOs << block.pos << block.size << block.method;
+	auto patch_table_pos = std::uint64_t(m_pOs->tellp() - m_base);
+	for (auto& patch:m_lstPatches)
+	{
+		*m_pOs << patch.pos << std::uint32_t(patch.data.size());
+		m_pOs->write(patch.data.data(), patch.data.size());
+	}
+	*m_pOs << m_block_pos << block_table_pos << patch_table_pos << std::uint32_t(m_vBlocks.size()) << std::uint32_t(m_lstPatches.size()) << COMPRESSED_STREAM_FORMAT_VERSION;
+	m_pOs->write(COMPRESSED_STREAM_MAGIC, sizeof(COMPRESSED_STREAM_MAGIC));
+	m_fFinished = true;
+}
+
+compressed_file::compressed_file(const std::string& strPath):m_file(strPath), m_strPath(strPath)
+{
+	auto invalid = [&strPath]() -> void
+	{
+		throw std::runtime_error("Invalid compressed file \"" + strPath + "\".");
+	};
+	auto pFile = m_file.data();
+	auto cbFile = m_file.size();
+	if (cbFile < COMPRESSED_STREAM_HEADER_SIZE + COMPRESSED_STREAM_FOOTER_SIZE
+		|| std::memcmp(pFile, COMPRESSED_STREAM_MAGIC, sizeof(COMPRESSED_STREAM_MAGIC)) != 0
+		|| load<std::uint32_t>(pFile + sizeof(COMPRESSED_STREAM_MAGIC)) != COMPRESSED_STREAM_FORMAT_VERSION
+		|| std::memcmp(pFile + cbFile - sizeof(COMPRESSED_STREAM_MAGIC), COMPRESSED_STREAM_MAGIC, sizeof(COMPRESSED_STREAM_MAGIC)) != 0)
+		invalid();
+	m_cbBlock = load<std::uint32_t>(pFile + sizeof(COMPRESSED_STREAM_MAGIC) + sizeof(std::uint32_t));
+	auto footer_pos = std::uint64_t(cbFile - COMPRESSED_STREAM_FOOTER_SIZE);
+	auto pFooter = pFile + footer_pos;
+	m_cbData = load<std::uint64_t>(pFooter);
+	auto block_table_pos = load<std::uint64_t>(pFooter + sizeof(std::uint64_t));
+	auto patch_table_pos = load<std::uint64_t>(pFooter + 2 * sizeof(std::uint64_t));
+	auto cBlocks = load<std::uint32_t>(pFooter + 3 * sizeof(std::uint64_t));
+	auto cPatches = load<std::uint32_t>(pFooter + 3 * sizeof(std::uint64_t) + sizeof(std::uint32_t));
+	auto format_version = load<std::uint32_t>(pFooter + 3 * sizeof(std::uint64_t) + 2 * sizeof(std::uint32_t));
+	if (format_version != COMPRESSED_STREAM_FORMAT_VERSION || m_cbBlock == 0 || cBlocks != (m_cbData + m_cbBlock - 1) / m_cbBlock
+		|| block_table_pos < COMPRESSED_STREAM_HEADER_SIZE || patch_table_pos > footer_pos || patch_table_pos < block_table_pos
+		|| patch_table_pos - block_table_pos != std::uint64_t(cBlocks) * COMPRESSED_BLOCK_ENTRY_SIZE)
+		invalid();
+	m_vBlocks.reserve(cBlocks);
+	for (auto pEntry = pFile + block_table_pos; pEntry != pFile + patch_table_pos; pEntry += COMPRESSED_BLOCK_ENTRY_SIZE)
+	{
+		auto& block = m_vBlocks.emplace_back(block_entry{load<std::uint64_t>(pEntry), load<std::uint32_t>(pEntry + sizeof(std::uint64_t)),
+			load<std::uint32_t>(pEntry + sizeof(std::uint64_t) + sizeof(std::uint32_t))});
+		auto cbBlock = std::min(std::uint64_t(m_cbBlock), m_cbData - (m_vBlocks.size() - 1) * std::uint64_t(m_cbBlock));
+		if (block.pos < COMPRESSED_STREAM_HEADER_SIZE || block.pos > block_table_pos || block.size > block_table_pos - block.pos
+			|| (block.method != CompressionStored && block.method != CompressionLz) || (block.method == CompressionStored && block.size != cbBlock))
+			invalid();
+	}
+	auto pPatch = pFile + patch_table_pos;
+	for (std::uint32_t iPatch = 0; iPatch < cPatches; ++iPatch)
+	{
+		if (std::size_t(pFile + footer_pos - pPatch) < sizeof(std::uint64_t) + sizeof(std::uint32_t))
+			invalid();
+		auto& patch = m_vPatches.emplace_back(patch_entry{load<std::uint64_t>(pPatch), pPatch + sizeof(std::uint64_t) + sizeof(std::uint32_t),
+			load<std::uint32_t>(pPatch + sizeof(std::uint64_t))});
+		pPatch = patch.pData;
+		if (std::size_t(pFile + footer_pos - pPatch) < patch.size || patch.pos > m_cbData || patch.size > m_cbData - patch.pos)
+			invalid();
+		pPatch += patch.size;
+	}
+	if (pPatch != pFile + footer_pos)
+		invalid();
+}
+
+bool compressed_file::is_compressed_file(const std::string& strPath)
+{
+	std::ifstream is(strPath, std::ios_base::in | std::ios_base::binary);
+	char magic[sizeof(COMPRESSED_STREAM_MAGIC)];
+	return is.read(magic, sizeof(magic)) && std::memcmp(magic, COMPRESSED_STREAM_MAGIC, sizeof(magic)) == 0;
+}
+
+std::size_t compressed_file::read_block(std::size_t iBlock, void* pOut) const
+{
+	auto pBlockOut = static_cast<std::uint8_t*>(pOut);
+	auto block_pos = std::uint64_t(iBlock) * m_cbBlock;
+	auto cbBlock = std::size_t(std::min(std::uint64_t(m_cbBlock), m_cbData - block_pos));
+	auto& block = m_vBlocks[iBlock];
+	auto pData = m_file.data() + block.pos;
+	if (block.method == CompressionStored)
+		std::memcpy(pBlockOut, pData, cbBlock);
+	else if (!lz_decompress(pData, block.size, pBlockOut, cbBlock))
+		throw std::runtime_error("Invalid compressed file \"" + m_strPath + "\".");
+	for (auto& patch:m_vPatches)
+	{
+		auto patch_begin = std::max(patch.pos, block_pos), patch_end = std::min(patch.pos + patch.size, block_pos + cbBlock);
+		if (patch_begin < patch_end)
+			std::memcpy(pBlockOut + (patch_begin - block_pos), patch.pData + (patch_begin - patch.pos), std::size_t(patch_end - patch_begin));
+	}
+	return cbBlock;
+}
+
+std::vector<std::uint8_t> compressed_file::read_all() const
+{
+	auto vData = std::vector<std::uint8_t>(std::size_t(m_cbData));
+	std::atomic<std::size_t> iNext(0);
+	auto read_blocks = [this, &vData, &iNext]() -> void
+	{
+		for (auto iBlock = iNext++; iBlock < m_vBlocks.size(); iBlock = iNext++)
+			this->read_block(iBlock, vData.data() + iBlock * m_cbBlock);
+	};
+	std::list<std::future<void>> lstWorkers;
+	auto cThreads = std::min(std::size_t(std::max(std::thread::hardware_concurrency(), 1u)), m_vBlocks.size());
+	for (std::size_t iThread = 1; iThread < cThreads; ++iThread)
+		lstWorkers.emplace_back(std::async(std::launch::async, read_blocks));
+	read_blocks();
+	for (auto& worker:lstWorkers)
+		worker.get();
+	return vData;
+}
@@ -0,0 +1,111 @@
+#include <mapped_file.h>
+#include <stdexcept>
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+mapped_file::mapped_file(const std::string& strPath)
+{
+	auto hFile = CreateFileA(strPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Failed to map the file \"" + strPath + "\".");
+	LARGE_INTEGER cbFile;
+	if (!GetFileSizeEx(hFile, &cbFile))
+	{
+		CloseHandle(hFile);
+		throw std::runtime_error("Failed to map the file \"" + strPath + "\".");
+	}
+	if (cbFile.QuadPart != 0)
+	{
+		m_hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(hFile);
+		if (!m_hMapping)
+			throw std::runtime_error("Failed to map the file \"" + strPath + "\".");
+		m_pData = static_cast<const std::uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+		if (!m_pData)
+		{
+			CloseHandle(m_hMapping);
+			throw std::runtime_error("Failed to map the file \"" + strPath + "\".");
+		}
+		m_cbData = std::size_t(cbFile.QuadPart);
+	}else
+		CloseHandle(hFile);
+}
+
+void mapped_file::unmap() noexcept
+{
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+	if (m_hMapping)
+		CloseHandle(m_hMapping);
+	m_pData = nullptr;
+	m_cbData = 0;
+	m_hMapping = nullptr;
+}
+#else
+mapped_file::mapped_file(const std::string& strPath)
+{
+	auto fd = ::open(strPath.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error("Failed to map the file \"" + strPath + "\".");
+	struct stat st;
+	if (::fstat(fd, &st) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error("Failed to map the file \"" + strPath + "\".");
+	}
+	if (st.st_size != 0)
+	{
+		auto pData = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (pData == MAP_FAILED)
+		{
+			::close(fd);
+			throw std::runtime_error("Failed to map the file \"" + strPath + "\".");
+		}
+		m_pData = static_cast<const std::uint8_t*>(pData);
+		m_cbData = std::size_t(st.st_size);
+	}
+	::close(fd); //the mapping remains valid
+}
+
+void mapped_file::unmap() noexcept
+{
+	if (m_pData)
+		::munmap(const_cast<std::uint8_t*>(m_pData), m_cbData);
+	m_pData = nullptr;
+	m_cbData = 0;
+}
+#endif //_WIN32
+
+mapped_file::mapped_file(mapped_file&& right) noexcept
+{
+	*this = std::move(right);
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& right) noexcept
+{
+	if (this != &right)
+	{
+		this->unmap();
+		std::swap(m_pData, right.m_pData);
+		std::swap(m_cbData, right.m_cbData);
+#ifdef _WIN32
+		std::swap(m_hMapping, right.m_hMapping);
+#endif
+	}
+	return *this;
+}
+
+mapped_file::~mapped_file()
+{
+	this->unmap();
+}
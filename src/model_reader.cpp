@@ -0,0 +1,245 @@
+#include <model_reader.h>
+#include <model_index.h>
+#include <compressed_streams.h>
+#include <stdexcept>
+#include <algorithm>
+
+//name, domain data, type id and the number of faces (or the position) of an object take at least that much
+static constexpr std::size_t MODEL_MIN_OBJECT_SIZE = 4 * sizeof(std::uint32_t);
+
+namespace
+{
+	//validates the model while walking through it
+	class model_cursor
+	{
+		const std::uint8_t* m_pCur;
+		const std::uint8_t* m_pEnd;
+		const std::string* m_pPath;
+	public:
+		model_cursor(const std::uint8_t* pBegin, const std::uint8_t* pEnd, const std::string& strPath):m_pCur(pBegin), m_pEnd(pEnd), m_pPath(&strPath) {}
+		inline const std::uint8_t* position() const noexcept
+		{
+			return m_pCur;
+		}
+		[[noreturn]] void invalid() const
+		{
+			throw std::runtime_error("Invalid binary model \"" + *m_pPath + "\".");
+		}
+		const std::uint8_t* skip(std::size_t cb)
+		{
+			if (std::size_t(m_pEnd - m_pCur) < cb)
+				this->invalid();
+			auto pData = m_pCur;
+			m_pCur += cb;
+			return pData;
+		}
+		//checks that cItems items of cbItem bytes each fit into the rest of the model, before walking through them
+		const std::uint8_t* skip(std::size_t cItems, std::size_t cbItem)
+		{
+			if (cItems != 0 && std::size_t(m_pEnd - m_pCur) / cItems < cbItem)
+				this->invalid();
+			return this->skip(cItems * cbItem);
+		}
+		template <class T>
+		T read()
+		{
+			return Implementation::read_model_value<T>(this->skip(sizeof(T)));
+		}
+		std::string_view read_string()
+		{
+			auto cb = this->read<std::uint32_t>();
+			return std::string_view(reinterpret_cast<const char*>(this->skip(cb)), cb);
+		}
+		point_t read_point()
+		{
+			auto pPoint = this->skip(MODEL_POINT_SIZE);
+			if (Implementation::read_model_value<std::uint32_t>(pPoint) != 3)
+				this->invalid();
+			return model_points_view(pPoint, 1)[0];
+		}
+		void skip_points(std::size_t cPoints)
+		{
+			this->skip(cPoints, MODEL_POINT_SIZE);
+			for (auto pPoint = m_pCur - cPoints * MODEL_POINT_SIZE; pPoint != m_pCur; pPoint += MODEL_POINT_SIZE)
+			{
+				if (Implementation::read_model_value<std::uint32_t>(pPoint) != 3)
+					this->invalid();
+			}
+		}
+		const std::uint8_t* skip_domain_data()
+		{
+			auto pData = m_pCur;
+			auto cEntries = this->read<std::uint32_t>();
+			for (std::uint32_t iEntry = 0; iEntry < cEntries; ++iEntry)
+			{
+				this->read_string();
+				this->skip(this->read<std::uint32_t>());
+			}
+			return pData;
+		}
+		//faces of indexed poly objects reference cVertices vertices of the object
+		void skip_faces(bool fIndexed, std::size_t cVertices)
+		{
+			auto cFaces = this->read<std::uint32_t>();
+			for (std::uint32_t iFace = 0; iFace < cFaces; ++iFace)
+			{
+				auto cFaceVertices = this->read<std::uint32_t>();
+				if (!fIndexed)
+					this->skip_points(cFaceVertices);
+				else
+				{
+					auto pIndices = this->skip(cFaceVertices, sizeof(std::uint32_t));
+					for (std::uint32_t iVertex = 0; iVertex < cFaceVertices; ++iVertex)
+					{
+						if (Implementation::read_model_value<std::uint32_t>(pIndices + iVertex * sizeof(std::uint32_t)) >= cVertices)
+							this->invalid();
+					}
+				}
+				this->skip_domain_data();
+			}
+		}
+	};
+}
+
+namespace Implementation
+{
+	const std::uint8_t* skip_model_domain_data(const std::uint8_t* pData) noexcept
+	{
+		auto cEntries = read_model_value<std::uint32_t>(pData);
+		pData += sizeof(std::uint32_t);
+		for (std::uint32_t iEntry = 0; iEntry < cEntries; ++iEntry)
+		{
+			pData += sizeof(std::uint32_t) + read_model_value<std::uint32_t>(pData);
+			pData += sizeof(std::uint32_t) + read_model_value<std::uint32_t>(pData);
+		}
+		return pData;
+	}
+}
+
+static MODEL_OBJECT_ENTRY read_model_object(model_cursor& cursor)
+{
+	MODEL_OBJECT_ENTRY entry;
+	entry.pBegin = cursor.position();
+	entry.name = cursor.read_string();
+	entry.pDomainData = cursor.skip_domain_data();
+	auto type = cursor.read<std::uint32_t>();
+	entry.pBody = cursor.position();
+	switch (type)
+	{
+	case ObjectPoly:
+		cursor.skip_faces(false, 0);
+		break;
+	case ObjectIndexedPoly:
+	{
+		auto cVertices = cursor.read<std::uint32_t>();
+		cursor.skip_points(cVertices);
+		cursor.skip_faces(true, cVertices);
+		break;
+	}
+	case ObjectSource:
+	case ObjectPlain:
+		cursor.read_point();
+		if (cursor.read<std::uint32_t>() != 2)
+			cursor.invalid();
+		cursor.skip_points(2);
+		break;
+	default:
+		cursor.invalid();
+	}
+	entry.type = ObjectTypeId(type);
+	entry.pEnd = cursor.position();
+	return entry;
+}
+
+model_reader::model_reader(const std::string& strPath)
+{
+	if (compressed_file::is_compressed_file(strPath))
+	{
+		m_vDecompressed = compressed_file(strPath).read_all();
+		m_pModel = m_vDecompressed.data();
+		m_cbModel = m_vDecompressed.size();
+	}else
+	{
+		m_file = mapped_file(strPath);
+		m_pModel = m_file.data();
+		m_cbModel = m_file.size();
+	}
+	model_cursor cursor(m_pModel, m_pModel + m_cbModel, strPath);
+	m_strName = cursor.read_string();
+	m_units = Units(cursor.read<std::uint32_t>());
+	m_size = cursor.read_point();
+	m_pDomainData = cursor.skip_domain_data();
+	auto cObjects = cursor.read<std::uint32_t>();
+	if (this->read_object_index(cursor.position(), cObjects, strPath))
+		return;
+	m_vObjects.reserve(std::min(std::size_t(cObjects), m_cbModel / MODEL_MIN_OBJECT_SIZE));
+	for (std::uint32_t iObject = 0; iObject < cObjects; ++iObject)
+	{
+		auto entry = read_model_object(cursor);
+		if (!entry.name.empty())
+			m_mapNamed.emplace(entry.name, m_vObjects.size());
+		m_vObjects.emplace_back(entry);
+	}
+}
+
+bool model_reader::read_object_index(const std::uint8_t* pObjects, std::size_t cObjects, const std::string& strPath)
+{
+	using Implementation::read_model_value;
+	auto pModel = m_pModel;
+	auto objects_pos = std::uint64_t(pObjects - pModel);
+	if (m_cbModel - objects_pos < MODEL_INDEX_FOOTER_SIZE)
+		return false;
+	auto footer_pos = std::uint64_t(m_cbModel - MODEL_INDEX_FOOTER_SIZE);
+	auto pFooter = pModel + footer_pos;
+	if (std::memcmp(pFooter + MODEL_INDEX_FOOTER_SIZE - sizeof(MODEL_INDEX_MAGIC), MODEL_INDEX_MAGIC, sizeof(MODEL_INDEX_MAGIC)) != 0)
+		return false;
+	auto index_pos = read_model_value<std::uint64_t>(pFooter);
+	auto cIndexed = read_model_value<std::uint32_t>(pFooter + sizeof(std::uint64_t));
+	auto cBuckets = read_model_value<std::uint32_t>(pFooter + sizeof(std::uint64_t) + sizeof(std::uint32_t));
+	auto format_version = read_model_value<std::uint32_t>(pFooter + sizeof(std::uint64_t) + 2 * sizeof(std::uint32_t));
+	//the last bytes of a model without the index may look like the magic by chance, hence the model is walked through unless the
+	//footer is consistent
+	if (format_version != MODEL_INDEX_FORMAT_VERSION || cIndexed != cObjects || cBuckets == 0 || (cBuckets & (cBuckets - 1)) != 0 
+		|| index_pos < objects_pos || index_pos > footer_pos 
+		|| footer_pos - index_pos != std::uint64_t(cIndexed) * MODEL_INDEX_ENTRY_SIZE + std::uint64_t(cBuckets) * MODEL_INDEX_BUCKET_SIZE)
+		return false;
+	auto pEntry = pModel + index_pos;
+	m_vObjects.reserve(cObjects);
+	for (std::size_t iObject = 0; iObject < cObjects; ++iObject, pEntry += MODEL_INDEX_ENTRY_SIZE)
+	{
+		auto offset = read_model_value<std::uint64_t>(pEntry);
+		auto size = read_model_value<std::uint64_t>(pEntry + sizeof(std::uint64_t));
+		if (offset < objects_pos || offset > index_pos || size > index_pos - offset)
+			throw std::runtime_error("Invalid binary model \"" + strPath + "\".");
+		model_cursor cursor(pModel + offset, pModel + offset + size, strPath);
+		m_vObjects.emplace_back(read_model_object(cursor));
+		if (cursor.position() != pModel + offset + size)
+			cursor.invalid();
+	}
+	m_pNameBuckets = pEntry;
+	m_cNameBuckets = cBuckets;
+	return true;
+}
+
+std::optional<model_object_view> model_reader::find(std::string_view strName) const
+{
+	if (m_pNameBuckets == nullptr)
+	{
+		auto it = m_mapNamed.find(strName);
+		if (it == m_mapNamed.end())
+			return std::nullopt;
+		return model_object_view(m_vObjects[it->second]);
+	}
+	if (strName.empty())
+		return std::nullopt;
+	auto iBucket = std::size_t(model_index_name_hash(strName) & (m_cNameBuckets - 1));
+	for (std::size_t cProbes = 0; cProbes < m_cNameBuckets; ++cProbes, iBucket = (iBucket + 1) & (m_cNameBuckets - 1))
+	{
+		auto iObject = Implementation::read_model_value<std::uint32_t>(m_pNameBuckets + iBucket * MODEL_INDEX_BUCKET_SIZE);
+		if (iObject == 0)
+			break;
+		if (iObject <= m_vObjects.size() && m_vObjects[iObject - 1].name == strName)
+			return model_object_view(m_vObjects[iObject - 1]);
+	}
+	return std::nullopt;
+}
@@ -1,102 +1,255 @@
-#ifdef _MSC_VER
-#define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
-#endif
-
 #include <text_streams.h>
-#include <cwchar>
 #include <cassert>
 #include <stdexcept>
 #include <cstring>
-#include <codecvt>
 #include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <array>
+#include <utility>
+
+const std::string text_istream::m_strUnknownResourceId = std::string();
 
-template <class Facet = std::codecvt<wchar_t, char, std::mbstate_t>>
-struct codecvt:Facet
+const std::string& text_istream::get_resource_id() const
 {
-	using Facet::Facet;
-	~codecvt() {}
-};
+	return m_strUnknownResourceId;
+}
 
-typedef codecvt<std::codecvt_byname<wchar_t, char, std::mbstate_t>> codecvt_byname;
+typedef text_istream::streambuf::decode_result decode_result;
 
-const std::wstring text_istream::m_strUnknownResourceId = std::wstring(L"");
+//number of bytes of the UTF-8 sequence by its lead byte, zero for the bytes which cannot start a sequence (continuation bytes and
+//the lead bytes of the overlong two-byte sequences and of the code points beyond U+10FFFF)
+static constexpr unsigned char UTF8_SEQUENCE_SIZE[256] = {
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+//the least code point encoded by the sequence of the size, the longer sequences are overlong
+static constexpr char32_t UTF8_MIN_CODE_POINT[5] = {0, 0, 0x80, 0x800, 0x10000};
 
-const std::wstring& text_istream::get_resource_id() const
+//numbers of the source bytes of a character by the first byte of its UTF-8 sequence, zero for the continuation bytes
+template <unsigned char cbBmp, unsigned char cbSupplementary>
+static constexpr std::array<unsigned char, 256> make_source_sizes()
 {
-	return m_strUnknownResourceId;
+	std::array<unsigned char, 256> sizes = {};
+	for (std::size_t i = 0; i < sizes.size(); ++i)
+		sizes[i] = (i & 0xC0) == 0x80?0:i >= 0xF0?cbSupplementary:cbBmp;
+	return sizes;
 }
+static constexpr auto SINGLE_BYTE_SOURCE_SIZES = make_source_sizes<1, 1>();
+static constexpr auto UTF16_SOURCE_SIZES = make_source_sizes<2, 4>();
+
+//Windows-1251 characters 0x80 to 0xFF, the undefined 0x98 is mapped to U+0098 as Windows does
+static constexpr char16_t WINDOWS_1251_HIGH_HALF[128] = {
+	0x0402, 0x0403, 0x201A, 0x0453, 0x201E, 0x2026, 0x2020, 0x2021, 0x20AC, 0x2030, 0x0409, 0x2039, 0x040A, 0x040C, 0x040B, 0x040F,
+	0x0452, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x0098, 0x2122, 0x0459, 0x203A, 0x045A, 0x045C, 0x045B, 0x045F,
+	0x00A0, 0x040E, 0x045E, 0x0408, 0x00A4, 0x0490, 0x00A6, 0x00A7, 0x0401, 0x00A9, 0x0404, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x0407,
+	0x00B0, 0x00B1, 0x0406, 0x0456, 0x0491, 0x00B5, 0x00B6, 0x00B7, 0x0451, 0x2116, 0x0454, 0x00BB, 0x0458, 0x0405, 0x0455, 0x0457,
+	0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416, 0x0417, 0x0418, 0x0419, 0x041A, 0x041B, 0x041C, 0x041D, 0x041E, 0x041F,
+	0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426, 0x0427, 0x0428, 0x0429, 0x042A, 0x042B, 0x042C, 0x042D, 0x042E, 0x042F,
+	0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437, 0x0438, 0x0439, 0x043A, 0x043B, 0x043C, 0x043D, 0x043E, 0x043F,
+	0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447, 0x0448, 0x0449, 0x044A, 0x044B, 0x044C, 0x044D, 0x044E, 0x044F
+};
 
-text_istream::int_type text_istream::streambuf::readone()
+//Skips the ASCII bytes eight at a time up to the first non-ASCII byte. The ASCII bytes are copied to the output, if there is one.
+//The 64-bit test of the high bits and the fixed-size copy are vectorized by the compilers.
+static inline void skip_ascii(const unsigned char*& pIn, const unsigned char* pInEnd, char*& pOut)
 {
-	const auto& conv = std::use_facet<std::codecvt<wchar_t, char, std::mbstate_t>>(this->getloc());
-	wchar_t result;
-	const char* from_end;
-	wchar_t* to_end;
+	constexpr std::uint64_t HIGH_BITS = 0x8080808080808080u;
+	while (pInEnd - pIn >= 8)
+	{
+		std::uint64_t word;
+		std::memcpy(&word, pIn, sizeof(word));
+		if ((word & HIGH_BITS) != 0)
+			break;
+		if (pOut != nullptr)
+		{
+			std::memcpy(pOut, pIn, sizeof(word));
+			pOut += 8;
+		}
+		pIn += 8;
+	}
+	for (; pIn != pInEnd && *pIn < 0x80; ++pIn)
+	{
+		if (pOut != nullptr)
+			*pOut++ = char(*pIn);
+	}
+}
 
-	auto cbTail = std::size_t(m_mb_buf_len - m_mb_buf_off);
-	if (cbTail == 0)
+static inline char* put_utf8(char* pOut, char32_t cp)
+{
+	if (cp < 0x80)
+		*pOut++ = char(cp);
+	else if (cp < 0x800)
 	{
-		if (m_mb_buf_len < sizeof(m_mb_buf))
-			return traits_type::eof();
-		m_mb_buf_off = std::size_t();
+		*pOut++ = char(0xC0 | (cp >> 6));
+		*pOut++ = char(0x80 | (cp & 0x3F));
+	}else if (cp < 0x10000)
+	{
+		*pOut++ = char(0xE0 | (cp >> 12));
+		*pOut++ = char(0x80 | ((cp >> 6) & 0x3F));
+		*pOut++ = char(0x80 | (cp & 0x3F));
 	}else
 	{
-		auto state_old = m_conv_state;
-		auto status = conv.in(m_conv_state, &m_mb_buf[m_mb_buf_off], &m_mb_buf[m_mb_buf_len], from_end, &result, &result + 1, to_end);
-		switch (status)
-		{
-		case std::codecvt_base::partial:
-		if (std::size_t(from_end - &m_mb_buf[0]) == m_mb_buf_off)
-		{
-			assert(m_mb_buf_off > 0);
-			std::memmove(&m_mb_buf[0], &m_mb_buf[m_mb_buf_off], m_mb_buf_len - m_mb_buf_off);
-			m_mb_buf_off = m_mb_buf_len - m_mb_buf_off;
-			m_conv_state = state_old;
+		*pOut++ = char(0xF0 | (cp >> 18));
+		*pOut++ = char(0x80 | ((cp >> 12) & 0x3F));
+		*pOut++ = char(0x80 | ((cp >> 6) & 0x3F));
+		*pOut++ = char(0x80 | (cp & 0x3F));
+	}
+	return pOut;
+}
+
+static inline bool is_surrogate(char32_t cp)
+{
+	return cp >= 0xD800 && cp <= 0xDFFF;
+}
+
+//validates UTF-8 bytes in place, pOut of the result is not set
+static decode_result validate_utf8(const unsigned char* pIn, const unsigned char* pInEnd)
+{
+	char* pNoOutput = nullptr;
+	while (true)
+	{
+		skip_ascii(pIn, pInEnd, pNoOutput);
+		if (pIn == pInEnd)
+			break;
+		auto cb = std::size_t(UTF8_SEQUENCE_SIZE[*pIn]);
+		if (cb == 0)
+			return decode_result{pIn, nullptr, true};
+		if (std::size_t(pInEnd - pIn) < cb)
 			break;
+		auto cp = char32_t(*pIn & (0x7F >> cb));
+		for (std::size_t i = 1; i < cb; ++i)
+		{
+			if ((pIn[i] & 0xC0) != 0x80)
+				return decode_result{pIn, nullptr, true};
+			cp = (cp << 6) | char32_t(pIn[i] & 0x3F);
 		}
-		case std::codecvt_base::ok:
-			m_mb_buf_off = from_end - &m_mb_buf[0];
-			m_chLast = result;
-			return traits_type::to_int_type(result);
-		case std::codecvt_base::error:
-		case std::codecvt_base::noconv:
-			return traits_type::eof();
-		default:
-			throw std::logic_error("Unexpected return value of codecvt::in");
+		if (cp < UTF8_MIN_CODE_POINT[cb] || cp > 0x10FFFF || is_surrogate(cp))
+			return decode_result{pIn, nullptr, true};
+		pIn += cb;
+	}
+	return decode_result{pIn, nullptr, false};
+}
+
+template <bool fBigEndian>
+static decode_result transcode_utf16(const unsigned char* pIn, const unsigned char* pInEnd, char* pOut)
+{
+	auto unit = [](const unsigned char* p) -> char32_t {return fBigEndian?char32_t(p[0] << 8 | p[1]):char32_t(p[1] << 8 | p[0]);};
+	while (pInEnd - pIn >= 2)
+	{
+		auto cp = unit(pIn);
+		if (!is_surrogate(cp))
+		{
+			pOut = put_utf8(pOut, cp);
+			pIn += 2;
+			continue;
 		}
+		if (cp >= 0xDC00)
+			return decode_result{pIn, pOut, true};
+		if (pInEnd - pIn < 4)
+			break;
+		auto low = unit(pIn + 2);
+		if (low < 0xDC00 || low > 0xDFFF)
+			return decode_result{pIn, pOut, true};
+		pOut = put_utf8(pOut, 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00));
+		pIn += 4;
 	}
-	m_mb_buf_len = m_mb_buf_off + m_pBufImpl->sgetn(&m_mb_buf[m_mb_buf_off], std::streamsize(sizeof(m_mb_buf) - m_mb_buf_off));
-	auto status = conv.in(m_conv_state, &m_mb_buf[0], &m_mb_buf[m_mb_buf_len], from_end, &result, &result + 1, to_end);
-	switch (status)
+	return decode_result{pIn, pOut, false};
+}
+
+static decode_result transcode_windows_1251(const unsigned char* pIn, const unsigned char* pInEnd, char* pOut)
+{
+	while (true)
 	{
-	case std::codecvt_base::partial:
-		if (from_end == &m_mb_buf[0])
-			return traits_type::eof();
-	case std::codecvt_base::ok:
-		m_mb_buf_off = from_end - &m_mb_buf[0];
-		m_chLast = result;
-		return traits_type::to_int_type(result);
-	case std::codecvt_base::error:
-	case std::codecvt_base::noconv:
-		return traits_type::eof();
-	default:
-		throw std::logic_error("Unexpected return value of codecvt::in");
+		skip_ascii(pIn, pInEnd, pOut);
+		if (pIn == pInEnd)
+			break;
+		pOut = put_utf8(pOut, WINDOWS_1251_HIGH_HALF[*pIn++ - 0x80]);
+	}
+	return decode_result{pIn, pOut, false};
+}
+
+//the bytes are the code points, i.e. ISO-8859-1
+static decode_result transcode_ansi(const unsigned char* pIn, const unsigned char* pInEnd, char* pOut)
+{
+	while (true)
+	{
+		skip_ascii(pIn, pInEnd, pOut);
+		if (pIn == pInEnd)
+			break;
+		pOut = put_utf8(pOut, *pIn++);
+	}
+	return decode_result{pIn, pOut, false};
+}
+
+text_istream::off_type text_istream::streambuf::source_bytes_before(const char* pByte)
+{
+	const char* pBlock = this->block_begin();
+	if (m_pTranscoder == nullptr)
+		return off_type(pByte - pBlock);
+	if (pByte < pBlock)
+	{
+		std::size_t cb = 0;
+		for (; pByte < pBlock; ++pByte)
+			cb += m_pSourceSizes[static_cast<unsigned char>(*pByte)];
+		return -off_type(cb);
+	}
+	if (pByte < m_pMeasured)
+	{
+		m_pMeasured = pBlock;
+		m_cbMeasured = 0;
+	}
+	for (; m_pMeasured < pByte; ++m_pMeasured)
+		m_cbMeasured += m_pSourceSizes[static_cast<unsigned char>(*m_pMeasured)];
+	return off_type(m_cbMeasured);
+}
+
+void text_istream::streambuf::reset_block()
+{
+	m_cbBytes = 0;
+	m_cbDecoded = 0;
+	m_fInvalid = false;
+	m_locator = locator{0u, 1u};
+	auto pBlock = this->block_begin();
+	this->setg(pBlock, pBlock, pBlock);
+	m_pMeasured = pBlock;
+	m_cbMeasured = 0;
+	m_pLocated = pBlock;
+}
+
+void text_istream::streambuf::sync_locator() const noexcept
+{
+	const char* pEnd = this->gptr();
+	for (; m_pLocated < pEnd; ++m_pLocated)
+	{
+		if (*m_pLocated == '\n')
+		{
+			m_locator.col = 0u;
+			++m_locator.row;
+		}else if ((*m_pLocated & 0xC0) != 0x80)
+			++m_locator.col;
 	}
 }
 
 text_istream::pos_type text_istream::streambuf::seekoff(text_istream::off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
 {
-	if (off != 0)
+	if (off != 0 || m_pBufImpl == nullptr)
 		return pos_type(off_type(-1));
 	if (dir == std::ios_base::cur)
-		return off_type(impl_off_type(m_pBufImpl->pubseekoff(0, std::ios_base::cur, which))) - off_type(m_mb_buf_len - m_mb_buf_off);
-	m_mb_buf_off = sizeof(m_mb_buf);
-	m_mb_buf_len = sizeof(m_mb_buf);
-	m_conv_state = std::mbstate_t();
-	m_chLast = char_type();
-	m_locator = locator{0u, 1u};
-	m_prev_col = 0u;
-	this->setg(&m_chLast, &m_chLast + 1, &m_chLast + 1);
+	{
+		auto pos = off_type(impl_off_type(m_pBufImpl->pubseekoff(0, std::ios_base::cur, which)));
+		if (pos < 0)
+			return pos_type(off_type(-1));
+		return pos - off_type(m_cbBytes) + this->source_bytes_before(this->gptr());
+	}
+	this->reset_block();
 	return pos_type(off_type(impl_off_type(m_pBufImpl->pubseekoff(0, dir, which))));
 }
 
@@ -105,157 +258,232 @@ text_istream::pos_type text_istream::streambuf::seekpos(text_istream::pos_type p
 	return pos == pos_type()?this->seekoff(off_type(), std::ios_base::beg, which):pos_type(off_type(-1));
 }
 
+//Decodes the next block. The last bytes of the previous block are kept before it for putback and the incomplete sequence at its end
+//is moved to the beginning of the bytes.
 text_istream::streambuf::int_type text_istream::streambuf::underflow()
 {
-	auto ch = readone();
-	if (ch == traits_type::to_int_type(L'\n'))
+	if (this->gptr() < this->egptr())
+		return traits_type::to_int_type(*this->gptr());
+	if (m_pBufImpl == nullptr || m_fInvalid)
+		return traits_type::eof();
+	this->sync_locator();
+	auto pBlock = this->block_begin();
+	auto cPutback = std::min(std::size_t(this->egptr() - this->eback()), PUTBACK_SIZE);
+	std::memmove(pBlock - cPutback, this->egptr() - cPutback, cPutback);
+	auto pBytes = this->bytes_begin();
+	m_cbBytes -= m_cbDecoded;
+	std::memmove(pBytes, pBytes + m_cbDecoded, m_cbBytes);
+	m_cbDecoded = 0;
+	auto pEnd = pBlock;
+	while (true)
 	{
-		m_prev_col = m_locator.col;
-		m_locator.col = 0u;
-		++m_locator.row;
-	}else
-		++m_locator.col;
-	this->setg(&m_chLast, &m_chLast, &m_chLast + 1);
-	return ch;
+		auto cbRead = std::size_t(m_pBufImpl->sgetn(reinterpret_cast<impl_char_type*>(pBytes + m_cbBytes), std::streamsize(BLOCK_SIZE - m_cbBytes)));
+		m_cbBytes += cbRead;
+		decode_result res;
+		if (m_pTranscoder == nullptr)
+		{
+			res = validate_utf8(pBytes, pBytes + m_cbBytes);
+			res.pOut = pBlock + (res.pIn - pBytes);
+		}else
+			res = m_pTranscoder(pBytes, pBytes + m_cbBytes, pBlock);
+		m_cbDecoded = std::size_t(res.pIn - pBytes);
+		m_fInvalid = res.fInvalid;
+		pEnd = res.pOut;
+		if (pEnd != pBlock || m_fInvalid || cbRead == 0)
+			break;
+	}
+	this->setg(pBlock - cPutback, pBlock, pEnd);
+	m_pMeasured = pBlock;
+	m_cbMeasured = 0;
+	m_pLocated = pBlock;
+	if (pEnd == pBlock)
+		return traits_type::eof();
+	return traits_type::to_int_type(*pBlock);
 }
 
-text_istream::streambuf::streambuf(std::streambuf* pBuf, TextEncoding encoding):m_pBufImpl(pBuf)
+text_istream::streambuf::streambuf(std::streambuf* pBuf, TextEncoding encoding)
+	:m_vBytes(PUTBACK_SIZE + BLOCK_SIZE), m_pBufImpl(pBuf)
 {
-	this->setg(&m_chLast, &m_chLast + 1, &m_chLast + 1);
 	this->set_encoding(encoding);
+	this->reset_block();
 }
 
+//The encodings without a locale of their own: Default is UTF-8 and ANSI is ISO-8859-1, so that a text is decoded the same way on every
+//host.
 void text_istream::streambuf::set_encoding(TextEncoding encoding)
 {
+	transcoder pTranscoder;
+	const unsigned char* pSourceSizes;
 	switch (encoding)
 	{
+	case TextEncoding::Default:
 	case TextEncoding::UTF8:
-#ifndef _WIN32
-		this->pubimbue(std::locale(this->getloc(), "en_US.UTF-8", std::locale::ctype));
-#else
-		this->pubimbue(std::locale(this->getloc(), new std::codecvt_utf8<wchar_t>()));
-#endif
+		pTranscoder = nullptr;
+		pSourceSizes = nullptr;
 		break;
 	case TextEncoding::UTF16LE:
-		this->pubimbue(std::locale(this->getloc(), new std::codecvt_utf16<wchar_t, 0x10ffff, std::codecvt_mode::little_endian>()));
+		pTranscoder = &transcode_utf16<false>;
+		pSourceSizes = UTF16_SOURCE_SIZES.data();
 		break;
 	case TextEncoding::UTF16BE:
-		this->pubimbue(std::locale(this->getloc(), new std::codecvt_utf16<wchar_t, 0x10ffff, std::codecvt_mode(0)>()));
-		break;
-	case TextEncoding::Default:
-		this->pubimbue(std::locale(this->getloc(), "", std::locale::ctype));
+		pTranscoder = &transcode_utf16<true>;
+		pSourceSizes = UTF16_SOURCE_SIZES.data();
 		break;
 	case TextEncoding::ANSI:
-		this->pubimbue(std::locale(this->getloc(), std::locale::classic(), std::locale::ctype));
+		pTranscoder = &transcode_ansi;
+		pSourceSizes = SINGLE_BYTE_SOURCE_SIZES.data();
 		break;
 	case TextEncoding::Windows_1251:
-		this->pubimbue(std::locale(this->getloc(), ".1251", std::locale::ctype));
+		pTranscoder = &transcode_windows_1251;
+		pSourceSizes = SINGLE_BYTE_SOURCE_SIZES.data();
 		break;
+	default:
+		throw std::invalid_argument("Unknown text encoding");
+	}
+	if (pTranscoder != nullptr && m_vTranscoded.empty())
+		m_vTranscoded.resize(PUTBACK_SIZE + BLOCK_SIZE * TRANSCODED_SIZE_MAX);
+	auto fStarted = this->gptr() != nullptr;
+	std::size_t cbExtracted = 0;
+	if (fStarted)
+	{
+		//the bytes not extracted yet are decoded anew by the next underflow, the bytes extracted cannot be put back
+		this->sync_locator();
+		if (this->gptr() >= this->block_begin())
+			cbExtracted = std::size_t(this->source_bytes_before(this->gptr()));
+	}
+	m_pTranscoder = pTranscoder;
+	m_pSourceSizes = pSourceSizes;
+	m_encoding = encoding;
+	if (fStarted)
+	{
+		auto pBytes = this->bytes_begin();
+		m_cbBytes -= cbExtracted;
+		std::memmove(pBytes, pBytes + cbExtracted, m_cbBytes);
+		m_cbDecoded = 0;
+		m_fInvalid = false;
+		auto pBlock = this->block_begin();
+		this->setg(pBlock, pBlock, pBlock);
+		m_pMeasured = pBlock;
+		m_cbMeasured = 0;
+		m_pLocated = pBlock;
 	}
 }
 
-text_istream::text_istream(std::istream& is, use_bom_t):std::wistream(nullptr), m_buf(is.rdbuf())
+text_istream::text_istream(std::istream& is, std::optional<TextEncoding> encoding)
+	:std::istream(nullptr), m_buf(is.rdbuf(), encoding.value_or(TextEncoding::UTF8))
 {
-	if (is.fail())
+	this->rdbuf(&m_buf);
+	if (is.fail() || !encoding)
+		this->setfail();
+}
+
+static bool equal_encoding_names(std::string_view strLeft, std::string_view strRight)
+{
+	return std::equal(strLeft.begin(), strLeft.end(), strRight.begin(), strRight.end(), 
+		[](char chl, char chr) -> bool {return std::toupper(static_cast<unsigned char>(chl)) == std::toupper(static_cast<unsigned char>(chr));});
+}
+
+//the encodings which can be declared by an XML file
+static constexpr std::pair<TextEncoding, std::string_view> XML_ENCODING_NAMES[] =
+{
+	{TextEncoding::UTF8, "UTF-8"},
+	{TextEncoding::UTF16LE, "UTF-16LE"},
+	{TextEncoding::UTF16BE, "UTF-16BE"},
+	{TextEncoding::Windows_1251, "windows-1251"}
+};
+
+std::optional<TextEncoding> xml_encoding_by_name(std::string_view strName)
+{
+	for (const auto& prEncoding:XML_ENCODING_NAMES)
 	{
-		this->setstate(std::ios_base::failbit);
-		return;
+		if (equal_encoding_names(strName, prEncoding.second))
+			return prEncoding.first;
 	}
-	auto pos_old = is.tellg();
-	is.seekg(0, std::ios_base::end);
-	auto cb = std::size_t(std::istream::off_type(is.tellg()));
-	is.seekg(pos_old);
-	if (cb > 0)
+	return std::optional<TextEncoding>();
+}
+
+std::string_view xml_encoding_name(TextEncoding encoding)
+{
+	if (encoding == TextEncoding::Default)
+		encoding = TextEncoding::UTF8;
+	for (const auto& prEncoding:XML_ENCODING_NAMES)
 	{
-		char ch0 = is.get();
-		switch (ch0)
-		{
-		case '\xff':
-			if (cb == 1)
-				this->setfail();
-			else
-			{
-				char ch1 = is.get();
-				switch (ch1)
-				{
-				case '\xfe':
-					if (cb == 2)
-						m_buf.set_encoding(TextEncoding::UTF16LE);
-					else
-					{
-						char ch2 = is.get();
-						switch (ch2)
-						{
-						case 0: //UTF-32LE
-							this->setfail();
-							break;
-						default:
-							is.putback(ch2);
-							m_buf.set_encoding(TextEncoding::UTF16LE);
-						}
-					}
-					break;
-				default:
-					this->setfail();
-				}
-			}
-			break;
-		case '\xfe': //UTF-16BE
-			if (cb < 1)
-				this->setfail();
-			else
-			{
-				char ch1 = is.get();
-				switch (ch1)
-				{
-				case '\xff':
-					m_buf.set_encoding(TextEncoding::UTF16BE);
-					break;
-				default:
-					this->setfail();
-				}
-			}
-			this->setfail();
-			break;
-		case '\xef':
-			if (cb < 3)
-				this->setfail();
-			else
-			{
-				char ch1 = is.get();
-				switch (ch1)
-				{
-				case '\xbb':
-				{
-					char ch2 = is.get();
-					switch (ch2)
-					{
-					case '\xbf':
-						break;
-					default:
-						this->setfail();
-					}
-					break;
-				}
-				default:
-					this->setfail();
-				}
-			}
-			break;
-		case '0': //UTF-32BE ?
-			this->setfail();
-			break;
-		default:
-			is.putback(ch0);
-		}
+		if (prEncoding.first == encoding)
+			return prEncoding.second;
 	}
-	this->rdbuf(&m_buf);
+	return "ISO-8859-1";
+}
+
+//the value of the encoding attribute of the XML declaration at the beginning of the text in an ASCII compatible encoding, empty if
+//there is no declaration or no attribute
+static std::string_view declared_xml_encoding(std::string_view strText)
+{
+	constexpr std::string_view XML_DECLARATION = "<?xml";
+	constexpr std::string_view ENCODING_ATTRIBUTE = "encoding";
+	constexpr std::string_view SPACES = " \t\r\n";
+	if (strText.substr(0, XML_DECLARATION.size()) != XML_DECLARATION)
+		return std::string_view();
+	auto strDeclaration = strText.substr(0, strText.find("?>"));
+	for (auto pos = strDeclaration.find(ENCODING_ATTRIBUTE); pos != std::string_view::npos; pos = strDeclaration.find(ENCODING_ATTRIBUTE, pos + 1))
+	{
+		if (SPACES.find(strDeclaration[pos - 1]) == std::string_view::npos)
+			continue;
+		auto posValue = strDeclaration.find_first_not_of(SPACES, pos + ENCODING_ATTRIBUTE.size());
+		if (posValue == std::string_view::npos || strDeclaration[posValue] != '=')
+			continue;
+		posValue = strDeclaration.find_first_not_of(SPACES, posValue + 1);
+		if (posValue == std::string_view::npos || (strDeclaration[posValue] != '"' && strDeclaration[posValue] != '\''))
+			continue;
+		auto posEnd = strDeclaration.find(strDeclaration[posValue], posValue + 1);
+		if (posEnd == std::string_view::npos)
+			return std::string_view();
+		return strDeclaration.substr(posValue + 1, posEnd - posValue - 1);
+	}
+	return std::string_view();
+}
+
+//Examines the bytes at the current position once, before the text is decoded: the byte order mark, the layout of the characters of
+//the XML declaration, if there is no mark, and the encoding attribute of the declaration in an ASCII compatible encoding. The stream
+//is positioned after the byte order mark.
+std::optional<TextEncoding> text_istream::detect_encoding(std::istream& is)
+{
+	static constexpr std::size_t XML_DECLARATION_MAX_SIZE = 256;
+	if (is.fail())
+		return TextEncoding::UTF8;
+	auto pos_old = is.tellg();
+	char buf[XML_DECLARATION_MAX_SIZE];
+	is.read(buf, sizeof(buf));
+	auto strText = std::string_view(buf, std::size_t(is.gcount()));
+	is.clear();
+	auto starts_with = [&strText](std::string_view strPrefix) -> bool {return strText.substr(0, strPrefix.size()) == strPrefix;};
+	std::optional<TextEncoding> encoding = TextEncoding::UTF8;
+	std::streamoff cbBom = 0;
+	if (starts_with("\xef\xbb\xbf"))
+		cbBom = 3;
+	else if (starts_with(std::string_view("\xff\xfe\0\0", 4)) || starts_with(std::string_view("\0\0\xfe\xff", 4)))
+		encoding.reset(); //UTF-32
+	else if (starts_with("\xff\xfe"))
+	{
+		encoding = TextEncoding::UTF16LE;
+		cbBom = 2;
+	}else if (starts_with("\xfe\xff"))
+	{
+		encoding = TextEncoding::UTF16BE;
+		cbBom = 2;
+	}else if (starts_with(std::string_view("<\0?\0", 4)))
+		encoding = TextEncoding::UTF16LE;
+	else if (starts_with(std::string_view("\0<\0?", 4)))
+		encoding = TextEncoding::UTF16BE;
+	else if (xml_encoding_by_name(declared_xml_encoding(strText)) == TextEncoding::Windows_1251)
+		encoding = TextEncoding::Windows_1251;
+	is.seekg(pos_old + cbBom);
+	return encoding;
 }
 
 text_istream& text_istream::operator=(text_istream&& right)
 {
 	m_buf = std::move(right.m_buf);
-	this->std::wistream::operator=(std::move(right));
+	this->std::istream::operator=(std::move(right));
 	auto state = this->rdstate();
 	this->rdbuf(&m_buf);
 	this->setstate(state);
@@ -264,23 +492,11 @@ text_istream& text_istream::operator=(text_istream&& right)
 
 resource_locator text_istream::get_resource_locator() const
 {
-	return resource_locator{
-		this->get_locator().col,
-		this->get_locator().row,
-		std::wstring_convert<codecvt_byname>(new codecvt_byname("")).to_bytes(this->get_resource_id())};
+	return resource_locator{this->get_locator().col, this->get_locator().row, this->get_resource_id()};
 }
 
-const std::wstring& text_ifstream::get_resource_id() const
+const std::string& text_ifstream::get_resource_id() const
 {
 	return m_path;
 }
-std::wstring text_ifstream::path_init(std::string_view path)
-{
-	return std::wstring_convert<codecvt_byname>(new codecvt_byname("")).from_bytes(path.data(), path.data() + path.size());
-}
-std::ifstream text_ifstream::stream_init(std::wstring_view path)
-{
-	return std::ifstream{std::wstring_convert<codecvt_byname>(new codecvt_byname("")
-	).to_bytes(path.data(), path.data() + path.size()), std::ios_base::in};
-}
 
@@ -7,7 +7,7 @@ namespace xml
 		text_istream::int_type ch;
 		while ((ch = is.get()) != text_istream::traits_type::eof())
 		{
-			if (std::iswspace(ch) == 0)
+			if (!xml::isspace_t()(text_istream::traits_type::to_char_type(ch)))
 			{
 				is.putback(text_istream::traits_type::to_int_type(ch));
 				return is;
@@ -18,15 +18,14 @@ namespace xml
 	tag::tag(text_istream& is)
 	{
 		auto is_state = istream_state(is);
-		auto locale = is.getloc();
-		if (xml::skip_whitespace(is).get() != L'<')
+		if (xml::skip_whitespace(is).get() != '<')
 			throw xml_invalid_syntax(is.get_resource_locator());
 		switch (auto curr = is.get())
 		{
-		case L'?':
+		case '?':
 			{
-			const wchar_t header_xml[] = {L'x', L'm', L'l'};
-				auto it_is = std::istreambuf_iterator<wchar_t>(is);
+			const char header_xml[] = {'x', 'm', 'l'};
+				auto it_is = std::istreambuf_iterator<char>(is);
 				for (auto val:header_xml)
 					if (val != *(it_is++))
 						throw xml_invalid_syntax(is.get_resource_locator());
@@ -37,18 +36,18 @@ namespace xml
 					curr = is.get();
 					if (curr == text_istream::traits_type::eof())
 						throw xml_invalid_syntax(is.get_resource_locator());
-					if (curr == L'?')
+					if (curr == '?')
 					{
 						curr = is.get();
-						if (curr != L'>')
+						if (curr != '>')
 							throw xml_invalid_syntax(is.get_resource_locator());
 						break;
 					}
 					is.putback(char(curr));
 					auto attribute = get_xml_word(is);
-					if (is.eof() || (attribute != L"version" && attribute != L"encoding"))
+					if (is.eof() || (attribute != "version" && attribute != "encoding"))
 						throw xml_invalid_syntax(is.get_resource_locator());
-					if (xml::skip_whitespace(is).eof() || is.get() != L'=')
+					if (xml::skip_whitespace(is).eof() || is.get() != '=')
 						throw xml_invalid_syntax(is.get_resource_locator());
 					auto value = get_string_in_quotes(is);
 					if (!m_mpAttributes.emplace(attribute, value).second)
@@ -57,32 +56,32 @@ namespace xml
 				m_fIsHeader = true;
 				return;
 			}
-		case L'/':
+		case '/':
 		{
 			m_strTag = get_xml_word(is);
 			if (is.eof() || m_strTag.empty())
 				throw xml_invalid_syntax(is.get_resource_locator());
-			if (xml::skip_whitespace(is).get() != L'>')
+			if (xml::skip_whitespace(is).get() != '>')
 				throw xml_invalid_syntax(is.get_resource_locator());
 			m_fIsClosing = true;
 			return;
 		}
-		case L'!':
-			if (is.get() != L'-' || is.get() != L'-')
+		case '!':
+			if (is.get() != '-' || is.get() != '-')
 				throw xml_invalid_syntax(is.get_resource_locator());
 			while (true)
 			{
-				while (is.get() != L'-')
+				while (is.get() != '-')
 				{
 					if (is.eof())
 						throw xml_invalid_syntax(is.get_resource_locator());
 				}
-				if (is.get() == L'-' && is.get() == L'>')
+				if (is.get() == '-' && is.get() == '>')
 					break;
 				if (is.eof())
 					throw xml_invalid_syntax(is.get_resource_locator());
 			}
-			m_strTag = std::wstring(L"<comment>");
+			m_strTag = std::string("<comment>");
 			m_fIsComment = true;
 			return;
 		case text_istream::traits_type::eof():
@@ -92,20 +91,20 @@ namespace xml
 			m_strTag = get_xml_word(is);
 			if (is.eof() || m_strTag.empty())
 				throw xml_invalid_syntax(is.get_resource_locator());
-			while ((curr = xml::skip_whitespace(is).peek()) != L'>')
+			while ((curr = xml::skip_whitespace(is).peek()) != '>')
 			{
 				if (curr == text_istream::traits_type::eof())
 					throw xml_invalid_syntax(is.get_resource_locator());
-				if (curr == L'/')
+				if (curr == '/')
 				{
 					is.get();
-					if (xml::skip_whitespace(is).get() != L'>')
+					if (xml::skip_whitespace(is).get() != '>')
 						throw xml_invalid_syntax(is.get_resource_locator());
 					m_fIsUnary = true;
 					return;
 				}
 				auto attribute = get_xml_word(is);
-				if (xml::skip_whitespace(is).get() != L'=')
+				if (xml::skip_whitespace(is).get() != '=')
 					throw xml_invalid_syntax(is.get_resource_locator());
 				auto value = get_string_in_quotes(is);
 				if (!m_mpAttributes.emplace(attribute, value).second)
@@ -127,24 +126,24 @@ namespace xml
 				throw std::ios_base::failure("tag::tag");
 		}
 	}
-	std::wstring tag::get_xml_word(text_istream& is)
+	std::string tag::get_xml_word(text_istream& is)
 	{
-		std::wostringstream os;
+		std::ostringstream os;
 		text_istream::traits_type::int_type chCurrent;
 		xml::skip_whitespace(is);
-		while ((chCurrent = is.get()) != text_istream::traits_type::eof() && (std::iswalnum(chCurrent) || chCurrent == text_istream::traits_type::to_int_type(L'_')))
+		while ((chCurrent = is.get()) != text_istream::traits_type::eof() && xml::isword_t()(text_istream::traits_type::to_char_type(chCurrent)))
 			os.put(text_istream::traits_type::to_char_type(chCurrent));
 		if (chCurrent != text_istream::traits_type::eof())
 			is.putback(text_istream::traits_type::to_char_type(chCurrent));
 		return os.str();
 	}
-	std::wstring tag::get_string_in_quotes(text_istream& is)
+	std::string tag::get_string_in_quotes(text_istream& is)
 	{
-		std::wostringstream os;
+		std::ostringstream os;
 		text_istream::traits_type::int_type chCurrent;
-		if ((chCurrent = xml::skip_whitespace(is).get()) == text_istream::traits_type::eof() || chCurrent != text_istream::traits_type::to_int_type(L'\"'))
+		if ((chCurrent = xml::skip_whitespace(is).get()) == text_istream::traits_type::eof() || chCurrent != text_istream::traits_type::to_int_type('\"'))
 			throw xml_invalid_syntax(is.get_resource_locator());
-		while ((chCurrent = is.get()) != text_istream::traits_type::eof() && chCurrent != text_istream::traits_type::to_int_type(L'\"'))
+		while ((chCurrent = is.get()) != text_istream::traits_type::eof() && chCurrent != text_istream::traits_type::to_int_type('\"'))
 			os.put(text_istream::traits_type::to_char_type(chCurrent));
 		return os.str();
 	}
@@ -39,7 +39,7 @@ struct SourceDomainData
 		std::string expression_value;
 	public:
 		ExpressionRadiationData() = default;
-		ExpressionRadiationData(const std::wstring& expr):expression_value(encode_string(expr)) {}
+		ExpressionRadiationData(const std::string& expr):expression_value(expr) {}
 		virtual binary_ostream& write_to_stream(binary_ostream& os) const
 		{
 			os << datum_id << std::uint32_t(expression_value.size());
@@ -79,7 +79,7 @@ struct SourceDomainData
 		std::string expression_value;
 	public:
 		ExpressionFrequencyResponseData() = default;
-		ExpressionFrequencyResponseData(const std::wstring& expr):expression_value(encode_string(expr)) {}
+		ExpressionFrequencyResponseData(const std::string& expr):expression_value(expr) {}
 		virtual binary_ostream& write_to_stream(binary_ostream& os) const
 		{
 			os << datum_id << std::uint32_t(expression_value.size());
@@ -141,7 +141,7 @@ static FaceDomainData LoadFaceDomainData(text_istream& is, const xml::tag& openi
 		auto tag = xml::tag(is);
 		if (tag.is_comment())
 			continue;
-		else if (tag.name() == L"absorption")
+		else if (tag.name() == "absorption")
 		{
 			if (fAbsorptionSpecified)
 				throw ambiguous_specification(is.get_resource_locator(), tag.name());
@@ -150,29 +150,29 @@ static FaceDomainData LoadFaceDomainData(text_istream& is, const xml::tag& openi
 				tag = xml::tag(is);
 				if (tag.is_comment())
 					continue;
-				else if (tag.name() == L"absorption_row")
+				else if (tag.name() == "absorption_row")
 				{
-					auto freq = tag.attribute(L"frequency");
+					auto freq = tag.attribute("frequency");
 					if (freq.empty())
-						throw xml_attribute_not_found(is.get_resource_locator(), L"frequency");
+						throw xml_attribute_not_found(is.get_resource_locator(), "frequency");
 					if (!result.absorption_map.emplace(std::stod(freq), xml::get_tag_value<double>(is, tag)).second)
-						throw ambiguous_specification(is.get_resource_locator(), L"absorption_row");
-				}else if (tag.name() == L"absorption" && tag.is_closing_tag() && !tag.is_unary_tag())
+						throw ambiguous_specification(is.get_resource_locator(), "absorption_row");
+				}else if (tag.name() == "absorption" && tag.is_closing_tag() && !tag.is_unary_tag())
 					break;
 				else
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 			}
 			if (result.absorption_map.empty())
-				throw xml_tag_not_found(is.get_resource_locator(), L"absorption_row");
+				throw xml_tag_not_found(is.get_resource_locator(), "absorption_row");
 			else if (result.absorption_map.size() != 6)
-				throw invalid_xml_model(is.get_resource_locator(), L"Invalid arch_ac absorption specification");
+				throw invalid_xml_model(is.get_resource_locator(), "Invalid arch_ac absorption specification");
 			else
 			{
 				double frequency_set[] = {125, 250, 500, 1000, 2000, 4000};
 				double* f = frequency_set;
 				for (auto it = std::begin(result.absorption_map); it != std::end(result.absorption_map); ++it)
 					if (it->first != *f++)
-						throw invalid_xml_model(is.get_resource_locator(), L"Invalid arch_ac absorption specification");
+						throw invalid_xml_model(is.get_resource_locator(), "Invalid arch_ac absorption specification");
 			}
 			fAbsorptionSpecified = true;
 		}else if (tag.name() == opening_tag.name() && tag.is_closing_tag() && !tag.is_unary_tag())
@@ -181,7 +181,7 @@ static FaceDomainData LoadFaceDomainData(text_istream& is, const xml::tag& openi
 			throw improper_xml_tag(is.get_resource_locator(), tag.name());
 	}
 	if (!fAbsorptionSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"absorption");
+		throw xml_tag_not_found(is.get_resource_locator(), "absorption");
 	return result;
 }
 
@@ -202,40 +202,40 @@ static SourceDomainData LoadSourceDomainData(text_istream& is, const xml::tag& o
 		auto tag = xml::tag(is);
 		if (tag.is_comment())
 			continue;
-		else if (tag.name() == L"afc")
+		else if (tag.name() == "afc")
 		{
 			if (fFrequencyResponseSpecified)
-				throw ambiguous_specification(is.get_resource_locator(), L"afc");
+				throw ambiguous_specification(is.get_resource_locator(), "afc");
 			while (true)
 			{
 				tag = xml::tag(is);
 				if (tag.is_comment())
 					continue;
-				else if (tag.name() == L"function")
+				else if (tag.name() == "function")
 				{
 					if (fFrequencyResponseSpecified)
-						throw ambiguous_specification(is.get_resource_locator(), L"afc");
-					result.SetFrequencyResponse(SourceDomainData::ExpressionFrequencyResponseData(xml::get_tag_value<std::wstring>(is, tag)));
+						throw ambiguous_specification(is.get_resource_locator(), "afc");
+					result.SetFrequencyResponse(SourceDomainData::ExpressionFrequencyResponseData(xml::get_tag_value<std::string>(is, tag)));
 					fFrequencyResponseSpecified = true;
-				}else if (tag.name() == L"afc_row")
+				}else if (tag.name() == "afc_row")
 				{
 					if (fFrequencyResponseSpecified)
-						throw ambiguous_specification(is.get_resource_locator(), L"afc");
+						throw ambiguous_specification(is.get_resource_locator(), "afc");
 					SourceDomainData::TableFrequencyResponseData fr;
 					while (true)
 					{
-						auto freq = tag.attribute(L"frequency");
+						auto freq = tag.attribute("frequency");
 						if (freq.empty())
-							throw xml_attribute_not_found(is.get_resource_locator(), L"frequency");
+							throw xml_attribute_not_found(is.get_resource_locator(), "frequency");
 						auto value = xml::get_tag_value<double>(is, tag);
 						if (!fr.emplace(std::stod(freq), value))
-							throw ambiguous_specification(is.get_resource_locator(), L"afc_row");
+							throw ambiguous_specification(is.get_resource_locator(), "afc_row");
 						tag = xml::tag(is);
 						if (tag.is_comment())
 							continue;
-						else if (tag.name() == L"afc_row")
+						else if (tag.name() == "afc_row")
 							continue;
-						else if (tag.name() == L"afc" && tag.is_closing_tag() && !tag.is_unary_tag())
+						else if (tag.name() == "afc" && tag.is_closing_tag() && !tag.is_unary_tag())
 							break;
 						else
 							throw improper_xml_tag(is.get_resource_locator(), tag.name());
@@ -243,53 +243,53 @@ static SourceDomainData LoadSourceDomainData(text_istream& is, const xml::tag& o
 					result.SetFrequencyResponse(std::move(fr));
 					fFrequencyResponseSpecified = true;
 					break;
-				}else if (tag.name() == L"afc" && tag.is_closing_tag() && !tag.is_unary_tag())
+				}else if (tag.name() == "afc" && tag.is_closing_tag() && !tag.is_unary_tag())
 					break;
 				else
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 			};
 			if (!fFrequencyResponseSpecified)
-				throw xml_tag_not_found(is.get_resource_locator(), L"afc_row or function");
-		}else if (tag.name() == L"rp")
+				throw xml_tag_not_found(is.get_resource_locator(), "afc_row or function");
+		}else if (tag.name() == "rp")
 		{
 			if (fRadiationPatternSpecified)
-				throw ambiguous_specification(is.get_resource_locator(), L"rp");
+				throw ambiguous_specification(is.get_resource_locator(), "rp");
 			while (true)
 			{
 				tag = xml::tag(is);
 				if (tag.is_comment())
 					continue;
-				else if (tag.name() == L"function")
+				else if (tag.name() == "function")
 				{
 					if (fRadiationPatternSpecified)
-						throw ambiguous_specification(is.get_resource_locator(), L"rp");
-					result.SetRadiationPattern(SourceDomainData::ExpressionRadiationData(xml::get_tag_value<std::wstring>(is, tag)));
+						throw ambiguous_specification(is.get_resource_locator(), "rp");
+					result.SetRadiationPattern(SourceDomainData::ExpressionRadiationData(xml::get_tag_value<std::string>(is, tag)));
 					fRadiationPatternSpecified = true;
-				}else if (tag.name() == L"rp_row")
+				}else if (tag.name() == "rp_row")
 				{
 					if (fRadiationPatternSpecified)
-						throw ambiguous_specification(is.get_resource_locator(), L"radiation_pattern");
+						throw ambiguous_specification(is.get_resource_locator(), "radiation_pattern");
 					SourceDomainData::TableRadiationData rp;
 					while (true)
 					{
-						auto freq = tag.attribute(L"frequency");
+						auto freq = tag.attribute("frequency");
 						if (freq.empty())
-							throw xml_attribute_not_found(is.get_resource_locator(), L"frequency");
-						auto az = tag.attribute(L"azimuth");
+							throw xml_attribute_not_found(is.get_resource_locator(), "frequency");
+						auto az = tag.attribute("azimuth");
 						if (az.empty())
-							throw xml_attribute_not_found(is.get_resource_locator(), L"azimuth");
-						auto zn = tag.attribute(L"zenith");
+							throw xml_attribute_not_found(is.get_resource_locator(), "azimuth");
+						auto zn = tag.attribute("zenith");
 						if (zn.empty())
-							throw xml_attribute_not_found(is.get_resource_locator(), L"zenith");
+							throw xml_attribute_not_found(is.get_resource_locator(), "zenith");
 						auto value = xml::get_tag_value<double>(is, tag);
 						if (!rp.emplace(std::stod(freq), std::stod(az), std::stod(zn), value))
-							throw ambiguous_specification(is.get_resource_locator(), L"rp_row");
+							throw ambiguous_specification(is.get_resource_locator(), "rp_row");
 						tag = xml::tag(is);
 						if (tag.is_comment())
 							continue;
-						else if (tag.name() == L"rp_row")
+						else if (tag.name() == "rp_row")
 							continue;
-						else if (tag.name() == L"rp" && tag.is_closing_tag() && !tag.is_unary_tag())
+						else if (tag.name() == "rp" && tag.is_closing_tag() && !tag.is_unary_tag())
 							break;
 						else
 							throw improper_xml_tag(is.get_resource_locator(), tag.name());
@@ -297,22 +297,22 @@ static SourceDomainData LoadSourceDomainData(text_istream& is, const xml::tag& o
 					result.SetRadiationPattern(std::move(rp));
 					fRadiationPatternSpecified = true;
 					break;
-				}else if (tag.name() == L"rp" && tag.is_closing_tag() && !tag.is_unary_tag())
+				}else if (tag.name() == "rp" && tag.is_closing_tag() && !tag.is_unary_tag())
 					break;
 				else
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 			};
 			if (!fRadiationPatternSpecified)
-				throw xml_tag_not_found(is.get_resource_locator(), L"rp_row or function");
+				throw xml_tag_not_found(is.get_resource_locator(), "rp_row or function");
 		}else if (tag.name() == opening_tag.name() && tag.is_closing_tag() && !tag.is_unary_tag())
 			break;
 		else
 			throw improper_xml_tag(is.get_resource_locator(), tag.name());
 	}
 	if (!fFrequencyResponseSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"afc");
+		throw xml_tag_not_found(is.get_resource_locator(), "afc");
 	if (!fRadiationPatternSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"rp");
+		throw xml_tag_not_found(is.get_resource_locator(), "rp");
 	return result;
 }
 
@@ -331,7 +331,7 @@ static ModelDomainData LoadModelDomainData(text_istream& is, const xml::tag& ope
 		auto tag = xml::tag(is);
 		if (tag.is_comment())
 			continue;
-		else if (tag.name() == L"attenuation")
+		else if (tag.name() == "attenuation")
 		{
 			if (fModelSpecified)
 				throw ambiguous_specification(is.get_resource_locator(), tag.name());
@@ -343,7 +343,7 @@ static ModelDomainData LoadModelDomainData(text_istream& is, const xml::tag& ope
 			throw improper_xml_tag(is.get_resource_locator(), tag.name());
 	}
 	if (!fModelSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"attenuation");
+		throw xml_tag_not_found(is.get_resource_locator(), "attenuation");
 	return result;
 }
 
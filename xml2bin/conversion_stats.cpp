@@ -0,0 +1,109 @@
+#include "conversion_stats.h"
+#include <report_format.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+std::uint64_t peak_resident_set_size()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return std::uint64_t(counters.PeakWorkingSetSize);
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return std::uint64_t(usage.ru_maxrss); //bytes
+#else
+	return std::uint64_t(usage.ru_maxrss) * 1024; //kilobytes
+#endif
+#endif //_WIN32
+}
+
+static void append_object_counts(std::string& str, const CONVERSION_STATS::OBJECT_COUNTS& counts)
+{
+	str += "{\"poly_objects\": " + std::to_string(counts.poly_objects) + ", \"faces\": " + std::to_string(counts.faces)
+		+ ", \"vertices\": " + std::to_string(counts.vertices) + ", \"source_objects\": " + std::to_string(counts.source_objects)
+		+ ", \"plain_objects\": " + std::to_string(counts.plain_objects) + "}";
+}
+
+void write_conversion_stats(std::ostream& os, const CONVERSION_STATS& stats)
+{
+	std::string str = "{\n\t\"total_seconds\": ";
+	append_json_number(str, stats.total_time);
+	str += ",\n\t\"peak_resident_set_size\": " + std::to_string(stats.peak_resident_set_size);
+	str += ",\n\t\"model_bytes\": " + std::to_string(stats.model_bytes);
+	str += ",\n\t\"output_bytes\": " + std::to_string(stats.output_bytes);
+	str += ",\n\t\"serialization_seconds\": ";
+	append_json_number(str, stats.serialization_time);
+	str += ",\n\t\"objects\": ";
+	append_object_counts(str, stats.objects);
+	str += ",\n\t\"inputs\": [";
+	for (std::size_t iInput = 0; iInput < stats.inputs.size(); ++iInput)
+	{
+		const auto& input = stats.inputs[iInput];
+		str += iInput == 0?"\n\t\t{\"path\": ":",\n\t\t{\"path\": ";
+		append_json_string(str, input.path);
+		str += ", \"kind\": \"" + input.kind + "\"";
+		if (!input.encoding.empty())
+		{
+			str += ", \"encoding\": ";
+			append_json_string(str, input.encoding);
+		}
+		str += ", \"bytes\": " + std::to_string(input.bytes) + ", \"open_seconds\": ";
+		append_json_number(str, input.open_time);
+		str += ", \"parse_seconds\": ";
+		append_json_number(str, input.parse_time);
+		str += ", \"objects\": ";
+		append_object_counts(str, input.objects);
+		str += "}";
+	}
+	str += stats.inputs.empty()?"],\n\t\"domains\": {":"\n\t],\n\t\"domains\": {";
+	bool fFirst = true;
+	for (const auto& [strDomain, domain]:stats.domains)
+	{
+		str += fFirst?"\n\t\t":",\n\t\t";
+		fFirst = false;
+		append_json_string(str, strDomain);
+		str += ": {\"converted_blocks\": " + std::to_string(domain.converted_blocks) + ", \"shared_blocks\": "
+			+ std::to_string(domain.shared_blocks) + ", \"discarded_blocks\": " + std::to_string(domain.discarded_blocks) + ", \"seconds\": ";
+		append_json_number(str, domain.time);
+		str += "}";
+	}
+	str += fFirst?"}":"\n\t}";
+	if (stats.hgt.converted)
+	{
+		str += ",\n\t\"hgt\": {\n\t\t\"cached\": ";
+		str += stats.hgt.cached?"true":"false";
+		str += ",\n\t\t\"bytes\": " + std::to_string(stats.hgt.bytes) + ",\n\t\t\"seconds\": ";
+		append_json_number(str, stats.hgt.time);
+		if (!stats.hgt.cached)
+		{
+			str += ",\n\t\t\"load_seconds\": ";
+			append_json_number(str, stats.hgt.load_time);
+			str += ",\n\t\t\"matrix_init_seconds\": ";
+			append_json_number(str, stats.hgt.matrix_init_time);
+			str += ",\n\t\t\"parse_matrix_seconds\": [";
+			for (std::size_t iWorker = 0; iWorker < stats.hgt.parse_matrix_times.size(); ++iWorker)
+			{
+				if (iWorker != 0)
+					str += ", ";
+				append_json_number(str, stats.hgt.parse_matrix_times[iWorker]);
+			}
+			str += "]";
+		}
+		str += ",\n\t\t\"objects\": ";
+		append_object_counts(str, stats.hgt.objects);
+		str += "\n\t}";
+	}
+	str += "\n}\n";
+	os.write(str.data(), std::streamsize(str.size()));
+}
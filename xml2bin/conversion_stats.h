@@ -0,0 +1,66 @@
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <map>
+
+#ifndef XML2BIN_CONVERSIONSTATS_H_
+#define XML2BIN_CONVERSIONSTATS_H_
+
+//Counters and durations (in seconds) of the stages of a conversion, collected if MODEL_OUTPUT_OPTIONS::pStats is set
+struct CONVERSION_STATS
+{
+	struct OBJECT_COUNTS
+	{
+		std::uint64_t poly_objects = 0;
+		std::uint64_t faces = 0;
+		std::uint64_t vertices = 0;
+		std::uint64_t source_objects = 0;
+		std::uint64_t plain_objects = 0;
+	};
+	struct INPUT
+	{
+		std::string path; //empty, if the input is a stream
+		std::string kind; //"xml", "precompiled" or "unchanged" (copied from the previous output of the incremental conversion)
+		std::string encoding; //of an XML input
+		std::uint64_t bytes = 0; //size of the input file
+		double open_time = 0; //opening of the file and detection of the encoding
+		double parse_time = 0; //parsing of the objects including the conversion of their domain data
+		OBJECT_COUNTS objects; //the faces and the vertices are counted for XML inputs only
+	};
+	struct DOMAIN_DATA
+	{
+		std::uint64_t converted_blocks = 0;
+		std::uint64_t shared_blocks = 0; //converted blocks identical to the ones converted before, which share their data
+		std::uint64_t discarded_blocks = 0; //domain data of other domains
+		double time = 0; //included in the parse time of the inputs
+	};
+	struct HGT
+	{
+		bool converted = false;
+		bool cached = false; //the surfaces are replayed from the HGT cache, hence the durations of the stages are not set
+		std::uint64_t bytes = 0;
+		double time = 0; //the whole conversion including the HGT cache lookup
+		double load_time = 0;
+		double matrix_init_time = 0;
+		std::vector<double> parse_matrix_times; //of each worker
+		OBJECT_COUNTS objects;
+	};
+	std::vector<INPUT> inputs;
+	std::map<std::string, DOMAIN_DATA> domains;
+	HGT hgt;
+	double serialization_time = 0; //writing of the model, except for the HGT surfaces
+	std::uint64_t model_bytes = 0; //uncompressed size of the written model (of all models, if several domains are converted)
+	OBJECT_COUNTS objects; //totals including the HGT surfaces
+	//set by the caller
+	double total_time = 0;
+	std::uint64_t output_bytes = 0; //of all outputs
+	std::uint64_t peak_resident_set_size = 0;
+};
+
+//peak resident set size of the process in bytes, zero if unavailable
+std::uint64_t peak_resident_set_size();
+
+void write_conversion_stats(std::ostream& os, const CONVERSION_STATS& stats);
+
+#endif //XML2BIN_CONVERSIONSTATS_H_
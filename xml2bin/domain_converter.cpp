@@ -1,27 +1,212 @@
 #include "domain_converter.h"
 #include <xml_parser.h>
+#include <algorithm>
+#include <string_view>
+#include <content_hash.h>
 
+//a domain tag, opening or closing, starts the text, which is at least one byte longer than the closing tag name
+static bool starts_with_domain_tag(std::string_view strText)
+{
+	constexpr std::string_view OPENING_DOMAIN = "<domain";
+	constexpr std::string_view CLOSING_DOMAIN = "</domain";
+	constexpr std::string_view NAME_DELIMITERS = " \t\r\n/>";
+	if (strText.compare(0, OPENING_DOMAIN.size(), OPENING_DOMAIN) == 0)
+		return NAME_DELIMITERS.find(strText[OPENING_DOMAIN.size()]) != std::string_view::npos;
+	if (strText.compare(0, CLOSING_DOMAIN.size(), CLOSING_DOMAIN) == 0)
+		return NAME_DELIMITERS.find(strText[CLOSING_DOMAIN.size()]) != std::string_view::npos;
+	return false;
+}
+
+//returns the position of the '>' ending the tag at pos, which is not inside an attribute value, or npos, if the tag is not complete
+static std::size_t find_tag_end(std::string_view strText, std::size_t pos)
+{
+	char chQuote = 0;
+	for (; pos < strText.size(); ++pos)
+	{
+		auto ch = strText[pos];
+		if (chQuote != 0)
+		{
+			if (ch == chQuote)
+				chQuote = 0;
+		}else if (ch == '"' || ch == '\'')
+			chQuote = ch;
+		else if (ch == '>')
+			return pos;
+	}
+	return std::string_view::npos;
+}
+
+static constexpr std::size_t TAG_LOOKAHEAD = 9; //"<![CDATA[", and "</domain" with the delimiter
+
+//The scanner of the domain data shared by skip_xml_domain_data, read_xml_domain_text and peek_xml_domain_element. The text is
+//searched for '<', and only the markup is told apart: comments, CDATA sections, processing instructions, declarations
+//and tags, whose attribute values may contain '>'. Scans the text from offset for the closing domain tag ending the level. Returns
+//the position of the tag and sets offset after its '>'. If the text ends before, returns npos and sets offset to the position to
+//resume the scan at, once the text is longer.
+static std::size_t find_closing_domain_tag(std::string_view strText, std::size_t& offset, int& level)
+{
+	while (true)
+	{
+		auto pos = strText.find('<', offset);
+		if (pos == std::string_view::npos)
+		{
+			offset = strText.size();
+			return pos;
+		}
+		offset = pos;
+		auto strTag = strText.substr(pos);
+		if (strTag.size() < TAG_LOOKAHEAD)
+			return std::string_view::npos;
+		std::string_view strMarkupEnd;
+		std::size_t cchMarkupStart = 2;
+		if (strTag.compare(0, 4, "<!--") == 0)
+		{
+			strMarkupEnd = "-->";
+			cchMarkupStart = 4;
+		}else if (strTag.compare(0, 9, "<![CDATA[") == 0)
+		{
+			strMarkupEnd = "]]>";
+			cchMarkupStart = 9;
+		}else if (strTag[1] == '?')
+			strMarkupEnd = "?>";
+		else if (strTag[1] == '!')
+			strMarkupEnd = ">";
+		if (!strMarkupEnd.empty())
+		{
+			auto posEnd = strText.find(strMarkupEnd, pos + cchMarkupStart);
+			if (posEnd == std::string_view::npos)
+				return posEnd;
+			offset = posEnd + strMarkupEnd.size();
+			continue;
+		}
+		auto posEnd = find_tag_end(strText, pos);
+		if (posEnd == std::string_view::npos)
+			return posEnd;
+		offset = posEnd + 1;
+		if (!starts_with_domain_tag(strTag))
+			continue;
+		if (strTag[1] == '/')
+		{
+			if (--level == 0)
+				return pos;
+		}else if (strText[posEnd - 1] != '/')
+			++level;
+	}
+}
+
+//The buffered text is scanned in place. Only the markup split between the buffered blocks is copied, together with the text
+//following it, which is appended in portions growing twice until the markup is complete, so that the copied text is proportional
+//to the split markup rather than to the blocks.
 void skip_xml_domain_data(text_istream& is) //"is" is associated with the first character after the closing '>'
 {
+	auto pBuf = is.rdbuf();
+	std::string strPending; //the split markup
+	std::size_t offset = 0;
 	int level = 1;
-	wchar_t linebuf[100];
-	do
+	while (true)
 	{
-		auto p0 = text_istream::off_type(is.tellg());
-		is.get(linebuf, sizeof(linebuf), L'<');
-		if (is.eof())
+		auto strText = pBuf->buffered();
+		if (strText.empty())
 			throw xml_invalid_syntax(is.get_resource_locator());
-		auto cb = text_istream::off_type(is.tellg()) - p0;
-		if (cb == sizeof(linebuf) - sizeof(wchar_t))
-			continue;
-		auto tag = xml::tag(is);
-		if (tag.name() != L"domain")
+		if (strPending.empty())
+		{
+			if (find_closing_domain_tag(strText, offset, level) != std::string_view::npos)
+			{
+				pBuf->consume(offset);
+				return;
+			}
+			strPending.assign(strText.substr(offset));
+			pBuf->consume(strText.size());
+			offset = 0;
 			continue;
-		if (!tag.is_closing_tag())
+		}
+		auto cchPending = strPending.size();
+		auto cchAppended = std::min(strText.size(), std::max(cchPending, TAG_LOOKAHEAD));
+		strPending.append(strText.substr(0, cchAppended));
+		if (find_closing_domain_tag(strPending, offset, level) != std::string_view::npos)
 		{
-			++level;
+			pBuf->consume(offset - cchPending);
+			return;
+		}
+		if (offset < cchPending) //the markup is still incomplete
+		{
+			pBuf->consume(cchAppended);
+			strPending.erase(0, offset);
+			offset = 0;
 			continue;
 		}
-		--level;
-	}while (level != 0);
-}
\ No newline at end of file
+		//the rest of the buffered text is scanned in place again
+		pBuf->consume(offset - cchPending);
+		strPending.clear();
+		offset = 0;
+	}
+}
+
+//The domain data are copied only if they are split between the buffered blocks.
+std::string_view read_xml_domain_text(text_istream& is, std::string& strScratch) //"is" is associated with the first character after the opening tag
+{
+	auto pBuf = is.rdbuf();
+	std::size_t offset = 0;
+	int level = 1;
+	auto strText = pBuf->buffered();
+	if (strText.empty())
+		throw xml_invalid_syntax(is.get_resource_locator());
+	auto pos = find_closing_domain_tag(strText, offset, level);
+	if (pos != std::string_view::npos)
+	{
+		pBuf->consume(offset);
+		return strText.substr(0, pos);
+	}
+	strScratch.assign(strText);
+	pBuf->consume(strText.size());
+	do
+	{
+		strText = pBuf->buffered();
+		if (strText.empty())
+			throw xml_invalid_syntax(is.get_resource_locator());
+		auto cchScanned = strScratch.size();
+		strScratch.append(strText);
+		pos = find_closing_domain_tag(strScratch, offset, level);
+		pBuf->consume(pos == std::string_view::npos?strText.size():offset - cchScanned);
+	}while (pos == std::string_view::npos);
+	return std::string_view(strScratch).substr(0, pos);
+}
+
+std::string_view peek_xml_domain_element(text_istream& is)
+{
+	auto strText = is.rdbuf()->buffered();
+	std::size_t offset = 0;
+	int level = 1;
+	if (find_closing_domain_tag(strText, offset, level) == std::string_view::npos)
+		return std::string_view();
+	return strText.substr(0, offset);
+}
+
+std::uint64_t domain_data_cache::hash(DomainDataKind kind, std::string_view strDomain, std::string_view strElement) noexcept
+{
+	return content_hash().add(std::uint32_t(kind)).add(std::uint32_t(strDomain.size())).add(strDomain.data(), strDomain.size())
+		.add(strElement.data(), strElement.size()).value();
+}
+
+const domain_datum* domain_data_cache::find(DomainDataKind kind, std::string_view strDomain, std::string_view strElement)
+{
+	auto& counts = m_counts[std::size_t(kind)];
+	++counts.lookups;
+	auto range = m_mpEntries.equal_range(hash(kind, strDomain, strElement));
+	for (auto itEntry = range.first; itEntry != range.second; ++itEntry)
+	{
+		const auto& entry = itEntry->second;
+		if (entry.kind == kind && entry.domain == strDomain && entry.element == strElement)
+		{
+			++counts.hits;
+			return &entry.datum;
+		}
+	}
+	return nullptr;
+}
+
+void domain_data_cache::insert(DomainDataKind kind, std::string_view strDomain, std::string&& strElement, const domain_datum& datum)
+{
+	auto key = hash(kind, strDomain, strElement);
+	m_mpEntries.emplace(key, entry{kind, std::string(strDomain), std::move(strElement), datum});
+}
@@ -4,8 +4,13 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <tuple>
 #include <optional>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <memory>
 #include <basedefs.h>
 #include <binary_streams.h>
 #include <xml_parser.h>
@@ -24,20 +29,20 @@ struct domain_datum
 	typedef std::vector<std::uint8_t>::reverse_iterator reverse_iterator;
 	typedef std::vector<std::uint8_t>::const_reverse_iterator const_reverse_iterator;
 
-	inline pointer data() {return m_strg.data();}
-	inline const_pointer data() const {return m_strg.data();}
-	inline size_type size() const {return m_strg.size();}
-	inline bool empty() const {return m_strg.empty();}
+	inline const_pointer data() const {return m_pStrg?m_pStrg->data():nullptr;}
+	inline size_type size() const {return m_pStrg?m_pStrg->size():size_type();}
+	inline bool empty() const {return this->size() == 0;}
 
 	domain_datum() = default;
 	domain_datum(const domain_datum&) = default;
 	domain_datum(domain_datum&&) = default;
 	domain_datum& operator=(const domain_datum&) = default;
 	domain_datum& operator=(domain_datum&&) = default;
-	inline domain_datum(const std::vector<std::uint8_t>& vec):m_strg(vec) {}
-	inline domain_datum(std::vector<std::uint8_t>&& vec):m_strg(std::move(vec)) {}
+	inline domain_datum(const std::vector<std::uint8_t>& vec):m_pStrg(std::make_shared<const std::vector<std::uint8_t>>(vec)) {}
+	inline domain_datum(std::vector<std::uint8_t>&& vec):m_pStrg(std::make_shared<const std::vector<std::uint8_t>>(std::move(vec))) {}
 private:
-	std::vector<std::uint8_t> m_strg;
+	//immutable, hence shared by the copies of the datum (see domain_data_cache)
+	std::shared_ptr<const std::vector<std::uint8_t>> m_pStrg;
 };
 
 typedef std::map<std::string, domain_datum> domain_data_map;
@@ -62,6 +67,25 @@ struct IDomainConverter
 	virtual ~IDomainConverter() {}
 };
 
+enum class DomainDataKind
+{
+	Model,
+	Poly,
+	Face,
+	Source,
+	Plain
+};
+
+//a converter of a domain known at runtime only (see plugin_domain_converter.h), which writes the domain data to the vector directly
+struct IRuntimeDomainConverter:IDomainConverter
+{
+	virtual const std::string& domain_name() const = 0;
+	//returns false and skips the domain data, if the domain has no data of the kind
+	virtual bool convert_domain_data(DomainDataKind kind, const xml::tag& domain_opening_tag, text_istream& is, std::vector<std::uint8_t>& vData) = 0;
+	//true, if the identical domain data are always converted to the identical data, so that the converted data can be shared
+	virtual bool is_deterministic() const = 0;
+};
+
 //converter for a domain data must have the interface:
 /*
 struct
@@ -82,7 +106,49 @@ struct
 };
 */
 
+//Extracts the domain data including the closing domain tag without converting them.
 void skip_xml_domain_data(text_istream& is);
+//Extracts the domain data including the closing domain tag and returns their text without the closing tag. The text is a view of
+//the buffer of the stream, if the domain data are buffered entirely, or of strScratch otherwise, and is valid until the stream is read.
+std::string_view read_xml_domain_text(text_istream& is, std::string& strScratch);
+//Returns the text of the domain data including the closing domain tag, if it is buffered entirely, or an empty view otherwise.
+//Nothing is extracted from the stream.
+std::string_view peek_xml_domain_element(text_istream& is);
+
+//Hash-consing of the converted domain data: the identical domain data elements (see peek_xml_domain_element) of a domain and
+//a kind are converted once, and the objects share their immutable datum. The elements of a kind are no longer looked up, once
+//the first of them have turned out to be mostly distinct, since the lookups would cost more than they save.
+class domain_data_cache
+{
+public:
+	bool is_worth_lookup(DomainDataKind kind) const noexcept
+	{
+		const auto& counts = m_counts[std::size_t(kind)];
+		return counts.lookups < SAMPLE_LOOKUPS || counts.hits * MIN_HIT_RATIO_INVERSE >= counts.lookups;
+	}
+	//returns the datum of the element converted before, null if there is none
+	const domain_datum* find(DomainDataKind kind, std::string_view strDomain, std::string_view strElement);
+	void insert(DomainDataKind kind, std::string_view strDomain, std::string&& strElement, const domain_datum& datum);
+private:
+	static constexpr std::uint64_t SAMPLE_LOOKUPS = 4096;
+	static constexpr std::uint64_t MIN_HIT_RATIO_INVERSE = 8;
+	struct lookup_counts
+	{
+		std::uint64_t lookups = 0;
+		std::uint64_t hits = 0;
+	};
+	lookup_counts m_counts[std::size_t(DomainDataKind::Plain) + 1];
+	struct entry
+	{
+		DomainDataKind kind;
+		std::string domain;
+		std::string element;
+		domain_datum datum;
+	};
+	std::unordered_multimap<std::uint64_t, entry> m_mpEntries; //by the hash of the kind, the domain and the element
+
+	static std::uint64_t hash(DomainDataKind kind, std::string_view strDomain, std::string_view strElement) noexcept;
+};
 
 template <class T, class = void> struct has_model_domain_data:std::false_type {};
 template <class T> struct has_model_domain_data<T, std::void_t<decltype(std::declval<T>().model_domain_data(std::declval<const xml::tag&>(), std::declval<text_istream&>(), std::declval<binary_ostream&>()))>>:std::true_type {};
@@ -307,183 +373,144 @@ private:
 	Converter m_conv;
 };
 
-struct generalized_converter:IDomainConverter
+//Converts the domain data by the converters of the types known at compile time. A domain name is resolved to the index of its
+//converter once per distinct name, and the conversion is dispatched through a table of the functions instantiated for each
+//converter type, without virtual calls. The converters write to the buffers kept for each of them. The converters of the domains
+//known at runtime only are resolved after the ones of Converters.
+template <class ... Converters>
+class converter_registry
 {
-	template <class NameConverterTuple>
-	generalized_converter(NameConverterTuple&& name_conv_tpl):m_mpConv(create_map(std::forward<NameConverterTuple>(name_conv_tpl)))
-	{}
-	virtual bool model_domain_data(std::string_view DomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+public:
+	static constexpr std::size_t npos = std::size_t(-1);
+	static constexpr std::size_t size() noexcept
 	{
-		auto itConv = m_mpConv.find(DomainName);
-		if (itConv != m_mpConv.end())
-			return convert_model_domain_data(*itConv->second, domain_opening_tag, is, os);
-		else
-		{
-			skip_xml_domain_data(is);
-			return false;
-		}
+		return sizeof ... (Converters);
 	}
-	virtual bool poly_domain_data(std::string_view DomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+	//index of the converter of the domain, npos if there is none
+	static std::size_t find(std::string_view strDomain)
 	{
-		auto itConv = m_mpConv.find(DomainName);
-		if (itConv != m_mpConv.end())
-			return convert_poly_domain_data(*itConv->second, domain_opening_tag, is, os);
-		else
+		const std::string* pNames[] = {&Converters::domain_name() ... };
+		for (std::size_t iConverter = 0; iConverter < size(); ++iConverter)
 		{
-			skip_xml_domain_data(is);
-			return false;
+			if (*pNames[iConverter] == strDomain)
+				return iConverter;
 		}
+		return npos;
 	}
-	virtual bool face_domain_data(std::string_view DomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+	converter_registry():m_vEnabled(size(), true) {}
+	//adds an enabled converter of a domain known at runtime and returns its index. The converter must outlive the registry.
+	std::size_t add(IRuntimeDomainConverter& conv)
 	{
-		auto itConv = m_mpConv.find(DomainName);
-		if (itConv != m_mpConv.end())
-			return convert_face_domain_data(*itConv->second, domain_opening_tag, is, os);
-		else
-		{
-			skip_xml_domain_data(is);
-			return false;
-		}
+		m_vRuntime.emplace_back(std::addressof(conv));
+		m_vEnabled.emplace_back(true);
+		m_vResolved.clear();
+		return m_vEnabled.size() - 1;
 	}
-	virtual bool source_domain_data(std::string_view DomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+	//index of the converter of the domain including the ones added at runtime, npos if there is none
+	std::size_t index_of(std::string_view strDomain) const
 	{
-		auto itConv = m_mpConv.find(DomainName);
-		if (itConv != m_mpConv.end())
-			return convert_source_domain_data(*itConv->second, domain_opening_tag, is, os);
-		else
+		auto iConverter = find(strDomain);
+		if (iConverter != npos)
+			return iConverter;
+		for (std::size_t iRuntime = 0; iRuntime < m_vRuntime.size(); ++iRuntime)
 		{
-			skip_xml_domain_data(is);
-			return false;
+			if (m_vRuntime[iRuntime]->domain_name() == strDomain)
+				return size() + iRuntime;
 		}
+		return npos;
 	}
-	virtual bool plain_domain_data(std::string_view DomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+	//true, if the domain data of the domain are converted
+	bool converts(std::string_view strDomain)
 	{
-		auto itConv = m_mpConv.find(DomainName);
-		if (itConv != m_mpConv.end())
-			return convert_plain_domain_data(*itConv->second, domain_opening_tag, is, os);
-		else
-		{
-			skip_xml_domain_data(is);
-			return false;
-		}
+		return this->resolve(strDomain) != npos;
 	}
-	virtual std::optional<domain_datum> constant_face_domain_data(std::string_view DomainName, ConstantDomainDataId id)
+	//true, if the domain data of the domain are converted and the data converted from the identical domain data can be shared. The
+	//built-in converters are deterministic, the ones added at runtime are, if they declare it.
+	bool is_deterministic(std::string_view strDomain)
 	{
-		auto itConv = m_mpConv.find(DomainName);
-		if (itConv != m_mpConv.end())
-		{
-			buf_ostream os;
-			if (write_constant_face_domain_data(itConv->second, id, os))
-				return std::optional<domain_datum>{std::in_place_t(), std::move(os.get_vector())};
-		}
-		return std::optional<domain_datum>();
-	}
-	virtual domain_data_map constant_face_domain_data(ConstantDomainDataId id)
-	{
-		domain_data_map mpRet;
-		for (auto& conv:m_mpConv)
-		{
-			buf_ostream os;
-			if (write_constant_face_domain_data(conv.second, id, os))
-				mpRet.emplace(conv.first, std::move(os.get_vector()));
-		}
-		return mpRet;
+		auto iConverter = this->resolve(strDomain);
+		if (iConverter == npos)
+			return false;
+		return iConverter < size() || m_vRuntime[iConverter - size()]->is_deterministic();
 	}
-	virtual std::optional<domain_datum> constant_poly_domain_data(std::string_view DomainName, ConstantDomainDataId id)
+	//the domain data of the other domains are skipped
+	void enable_only(std::size_t iConverter)
 	{
-		auto itConv = m_mpConv.find(DomainName);
-		if (itConv != m_mpConv.end())
-		{
-			buf_ostream os;
-			if (write_constant_poly_domain_data(itConv->second, id, os))
-				return std::optional<domain_datum>{std::in_place_t(), std::move(os.get_vector())};
-		}
-		return std::optional<domain_datum>();
+		std::fill(m_vEnabled.begin(), m_vEnabled.end(), false);
+		m_vEnabled[iConverter] = true;
+		m_vResolved.clear();
 	}
-	virtual domain_data_map constant_poly_domain_data(ConstantDomainDataId id)
+	//the domain data of the domain are converted as well
+	void enable(std::size_t iConverter)
 	{
-		domain_data_map mpRet;
-		for (auto& conv:m_mpConv)
-		{
-			buf_ostream os;
-			if (write_constant_poly_domain_data(conv.second, id, os))
-				mpRet.emplace(conv.first, std::move(os.get_vector()));
-		}
-		return mpRet;
+		m_vEnabled[iConverter] = true;
+		m_vResolved.clear();
 	}
-	virtual std::optional<domain_datum> constant_source_domain_data(std::string_view DomainName, ConstantDomainDataId id)
+	//Converts the domain data into vData and returns true, if the converter of the domain is enabled and supports the kind of the
+	//domain data. Otherwise skips the domain data and returns false.
+	template <DomainDataKind kind>
+	bool convert(std::string_view strDomain, const xml::tag& domain_opening_tag, text_istream& is, std::vector<std::uint8_t>& vData)
 	{
-		auto itConv = m_mpConv.find(DomainName);
-		if (itConv != m_mpConv.end())
+		static constexpr auto CONVERT = make_dispatch_table<kind>(std::index_sequence_for<Converters ... >());
+		auto iConverter = this->resolve(strDomain);
+		if (iConverter == npos)
 		{
-			buf_ostream os;
-			if (write_constant_source_domain_data(itConv->second, id, os))
-				return std::optional<domain_datum>{std::in_place_t(), std::move(os.get_vector())};
-		}
-		return std::optional<domain_datum>();
-	}
-	virtual domain_data_map constant_source_domain_data(ConstantDomainDataId id)
-	{
-		domain_data_map mpRet;
-		for (auto& conv:m_mpConv)
-		{
-			buf_ostream os;
-			if (write_constant_source_domain_data(conv.second, id, os))
-				mpRet.emplace(conv.first, std::move(os.get_vector()));
+			skip_xml_domain_data(is);
+			return false;
 		}
-		return mpRet;
+		if (iConverter >= size())
+			return m_vRuntime[iConverter - size()]->convert_domain_data(kind, domain_opening_tag, is, vData);
+		return (this->*CONVERT[iConverter])(domain_opening_tag, is, vData);
 	}
-	virtual std::optional<domain_datum> constant_plain_domain_data(std::string_view DomainName, ConstantDomainDataId id)
+private:
+	typedef bool (converter_registry::*convert_fn)(const xml::tag&, text_istream&, std::vector<std::uint8_t>&);
+	std::tuple<Converters ... > m_converters;
+	buf_ostream m_buffers[sizeof ... (Converters)];
+	std::vector<IRuntimeDomainConverter*> m_vRuntime;
+	std::vector<bool> m_vEnabled; //of Converters followed by the runtime converters
+	std::vector<std::pair<std::string, std::size_t>> m_vResolved; //the distinct domain names met and the indices of their enabled converters
+
+	std::size_t resolve(std::string_view strDomain)
 	{
-		auto itConv = m_mpConv.find(DomainName);
-		if (itConv != m_mpConv.end())
+		for (const auto& prResolved:m_vResolved)
 		{
-			buf_ostream os;
-			if (write_constant_plain_domain_data(itConv->second, id, os))
-				std::optional<domain_datum>{std::in_place_t(), std::move(os.get_vector())};
+			if (prResolved.first == strDomain)
+				return prResolved.second;
 		}
-		return std::optional<domain_datum>();
+		auto iConverter = this->index_of(strDomain);
+		if (iConverter != npos && !m_vEnabled[iConverter])
+			iConverter = npos;
+		m_vResolved.emplace_back(std::string(strDomain), iConverter);
+		return iConverter;
 	}
-	virtual domain_data_map constant_plain_domain_data(ConstantDomainDataId id)
+	template <DomainDataKind kind, std::size_t ... I>
+	static constexpr std::array<convert_fn, sizeof ... (Converters)> make_dispatch_table(std::index_sequence<I ... >)
 	{
-		domain_data_map mpRet;
-		for (auto& conv:m_mpConv)
-		{
-			buf_ostream os;
-			if (write_constant_plain_domain_data(conv.second, id, os))
-				mpRet.emplace(conv.first, std::move(os.get_vector()));
-		}
-		return mpRet;
+		return {{&converter_registry::convert_by<kind, I> ... }};
 	}
-private:
-	struct less_transparent
+	template <DomainDataKind kind, std::size_t I>
+	bool convert_by(const xml::tag& domain_opening_tag, text_istream& is, std::vector<std::uint8_t>& vData)
 	{
-		bool operator()(std::string_view lhs, std::string_view rhs) const
+		auto& conv = std::get<I>(m_converters);
+		auto& os = m_buffers[I];
+		os.clear_buffers();
+		bool fConverted;
+		if constexpr (kind == DomainDataKind::Model)
+			fConverted = convert_model_domain_data(conv, domain_opening_tag, is, os);
+		else if constexpr (kind == DomainDataKind::Poly)
+			fConverted = convert_poly_domain_data(conv, domain_opening_tag, is, os);
+		else if constexpr (kind == DomainDataKind::Face)
+			fConverted = convert_face_domain_data(conv, domain_opening_tag, is, os);
+		else if constexpr (kind == DomainDataKind::Source)
+			fConverted = convert_source_domain_data(conv, domain_opening_tag, is, os);
+		else
+			fConverted = convert_plain_domain_data(conv, domain_opening_tag, is, os);
+		if (fConverted)
 		{
-			return lhs < rhs;
+			const auto& vBuf = os.get_vector();
+			vData.assign(vBuf.begin(), vBuf.end());
 		}
-		typedef void is_transparent;
-	};
-	typedef std::map<std::string, std::unique_ptr<IDomainConverter>, less_transparent> map_type;
-	map_type m_mpConv;
-	template <std::size_t I = 0, class ... Init>
-	static auto create_map(const std::tuple<Init...>& tpl) -> std::enable_if_t<(I + 1 < sizeof ... (Init)), map_type>
-	{
-		map_type mp = create_map<I + 2>(tpl);
-		mp.emplace(std::get<I>(tpl), std::unique_ptr<IDomainConverter>(new ConverterImpl<std::tuple_element_t<I + 1, std::tuple<Init...>>>(std::get<I + 1>(tpl))));
-		return mp;
-	}
-	template <std::size_t I = 0, class ... Init>
-	static auto create_map(std::tuple<Init...>&& tpl) -> std::enable_if_t<(I + 1 < sizeof ... (Init)), map_type>
-	{
-		map_type mp = create_map<I + 2>(std::move(tpl));
-		mp.emplace(std::get<I>(tpl), std::unique_ptr<IDomainConverter>(new ConverterImpl<std::tuple_element_t<I + 1, std::tuple<Init...>>>(std::get<I + 1>(std::move(tpl)))));
-		return mp;
-	}
-	template <std::size_t I = 0>
-	static auto create_map(...)
-	{
-		return map_type();
+		return fConverted;
 	}
 };
 
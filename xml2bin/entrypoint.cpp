@@ -1,10 +1,17 @@
 #include "xml2bin.h"
+#include "conversion_stats.h"
+#include <compressed_streams.h>
 #include <list>
 #include <string>
 #include <stdexcept>
 #include <fstream>
 #include <algorithm>
 #include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <iterator>
 
 struct invalid_usage:std::runtime_error
 {
@@ -49,14 +56,75 @@ public:
 				m_hgt = argv[++i];
 			}else if (std::string_view(argv[i]) == "--domain")
 			{
-				if (i == argc - 1 || !m_domain.empty())
+				if (i == argc - 1 || std::find(m_vDomains.begin(), m_vDomains.end(), argv[i + 1]) != m_vDomains.end())
 					throw invalid_usage();
-				m_domain = argv[++i];
+				m_vDomains.emplace_back(argv[++i]);
+			}else if (std::string_view(argv[i]) == "--domain_plugin")
+			{
+				if (i == argc - 1)
+					throw invalid_usage();
+				m_output_options.vDomainPlugins.emplace_back(argv[++i]);
 			}else if (std::string_view(argv[i]) == "--discard_output")
 			{
 				if (m_fDiscardOutput)
 					throw invalid_usage();
 				m_fDiscardOutput = true;
+			}else if (std::string_view(argv[i]) == "--indexed_hgt")
+			{
+				if (m_hgt_options.fIndexedFaces)
+					throw invalid_usage();
+				m_hgt_options.fIndexedFaces = true;
+			}else if (std::string_view(argv[i]) == "--hgt_tolerance")
+			{
+				if (i == argc - 1 || m_hgt_options.eHeightTolerance > 0)
+					throw invalid_usage();
+				char* pEnd;
+				m_hgt_options.eHeightTolerance = std::strtod(argv[++i], &pEnd);
+				if (*pEnd != '\0' || !(m_hgt_options.eHeightTolerance > 0) || !std::isfinite(m_hgt_options.eHeightTolerance))
+					throw invalid_usage();
+			}else if (std::string_view(argv[i]) == "--hgt_cache")
+			{
+				if (i == argc - 1 || !m_hgt_options.strCacheDirectory.empty())
+					throw invalid_usage();
+				m_hgt_options.strCacheDirectory = argv[++i];
+			}else if (std::string_view(argv[i]) == "--hgt_detail_radius")
+			{
+				if (i == argc - 1 || m_hgt_options.eDetailRadius > 0)
+					throw invalid_usage();
+				char* pEnd;
+				m_hgt_options.eDetailRadius = std::strtod(argv[++i], &pEnd);
+				if (*pEnd != '\0' || !(m_hgt_options.eDetailRadius > 0) || !std::isfinite(m_hgt_options.eDetailRadius))
+					throw invalid_usage();
+			}else if (std::string_view(argv[i]) == "--precompile")
+			{
+				if (m_fPrecompile)
+					throw invalid_usage();
+				m_fPrecompile = true;
+			}else if (std::string_view(argv[i]) == "--object_index")
+			{
+				if (m_output_options.fObjectIndex)
+					throw invalid_usage();
+				m_output_options.fObjectIndex = true;
+			}else if (std::string_view(argv[i]) == "--compress")
+			{
+				if (m_fCompress)
+					throw invalid_usage();
+				m_fCompress = true;
+			}else if (std::string_view(argv[i]) == "--stats")
+			{
+				if (m_fStats)
+					throw invalid_usage();
+				m_fStats = true;
+			}else if (std::string_view(argv[i]) == "--stats_file")
+			{
+				if (i == argc - 1 || !m_stats_file.empty())
+					throw invalid_usage();
+				m_stats_file = argv[++i];
+			}else if (std::string_view(argv[i]) == "--incremental")
+			{
+				if (i == argc - 1 || !m_manifest.empty())
+					throw invalid_usage();
+				m_manifest = argv[++i];
 			}else if (argv[i][0] == '-' && argv[i][1] == '-')
 				throw invalid_usage();
 			else
@@ -68,85 +136,223 @@ public:
 		{
 			this->add_file(argv[i]);
 		}while (++i < argc);
-		if (!this->is_ready())
+		this->split_outputs();
+		if (!this->is_ready() || (m_hgt.empty() && (m_hgt_options.fIndexedFaces || m_hgt_options.eHeightTolerance > 0 || !m_hgt_options.strCacheDirectory.empty())))
+			throw invalid_usage();
+		if (m_hgt_options.eDetailRadius > 0 && !(m_hgt_options.eHeightTolerance > 0))
+			throw invalid_usage();
+		if (m_fPrecompile && (!m_hgt.empty() || !m_manifest.empty() || m_output_options.fObjectIndex))
+			throw invalid_usage();
+		if (m_vDomains.size() > 1 && (m_fPrecompile || !m_manifest.empty()))
+			throw invalid_usage();
+		if (m_fCompress && (m_fPrecompile || !m_manifest.empty()))
+			throw invalid_usage();
+		if (!m_stats_file.empty() && !m_fStats)
 			throw invalid_usage();
 	}
 	bool is_ready() const
 	{
-		return !m_lstXml.empty() && !m_output.empty() && !m_domain.empty();
+		return !m_lstXml.empty() && !m_vDomains.empty() && m_lstOutputs.size() == m_vDomains.size();
 	}
 	Program& run()
 	{
-		std::list<text_ifstream> m_lst_xml_is;
-
 		if (!is_ready())
 			throw invalid_usage();
+		if (!m_fStats)
+			return this->run_conversion();
+		CONVERSION_STATS stats;
+		m_output_options.pStats = std::addressof(stats);
+		auto start = std::chrono::steady_clock::now();
+		this->run_conversion();
+		stats.total_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		for (const auto& strOutput:m_lstOutputs)
+			stats.output_bytes += std::uint64_t(std::streamoff(std::ifstream(strOutput, std::ios_base::in | std::ios_base::binary | std::ios_base::ate).tellg()));
+		stats.peak_resident_set_size = peak_resident_set_size();
+		if (m_stats_file.empty())
+		{
+			write_conversion_stats(std::cerr, stats);
+			return *this;
+		}
+		std::ofstream os_stats(m_stats_file);
+		if (os_stats.fail())
+			throw failed_to_open_a_file(m_stats_file);
+		write_conversion_stats(os_stats, stats);
+		return *this;
+	}
+private:
+	std::list<std::string> m_lstXml;
+	std::string m_hgt;
+	std::string m_manifest;
+	std::string m_stats_file;
+	HGT_CONVERSION_OPTIONS m_hgt_options;
+	MODEL_OUTPUT_OPTIONS m_output_options;
+	bool m_fDiscardOutput = false;
+	bool m_fPrecompile = false;
+	bool m_fCompress = false;
+	bool m_fStats = false;
+	std::list<std::string> m_lstOutputs; //of each domain in the order of m_vDomains
+	std::vector<std::string> m_vDomains;
+	static std::string m_help_str;
+
+	Program& run_conversion()
+	{
+		if (!m_manifest.empty())
+			return this->run_incremental();
 		for (const auto& strXml:m_lstXml)
 		{
-			if (m_lst_xml_is.emplace_back(text_ifstream(std::string_view(strXml))).fail())
+			if (std::ifstream(strXml).fail())
 				throw failed_to_open_a_file(strXml);
 		}
-		auto os = binary_ofstream(std::string_view(m_output), m_fDiscardOutput);
-		if (os.fail())
-			throw failed_to_open_a_file(m_output);
+		std::list<binary_ofstream> lstOs;
+		for (const auto& strOutput:m_lstOutputs)
+		{
+			if (lstOs.emplace_back(std::string_view(strOutput), m_fDiscardOutput).fail())
+				throw failed_to_open_a_file(strOutput);
+		}
+		if (m_fPrecompile)
+		{
+			xml2bin_precompile(m_vDomains.front(), std::begin(m_lstXml), std::end(m_lstXml), lstOs.front(), m_output_options);
+			return *this;
+		}
+		std::vector<DOMAIN_OUTPUT> outputs;
+		if (!m_fCompress)
+		{
+			for (auto& os:lstOs)
+				outputs.emplace_back(DOMAIN_OUTPUT{m_vDomains[outputs.size()], std::addressof(os)});
+			return this->convert(outputs);
+		}
+		std::list<compressed_ostream> lstCompressed;
+		for (auto& os:lstOs)
+			outputs.emplace_back(DOMAIN_OUTPUT{m_vDomains[outputs.size()], std::addressof(lstCompressed.emplace_back(os))});
+		this->convert(outputs);
+		for (auto& os_compressed:lstCompressed)
+			os_compressed.finish();
+		return *this;
+	}
+
+	//the inputs are parsed once for all domains
+	Program& convert(const std::vector<DOMAIN_OUTPUT>& outputs)
+	{
+		auto& os = *outputs.front().pOs;
 		if (m_hgt.empty())
 		{
-			xml2bin(m_domain, std::begin(m_lst_xml_is), std::end(m_lst_xml_is), os);
+			if (outputs.size() == 1)
+				xml2bin(m_vDomains.front(), std::begin(m_lstXml), std::end(m_lstXml), os, m_output_options);
+			else
+				xml2bin_domains(outputs, std::begin(m_lstXml), std::end(m_lstXml), m_output_options);
 			return *this;
 		}
 		auto is_hgt = std::ifstream(m_hgt, std::ios_base::in | std::ios_base::binary);
 		if (is_hgt.fail())
 			throw failed_to_open_a_file(m_hgt);
+		if (outputs.size() == 1)
+			hgtxml2bin(m_vDomains.front(), hgt_resolution(is_hgt), m_hgt_options, is_hgt, std::begin(m_lstXml), std::end(m_lstXml), os, m_output_options);
+		else
+			hgtxml2bin_domains(outputs, hgt_resolution(is_hgt), m_hgt_options, is_hgt, std::begin(m_lstXml), std::end(m_lstXml), m_output_options);
+		return *this;
+	}
+	Program& run_incremental()
+	{
+		if (m_hgt.empty())
+		{
+			xml2bin_incremental(m_vDomains.front(), m_manifest, std::begin(m_lstXml), std::end(m_lstXml), m_lstOutputs.front(), m_output_options);
+			return *this;
+		}
+		auto is_hgt = std::ifstream(m_hgt, std::ios_base::in | std::ios_base::binary);
+		if (is_hgt.fail())
+			throw failed_to_open_a_file(m_hgt);
+		hgtxml2bin_incremental(m_vDomains.front(), m_manifest, hgt_resolution(is_hgt), m_hgt_options, is_hgt, std::begin(m_lstXml), std::end(m_lstXml), 
+			m_lstOutputs.front(), m_output_options);
+		return *this;
+	}
+	static HGT_RESOLUTION_DATA hgt_resolution(std::istream& is_hgt)
+	{
 		is_hgt.seekg(0, std::ios_base::end);
 		auto cb = std::size_t(std::streamoff(is_hgt.tellg()));
 		is_hgt.seekg(0, std::ios_base::beg);
-		HGT_RESOLUTION_DATA hgt_res;
 		switch (cb)
 		{
 		case HGT_3.cColumns * HGT_3.cRows * sizeof(std::int16_t):
-			hgt_res = HGT_3;
-			break;
+			return HGT_3;
 		case HGT_1.cColumns * HGT_1.cRows * sizeof(std::int16_t):
-			hgt_res = HGT_1;
-			break;
+			return HGT_1;
 		default:
 			throw unexpected_hgt_size();
 		}
-		hgtxml2bin(m_domain, hgt_res, is_hgt, std::begin(m_lst_xml_is), std::end(m_lst_xml_is), os);
-		return *this;
 	}
-private:
-	std::list<std::string> m_lstXml;
-	std::string m_hgt;
-	bool m_fDiscardOutput = false;
-	std::string m_output;
-	std::string m_domain;
-	static std::string m_help_str;
-
 	Program& add_file(const char* file)
 	{
-		if (!m_output.empty())
-			m_lstXml.emplace_back(std::move(m_output));
-		m_output = file;
+		m_lstXml.emplace_back(file);
+		return *this;
+	}
+	//the last files are the outputs of the domains, the rest are the inputs
+	Program& split_outputs()
+	{
+		if (m_lstXml.size() <= m_vDomains.size())
+			throw invalid_usage();
+		m_lstOutputs.splice(m_lstOutputs.end(), m_lstXml, std::prev(m_lstXml.end(), std::ptrdiff_t(m_vDomains.size())), m_lstXml.end());
 		return *this;
 	}
 };
 
 std::string Program::m_help_str =
-"xml2bin <[--domain <domain_name>] [--hgt <path_to_hgt>] [--discard_output] <input_xml_file_1> [... input_xml_file_n] <output_binary_file>>|<--help>\n"\
+"xml2bin <[--domain <domain_name> [... --domain <domain_name_n>]] [--domain_plugin <path_to_plugin> [... --domain_plugin <path_to_plugin_n>]] [--hgt <path_to_hgt> [--indexed_hgt] [--hgt_tolerance <meters> [--hgt_detail_radius <meters>]] [--hgt_cache <directory>]] [--discard_output] [--object_index] [--compress] [--stats [--stats_file <json_file>]] [--incremental <manifest_file> | --precompile] <input_xml_file_1> [... input_xml_file_n] <output_binary_file> [... output_binary_file_n]>|<--help>\n"\
 " --domain specifies a domain system id for which the program should perform the conversion. If an XML file contains definitions of\n"\
 "       domain data with domain id different from the id specified by the --domain parameter, that domain data will be discarded.\n"\
+"       The parameter can be repeated to convert the input files for several domains at once: the files are parsed once and a model\n"\
+"       is written for each domain to its own output binary file. The geometry of the objects and the surfaces obtained from the HGT\n"\
+"       file are shared by the models, which differ in the domain data only. Several domains cannot be combined with --incremental\n"\
+"       and --precompile.\n"\
+" --domain_plugin specifies a path to a shared object (a DLL on Windows) implementing the converter of a domain in addition to\n"\
+"       the built-in ones, whose name can be specified by --domain then. The interface of the plugins is declared by\n"\
+"       domain_plugin.h. The parameter can be repeated to load several plugins, which must convert distinct domains. The identical\n"\
+"       domain data are converted once only by the plugins declaring their conversion deterministic.\n"\
 " --hgt specifies a path to a HGT file to be converted to a set of polygonal surfaces to specify, together with the XML files,\n"\
 "       the output binary model. Only SRTM 30m and SRTM 90m are supported. The parameter is optional.\n"\
+" --indexed_hgt is a switch which makes the surfaces obtained from the HGT file be written as indexed polygonal objects: a table of\n"\
+"       unique vertices shared by the faces, and the faces specified by the indices into the table. The resulting model is smaller,\n"\
+"       but requires a reader supporting indexed objects (see bin2txt --model). Requires --hgt.\n"\
+" --hgt_tolerance specifies a positive vertical error in meters allowed for the surfaces obtained from the HGT file. The surfaces\n"\
+"       are simplified to an adaptive triangulation which deviates from the HGT heights by no more than the tolerance. Without\n"\
+"       the parameter only exactly coplanar faces are merged. Requires --hgt.\n"\
+" --hgt_detail_radius specifies a radius in meters around the sources and the plains, within which the surfaces obtained from\n"\
+"       the HGT file keep the full resolution, while further out they are simplified according to --hgt_tolerance. Requires\n"\
+"       --hgt_tolerance.\n"\
+" --hgt_cache specifies an existing directory of the persistent cache of the surfaces obtained from HGT files. If the same HGT file\n"\
+"       has already been converted with the same options and domain, the surfaces are copied from the cache. Otherwise they are\n"\
+"       stored in the cache after the conversion. Requires --hgt.\n"\
 " --discard_output is a switch which allows to truncate the output file before the processing, should the file exist. Otherwise, if\n"\
 "       the output file exists and not empty, the program will fail.\n"\
+" --object_index is a switch which makes the program append an index of the objects to the output binary file: the position and\n"\
+"       the size of each object and a hash table of the object names. Readers supporting the index (see bin2txt --model) locate\n"\
+"       the objects without walking through the model, readers walking through it ignore the index. Cannot be combined with\n"\
+"       --precompile.\n"\
+" --compress is a switch which makes the program compress the output binary file. The model is split into blocks of 1 MiB\n"\
+"       compressed in parallel and independently of each other, so that any block can be decompressed without the preceding\n"\
+"       ones. Compressed models are read by bin2txt --model. Cannot be combined with --incremental and --precompile.\n"\
+" --stats is a switch which makes the program write a report of the conversion to the standard error stream as JSON: the durations\n"\
+"       of the stages (opening and parsing of each input file, conversion of the domain data of each domain, loading of the HGT file,\n"\
+"       initialization of the height matrix and its parsing by each worker, writing of the model), the sizes of the inputs and\n"\
+"       of the output, the object, face and vertex counts, the counts of the domain data blocks converted and of the ones identical\n"\
+"       to the blocks converted before, which are not converted again, and the peak resident set size of the process.\n"\
+" --stats_file specifies a path to the file the report of --stats is written to instead of the standard error stream.\n"\
+"       Requires --stats.\n"\
+" --incremental specifies a path to a manifest describing the output binary file in terms of the input XML files it has been\n"\
+"       converted from. If the manifest describes the existing output binary file, the objects of the input XML files unchanged since\n"\
+"       then are copied from it instead of being converted again. The output binary file is replaced regardless of --discard_output,\n"\
+"       and the manifest is created or updated afterwards. The input XML files are identified by their paths as specified.\n"\
+" --precompile is a switch which makes the program write a precompiled model of the input XML files to the output file instead of\n"\
+"       the binary model. A precompiled model holds the objects and the generic model parameters specified by the files, converted\n"\
+"       for the domain, and can be specified instead of the files as an input file later on to skip parsing them. The generic model\n"\
+"       parameters need not be specified. Cannot be combined with --hgt, --incremental, --object_index and --compress.\n"\
 " <input_xml_file_1> [... input_xml_file_n] is a set of one or more input XML files. Each file must specify unique objects (sources\n"\
 "       and/or control panes and/or polygonal reflectors) to be unified to the resulting binary definition of the model, perhaps\n"\
 "       with the specified HGT. All such objects, if they are named, must be specified in the set of input files not more than once.\n"\
 "       The generic model parameters (size, domain data, etc.) must be specified exactly once. Should an XML file omit the generic\n"\
 "       model parameters, the set of objects specified by the file, must be bounded by <model></model> XML tags without unnecessary\n"\
-"       attributes or nested definitions.\n"\
-" output_binary_file specifies a path to the output binary file.\n"\
+"       attributes or nested definitions. Any input file can also be a precompiled model (see --precompile) made for the same domain.\n"\
+" output_binary_file specifies a path to the output binary file. If several domains are specified, an output binary file is specified\n"\
+"       for each of them in the order of the --domain parameters.\n"\
 " --help displays this message.\n";
 
 int main(int argc, char** argv)
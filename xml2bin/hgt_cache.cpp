@@ -0,0 +1,315 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <list>
+#include <random>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include "hgt_cache.h"
+#include <content_hash.h>
+
+//Layout of a cache entry: HGT_CACHE_MAGIC, HGT_CACHE_FORMAT_VERSION, the identity of the entry (see hgt_cache_identity), min height
+//(int16), max height (int16), poly count (uint32), positions of the poly objects relative to the HGT section (2 x uint64), their
+//surfaces (2 x uint32), face and vertex counts (2 x uint64), size of the HGT section in bytes (uint64) followed by the HGT section itself
+static constexpr char HGT_CACHE_MAGIC[4] = {'H', 'G', 'T', 'C'};
+static constexpr std::uint32_t HGT_CACHE_FORMAT_VERSION = 4;
+//key (uint64), size of the HGT data in bytes (uint64), HGT_OPTIMIZER_VERSION (uint32), columns and rows (2 x uint64), dx and dy
+//(2 x double), indexed faces (uint32), height tolerance and detail radius (2 x double)
+static constexpr std::size_t HGT_CACHE_IDENTITY_SIZE = 2 * sizeof(std::uint64_t) + sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t) 
+	+ 2 * sizeof(double) + sizeof(std::uint32_t) + 2 * sizeof(double);
+static constexpr std::size_t HGT_CACHE_STATS_OFFSET = sizeof(HGT_CACHE_MAGIC) + sizeof(std::uint32_t) + HGT_CACHE_IDENTITY_SIZE;
+static constexpr std::size_t HGT_CACHE_HEADER_SIZE = HGT_CACHE_STATS_OFFSET + 2 * sizeof(std::int16_t) + sizeof(std::uint32_t) 
+	+ 2 * (sizeof(std::uint64_t) + sizeof(std::uint32_t)) + 2 * sizeof(std::uint64_t) + sizeof(std::uint64_t);
+static constexpr std::size_t HGT_CACHE_COPY_BLOCK = std::size_t(1) << 20;
+
+class hgt_cache_hash:public content_hash
+{
+public:
+	using content_hash::add;
+	hgt_cache_hash& add(const domain_data_map& domain_data) noexcept
+	{
+		this->add(std::uint32_t(domain_data.size()));
+		for (auto& prDomain:domain_data)
+		{
+			this->add(std::uint32_t(prDomain.first.size())).add(prDomain.first.data(), prDomain.first.size());
+			this->add(std::uint32_t(prDomain.second.size())).add(prDomain.second.data(), prDomain.second.size());
+		}
+		return *this;
+	}
+};
+
+//Forwards the HGT section to the output stream and to the cache entry being created. Positions are those of the output stream.
+class hgt_cache_recorder:public binary_ostream
+{
+	binary_ostream* m_pOs;
+	binary_ostream* m_pCache;
+	pos_type m_os_base; //position of the HGT section in the output stream
+	pos_type m_cache_base; //position of the HGT section in the cache entry
+public:
+	hgt_cache_recorder(binary_ostream& os, binary_ostream& cache)
+		:m_pOs(&os), m_pCache(&cache), m_os_base(os.tellp()), m_cache_base(cache.tellp()) {}
+	hgt_cache_recorder& write(const void* pInput, std::size_t cbHowMany)
+	{
+		m_pOs->write(pInput, cbHowMany);
+		m_pCache->write(pInput, cbHowMany);
+		return *this;
+	}
+	pos_type tellp() const
+	{
+		return m_pOs->tellp();
+	}
+	hgt_cache_recorder& seekp(pos_type pos)
+	{
+		m_pOs->seekp(pos);
+		m_pCache->seekp(pos - m_os_base + m_cache_base);
+		return *this;
+	}
+	hgt_cache_recorder& seekp(std::ptrdiff_t off, std::ios_base::seekdir dir)
+	{
+		m_pOs->seekp(off, dir);
+		if (dir == std::ios_base::beg)
+			m_pCache->seekp(pos_type(off) - m_os_base + m_cache_base);
+		else
+			m_pCache->seekp(off, dir); //both streams end with the HGT section
+		return *this;
+	}
+};
+
+//The key only names the entry. The rest of the parameters hashed into it are stored in the entry as well and compared before the
+//entry is used, so that neither a collision of the keys nor an entry written by another version of the optimizer is mistaken for
+//the conversion of the HGT data.
+struct hgt_cache_identity
+{
+	std::uint64_t key;
+	std::uint64_t cbData;
+	std::uint32_t optimizer_version;
+	std::uint64_t cColumns;
+	std::uint64_t cRows;
+	double dx;
+	double dy;
+	std::uint32_t fIndexedFaces;
+	double eHeightTolerance;
+	double eDetailRadius;
+
+	bool operator==(const hgt_cache_identity& right) const
+	{
+		return key == right.key && cbData == right.cbData && optimizer_version == right.optimizer_version && cColumns == right.cColumns 
+			&& cRows == right.cRows && dx == right.dx && dy == right.dy && fIndexedFaces == right.fIndexedFaces 
+			&& eHeightTolerance == right.eHeightTolerance && eDetailRadius == right.eDetailRadius;
+	}
+	void write(binary_ostream& os) const
+	{
+		os << key << cbData << optimizer_version << cColumns << cRows << dx << dy << fIndexedFaces << eHeightTolerance << eDetailRadius;
+	}
+	static hgt_cache_identity read(const char* pIdentity) noexcept
+	{
+		hgt_cache_identity identity;
+		std::memcpy(&identity.key, pIdentity, sizeof(identity.key)); pIdentity += sizeof(identity.key);
+		std::memcpy(&identity.cbData, pIdentity, sizeof(identity.cbData)); pIdentity += sizeof(identity.cbData);
+		std::memcpy(&identity.optimizer_version, pIdentity, sizeof(identity.optimizer_version)); pIdentity += sizeof(identity.optimizer_version);
+		std::memcpy(&identity.cColumns, pIdentity, sizeof(identity.cColumns)); pIdentity += sizeof(identity.cColumns);
+		std::memcpy(&identity.cRows, pIdentity, sizeof(identity.cRows)); pIdentity += sizeof(identity.cRows);
+		std::memcpy(&identity.dx, pIdentity, sizeof(identity.dx)); pIdentity += sizeof(identity.dx);
+		std::memcpy(&identity.dy, pIdentity, sizeof(identity.dy)); pIdentity += sizeof(identity.dy);
+		std::memcpy(&identity.fIndexedFaces, pIdentity, sizeof(identity.fIndexedFaces)); pIdentity += sizeof(identity.fIndexedFaces);
+		std::memcpy(&identity.eHeightTolerance, pIdentity, sizeof(identity.eHeightTolerance)); pIdentity += sizeof(identity.eHeightTolerance);
+		std::memcpy(&identity.eDetailRadius, pIdentity, sizeof(identity.eDetailRadius));
+		return identity;
+	}
+};
+
+static std::uint64_t hgt_data_size(std::istream& is_data)
+{
+	is_data.clear();
+	is_data.seekg(0, std::ios_base::end);
+	auto cbData = std::uint64_t(std::streamoff(is_data.tellg()));
+	is_data.seekg(0, std::ios_base::beg);
+	return cbData;
+}
+
+static hgt_cache_identity make_hgt_cache_identity(const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, const std::vector<HGT_DETAIL_AREA>& detail_areas, 
+	std::istream& is_data, IDomainConverter& converter)
+{
+	hgt_cache_hash hash;
+	hash.add(HGT_OPTIMIZER_VERSION).add(is_data);
+	hash.add(resolution.dx).add(resolution.dy).add(std::uint64_t(resolution.cColumns)).add(std::uint64_t(resolution.cRows));
+	hash.add(options.fIndexedFaces).add(options.eHeightTolerance);
+	if (options.eHeightTolerance > 0 && options.eDetailRadius > 0)
+	{
+		hash.add(options.eDetailRadius).add(std::uint64_t(detail_areas.size()));
+		for (auto& area:detail_areas)
+			hash.add(area.x_min).add(area.y_min).add(area.x_max).add(area.y_max);
+	}
+	for (auto id:{ConstantDomainDataId::SurfaceLand, ConstantDomainDataId::SurfaceWater})
+		hash.add(converter.constant_poly_domain_data(id)).add(converter.constant_face_domain_data(id));
+	auto eDetailRadius = options.eHeightTolerance > 0?options.eDetailRadius:0.0;
+	return hgt_cache_identity{hash.value(), hgt_data_size(is_data), HGT_OPTIMIZER_VERSION, std::uint64_t(resolution.cColumns), std::uint64_t(resolution.cRows),
+		resolution.dx, resolution.dy, std::uint32_t(options.fIndexedFaces), options.eHeightTolerance, eDetailRadius};
+}
+
+static std::string hgt_cache_entry_path(const std::string& strDirectory, std::uint64_t key)
+{
+	static constexpr char digits[] = "0123456789abcdef";
+	auto strPath = strDirectory;
+	if (!strPath.empty() && strPath.back() != '/' && strPath.back() != '\\')
+		strPath.push_back('/');
+	for (int iShift = 60; iShift >= 0; iShift -= 4)
+		strPath.push_back(digits[(key >> iShift) & 0xF]);
+	return strPath + ".hgtcache";
+}
+
+//returns false, if there is no valid entry of the identity
+static bool read_hgt_cache_entry(const std::string& strPath, const hgt_cache_identity& identity, binary_ostream& os, HGT_CONVERSION_STATS& stats)
+{
+	std::ifstream is(strPath, std::ios_base::in | std::ios_base::binary);
+	if (!is)
+		return false;
+	char header[HGT_CACHE_HEADER_SIZE];
+	if (!is.read(header, sizeof(header)))
+		return false;
+	std::uint32_t format_version;
+	std::uint64_t cbSection;
+	std::int16_t min_height, max_height;
+	std::uint32_t poly_count;
+	std::uint64_t object_pos[2];
+	std::uint32_t object_surface[2];
+	std::uint64_t face_count, vertex_count;
+	auto pHeader = header + sizeof(HGT_CACHE_MAGIC);
+	std::memcpy(&format_version, pHeader, sizeof(format_version)); pHeader += sizeof(format_version);
+	auto entry_identity = hgt_cache_identity::read(pHeader); pHeader += HGT_CACHE_IDENTITY_SIZE;
+	std::memcpy(&min_height, pHeader, sizeof(min_height)); pHeader += sizeof(min_height);
+	std::memcpy(&max_height, pHeader, sizeof(max_height)); pHeader += sizeof(max_height);
+	std::memcpy(&poly_count, pHeader, sizeof(poly_count)); pHeader += sizeof(poly_count);
+	std::memcpy(object_pos, pHeader, sizeof(object_pos)); pHeader += sizeof(object_pos);
+	std::memcpy(object_surface, pHeader, sizeof(object_surface)); pHeader += sizeof(object_surface);
+	std::memcpy(&face_count, pHeader, sizeof(face_count)); pHeader += sizeof(face_count);
+	std::memcpy(&vertex_count, pHeader, sizeof(vertex_count)); pHeader += sizeof(vertex_count);
+	std::memcpy(&cbSection, pHeader, sizeof(cbSection));
+	if (std::memcmp(header, HGT_CACHE_MAGIC, sizeof(HGT_CACHE_MAGIC)) != 0 || format_version != HGT_CACHE_FORMAT_VERSION || !(entry_identity == identity) 
+		|| poly_count > std::size(object_pos))
+		return false;
+	is.seekg(0, std::ios_base::end);
+	if (std::uint64_t(std::streamoff(is.tellg())) != HGT_CACHE_HEADER_SIZE + cbSection)
+		return false; //incomplete entry
+	is.seekg(HGT_CACHE_HEADER_SIZE, std::ios_base::beg);
+	stats = HGT_CONVERSION_STATS{min_height, max_height, poly_count};
+	stats.face_count = face_count;
+	stats.vertex_count = vertex_count;
+	stats.cached = true;
+	auto section_pos = std::uint64_t(os.tellp());
+	for (std::uint32_t iObject = 0; iObject < poly_count; ++iObject)
+	{
+		stats.object_pos[iObject] = section_pos + object_pos[iObject];
+		stats.object_surface[iObject] = ConstantDomainDataId(object_surface[iObject]);
+	}
+	auto pBuf = std::make_unique<char[]>(HGT_CACHE_COPY_BLOCK);
+	while (cbSection != 0)
+	{
+		auto cbBlock = std::size_t(std::min(cbSection, std::uint64_t(HGT_CACHE_COPY_BLOCK)));
+		if (!is.read(pBuf.get(), cbBlock))
+			throw std::runtime_error("Failed to read the HGT cache entry \"" + strPath + "\"");
+		os.write(pBuf.get(), cbBlock);
+		cbSection -= cbBlock;
+	}
+	return true;
+}
+
+//completes the header of the entry, the HGT section of which starts at section_pos in the output stream. Returns false, if the
+//entry could not be written.
+static bool finish_hgt_cache_entry(binary_ofstream& cache, const HGT_CONVERSION_STATS& stats, std::uint64_t section_pos)
+{
+	cache.seekp(0, std::ios_base::end);
+	auto cbSection = std::uint64_t(cache.tellp() - HGT_CACHE_HEADER_SIZE);
+	cache.seekp(HGT_CACHE_STATS_OFFSET);
+	cache << std::int16_t(stats.min_height) << std::int16_t(stats.max_height) << std::uint32_t(stats.poly_count);
+	for (unsigned iObject = 0; iObject < std::size(stats.object_pos); ++iObject)
+		cache << (iObject < stats.poly_count?stats.object_pos[iObject] - section_pos:std::uint64_t(0));
+	for (unsigned iObject = 0; iObject < std::size(stats.object_surface); ++iObject)
+		cache << (iObject < stats.poly_count?std::uint32_t(stats.object_surface[iObject]):std::uint32_t(0));
+	cache << stats.face_count << stats.vertex_count << cbSection;
+	return !cache.fail();
+}
+
+//The HGT data are converted once for all outputs, and an entry is created for each of them. The entries are written to temporary
+//files first and renamed afterwards, so that concurrent conversions never see incomplete entries.
+static std::vector<HGT_CONVERSION_STATS> create_hgt_cache_entries(const std::vector<std::string>& vPaths, const std::vector<hgt_cache_identity>& vIdentities, 
+	const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, const std::vector<HGT_DETAIL_AREA>& detail_areas, std::istream& is_data, 
+	const std::vector<HGT_OUTPUT>& outputs)
+{
+	std::vector<std::string> vTempPaths;
+	for (auto& strPath:vPaths)
+		vTempPaths.emplace_back(strPath + '.' + std::to_string(std::random_device()()) + ".tmp");
+	std::vector<HGT_CONVERSION_STATS> vStats;
+	std::vector<char> vComplete;
+	try
+	{
+		std::list<binary_ofstream> lstCache;
+		std::list<hgt_cache_recorder> lstRecorders;
+		std::vector<HGT_OUTPUT> recorded_outputs;
+		std::vector<std::uint64_t> vSectionPos;
+		for (std::size_t iOutput = 0; iOutput < outputs.size(); ++iOutput)
+		{
+			auto& cache = lstCache.emplace_back(vTempPaths[iOutput], true);
+			if (cache.fail())
+				throw std::runtime_error("Failed to create an entry in the HGT cache directory \"" + options.strCacheDirectory + "\"");
+			cache.write(HGT_CACHE_MAGIC, sizeof(HGT_CACHE_MAGIC));
+			cache << HGT_CACHE_FORMAT_VERSION;
+			vIdentities[iOutput].write(cache);
+			cache.seekp(HGT_CACHE_HEADER_SIZE);
+			vSectionPos.emplace_back(std::uint64_t(outputs[iOutput].pOs->tellp()));
+			recorded_outputs.emplace_back(HGT_OUTPUT{outputs[iOutput].pConverter, &lstRecorders.emplace_back(*outputs[iOutput].pOs, cache)});
+		}
+		vStats = convert_hgt(resolution, options, detail_areas, is_data, recorded_outputs);
+		auto itCache = lstCache.begin();
+		for (std::size_t iOutput = 0; iOutput < outputs.size(); ++iOutput, ++itCache)
+			vComplete.emplace_back(finish_hgt_cache_entry(*itCache, vStats[iOutput], vSectionPos[iOutput]));
+	}catch (...)
+	{
+		for (auto& strTempPath:vTempPaths)
+			std::remove(strTempPath.c_str());
+		throw;
+	}
+	for (std::size_t iOutput = 0; iOutput < outputs.size(); ++iOutput)
+	{
+		if (!vComplete[iOutput] || std::rename(vTempPaths[iOutput].c_str(), vPaths[iOutput].c_str()) != 0)
+			std::remove(vTempPaths[iOutput].c_str()); //the cache is an optimization, the output is complete anyway
+	}
+	return vStats;
+}
+
+HGT_CONVERSION_STATS convert_hgt_cached(const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, const std::vector<HGT_DETAIL_AREA>& detail_areas, 
+	std::istream& is_data, IDomainConverter& converter, binary_ostream& os)
+{
+	return convert_hgt_cached(resolution, options, detail_areas, is_data, std::vector<HGT_OUTPUT>{HGT_OUTPUT{&converter, &os}}).front();
+}
+
+std::vector<HGT_CONVERSION_STATS> convert_hgt_cached(const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, 
+	const std::vector<HGT_DETAIL_AREA>& detail_areas, std::istream& is_data, const std::vector<HGT_OUTPUT>& outputs)
+{
+	if (options.strCacheDirectory.empty())
+		return convert_hgt(resolution, options, detail_areas, is_data, outputs);
+	std::vector<HGT_CONVERSION_STATS> vStats(outputs.size());
+	std::vector<std::size_t> vMissed; //indices of the outputs without an entry in the cache
+	std::vector<std::string> vPaths;
+	std::vector<hgt_cache_identity> vIdentities;
+	std::vector<HGT_OUTPUT> missed_outputs;
+	for (std::size_t iOutput = 0; iOutput < outputs.size(); ++iOutput)
+	{
+		auto identity = make_hgt_cache_identity(resolution, options, detail_areas, is_data, *outputs[iOutput].pConverter);
+		auto strPath = hgt_cache_entry_path(options.strCacheDirectory, identity.key);
+		if (read_hgt_cache_entry(strPath, identity, *outputs[iOutput].pOs, vStats[iOutput]))
+			continue;
+		vMissed.emplace_back(iOutput);
+		vPaths.emplace_back(std::move(strPath));
+		vIdentities.emplace_back(identity);
+		missed_outputs.emplace_back(outputs[iOutput]);
+	}
+	if (vMissed.empty())
+		return vStats;
+	auto vConverted = create_hgt_cache_entries(vPaths, vIdentities, resolution, options, detail_areas, is_data, missed_outputs);
+	for (std::size_t iMissed = 0; iMissed < vMissed.size(); ++iMissed)
+		vStats[vMissed[iMissed]] = std::move(vConverted[iMissed]);
+	return vStats;
+}
@@ -0,0 +1,25 @@
+#include <cstdint>
+#include <istream>
+#include <vector>
+#include <binary_streams.h>
+#include "xml2bin.h"
+#include "domain_converter.h"
+#include "hgt_optimizer.h"
+
+#ifndef XML2BIN_HGTCACHE_H_
+#define XML2BIN_HGTCACHE_H_
+
+//Same as convert_hgt, but if HGT_CONVERSION_OPTIONS::strCacheDirectory is set, the HGT section of the output (the land and water
+//poly objects) is copied from the persistent cache, if it is there, or stored in the cache after the conversion otherwise. Cache
+//entries are keyed by a hash of the HGT data, the resolution, HGT_OPTIMIZER_VERSION, the options affecting the output and the
+//constant domain data of the converter. The size of the HGT data, the resolution, HGT_OPTIMIZER_VERSION and the options are stored in
+//the entry as well, and an entry differing in any of them is converted again instead of copied.
+HGT_CONVERSION_STATS convert_hgt_cached(const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, const std::vector<HGT_DETAIL_AREA>& detail_areas, 
+	std::istream& is_data, IDomainConverter& converter, binary_ostream& os);
+
+//Same as above for several outputs, each of which is looked up in the cache separately. The HGT data are converted once for all
+//outputs missing in the cache.
+std::vector<HGT_CONVERSION_STATS> convert_hgt_cached(const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, 
+	const std::vector<HGT_DETAIL_AREA>& detail_areas, std::istream& is_data, const std::vector<HGT_OUTPUT>& outputs);
+
+#endif //XML2BIN_HGTCACHE_H_
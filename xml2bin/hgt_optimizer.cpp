@@ -10,10 +10,14 @@
 #include <future>
 #include <atomic>
 #include <cmath>
+#include <limits>
+#include <cstring>
+#include <chrono>
 #include <basedefs.h>
 #include <face.h>
 #include "hgt_optimizer.h"
 #include <binary_streams.h>
+#include <report_format.h>
 
 namespace CAMaaS
 {
@@ -53,63 +57,49 @@ inline static bool SameDomainData(const FaceType& left, const FaceType& right)
 }
 //inline static bool SameDomainData(const Face& left, const Face& right);
 
+//splits [0, cItems) into hardware_concurrency() contiguous blocks and calls func(iBegin, iEnd) for each of them in a separate thread
+template <class Function>
+static void process_blocks_in_parallel(unsigned cItems, Function&& func)
+{
+	auto cBlocks = std::max(std::thread::hardware_concurrency(), 1u);
+	auto cBlock = (cItems + cBlocks - 1) / cBlocks;
+	std::list<std::thread> threads;
+	for (unsigned iBlock = 0; iBlock < cBlocks && iBlock * cBlock < cItems; ++iBlock)
+	{
+		threads.emplace_back([&func, iBlock, cBlock, cItems]() -> void
+		{
+			func(iBlock * cBlock, std::min((iBlock + 1) * cBlock, cItems));
+		});
+	}
+	for (auto& thr:threads)
+		thr.join();
+}
+
 class Matrix
 {
 	short* m_points = nullptr;
 	std::unique_ptr<std::int8_t[]> m_pVertexStatus;
 	unsigned short m_cColumns = 0, m_cRows = 0;
 	double m_eColumnResolution = 0, m_eRowResolution = 0;
+	static constexpr unsigned short NO_VALID_HEIGHT = std::numeric_limits<unsigned short>::max();
 public:
 	Matrix() = default;
 	Matrix(short* pPoints, unsigned short cColumns, unsigned short cRows, double eColumnResolution, double eRowResolution)
 		:m_points(pPoints), m_pVertexStatus(std::make_unique<std::int8_t[]>(std::size_t(cColumns) * cRows)), 
 		m_cColumns(cColumns), m_cRows(cRows), m_eColumnResolution(eColumnResolution), m_eRowResolution(eRowResolution) 
 	{
-		auto cBlocks = std::thread::hardware_concurrency();
 		auto cItemsTotal = unsigned(cColumns) * cRows;
-		auto cBlock = (cItemsTotal + cBlocks - 1) / cBlocks;
-		std::list<std::thread> threads;
-		std::atomic<unsigned> fence_1(unsigned(0)), fence_2(unsigned(0));
-
-		for (unsigned iThread = 0; iThread < cBlocks; ++iThread)
+		process_blocks_in_parallel(cItemsTotal, [this](unsigned iBegin, unsigned iEnd) -> void
 		{
-			threads.emplace_back([this, iThread, cBlock, cBlocks, cItemsTotal, &fence_1, &fence_2]() -> void
-			{
-				auto iBegin = iThread * cBlock;
-				auto iEnd = std::min((iThread + 1) * cBlock, cItemsTotal);
-				for (auto iElement = iBegin; iElement < iEnd; ++iElement)
-					m_points[iElement] = height_data_bswap(iElement);
-				if (fence_1.fetch_add(1, std::memory_order_acq_rel) + 1 < cBlocks)
-					do {std::this_thread::yield();} while (fence_1.load(std::memory_order_acquire) < cBlocks);
-				std::unique_ptr<short[]> pBuf;
-				unsigned buf_begin;
-				{
-					for (auto iElement = iBegin; iElement < iEnd; ++iElement)
-					{
-						if (m_points[iElement] < MIN_VALID_HGT_VALUE)
-						{
-							pBuf = std::make_unique<short[]>(std::size_t(iEnd - iElement));
-							std::memcpy(pBuf.get(), &m_points[iElement], std::size_t(iEnd - iElement) * sizeof(short));
-							buf_begin = iElement;
-							do
-							{
-								pBuf[iElement - buf_begin] = average_invalid_height(iElement);
-							}while (++iElement < iEnd);
-						}
-					}
-				}
-				if (fence_2.fetch_add(1, std::memory_order_acq_rel) + 1 < cBlocks)
-					do {std::this_thread::yield();} while (fence_2.load(std::memory_order_acquire) < cBlocks);
-				if (bool(pBuf))
-					std::memcpy(&m_points[buf_begin], pBuf.get(), std::size_t(iEnd - buf_begin) * sizeof(short));
-				if (fence_1.fetch_sub(1, std::memory_order_acq_rel) - 1 > 0)
-					do {std::this_thread::yield();} while (fence_1.load(std::memory_order_acquire) > 0);
-				for (auto iElement = iThread * cBlock; iElement < iEnd; ++iElement)
-					m_pVertexStatus[iElement] = this->is_empty_point_no_cache(iElement);
-			});
-		}
-		for (auto& thr:threads)
-			thr.join();
+			for (auto iElement = iBegin; iElement < iEnd; ++iElement)
+				m_points[iElement] = height_data_bswap(iElement);
+		});
+		this->fill_invalid_heights();
+		process_blocks_in_parallel(cItemsTotal, [this](unsigned iBegin, unsigned iEnd) -> void
+		{
+			for (auto iElement = iBegin; iElement < iEnd; ++iElement)
+				m_pVertexStatus[iElement] = this->is_empty_point_no_cache(iElement);
+		});
 	}
 	inline unsigned short columns() const noexcept
 	{
@@ -200,58 +190,106 @@ private:
 	{
 		return bswap(m_points[point_index]);
 	}
-	short average_invalid_height(unsigned point_index) const
+	static constexpr bool is_valid_height(short height) noexcept
 	{
-		unsigned short cl, cr;
-		short vl = short(), vr = short();
-		unsigned short rt, rb;
-		short vt = short(), vb = short();
-		auto col = this->point_x(point_index);
-		auto row = this->point_y(point_index);
-		for (cr = col + 1; cr < this->columns(); ++cr)
+		return height >= MIN_VALID_HGT_VALUE;
+	}
+	//Replaces heights of the voids (points with heights below MIN_VALID_HGT_VALUE) by the heights interpolated between the nearest valid
+	//points in the same row and in the same column. The nearest valid points are found by linear scans: one pass over column blocks
+	//(rows above and below) followed by one pass over rows (columns to the left and to the right), where the voids are replaced.
+	//Valid points are never modified, therefore reading them from different threads is safe.
+	void fill_invalid_heights()
+	{
+		auto cItemsTotal = std::size_t(this->columns()) * this->rows();
+		auto pTop = std::make_unique<unsigned short[]>(cItemsTotal);
+		auto pBottom = std::make_unique<unsigned short[]>(cItemsTotal);
+		process_blocks_in_parallel(this->columns(), [this, &pTop, &pBottom](unsigned col_begin, unsigned col_end) -> void
 		{
-			if (m_points[point_index + cr - col] >= MIN_VALID_HGT_VALUE)
+			std::vector<unsigned short> vLastValid(col_end - col_begin, NO_VALID_HEIGHT);
+			for (unsigned row = 0; row < this->rows(); ++row)
 			{
-				vr = m_points[point_index + cr - col];
-				break;
+				for (auto col = col_begin; col < col_end; ++col)
+				{
+					auto index = this->locate(col, row);
+					if (is_valid_height(m_points[index]))
+						vLastValid[col - col_begin] = row;
+					else
+						pTop[index] = vLastValid[col - col_begin];
+				}
 			}
-		}
-		for (cl = 1; cl <= col; ++cl)
-		{
-			if (m_points[point_index - cl] >= MIN_VALID_HGT_VALUE)
+			std::fill(vLastValid.begin(), vLastValid.end(), NO_VALID_HEIGHT);
+			for (unsigned row = this->rows(); row-- > 0; )
 			{
-				cl = point_index - cl;
-				vl = m_points[cl];
-				break;
+				for (auto col = col_begin; col < col_end; ++col)
+				{
+					auto index = this->locate(col, row);
+					if (is_valid_height(m_points[index]))
+						vLastValid[col - col_begin] = row;
+					else
+						pBottom[index] = vLastValid[col - col_begin];
+				}
 			}
-		}
-
-		for (rb = row + 1; rb < this->rows(); ++rb)
+		});
+		process_blocks_in_parallel(this->rows(), [this, &pTop, &pBottom](unsigned row_begin, unsigned row_end) -> void
 		{
-			if (this->point_z(col, rb) >= MIN_VALID_HGT_VALUE)
+			std::vector<unsigned short> vRight(this->columns());
+			for (auto row = row_begin; row < row_end; ++row)
 			{
-				vb = this->point_z(col, rb);
-				break;
+				auto next_valid = NO_VALID_HEIGHT;
+				for (unsigned col = this->columns(); col-- > 0; )
+				{
+					if (is_valid_height(this->point_z(col, row)))
+						next_valid = col;
+					else
+						vRight[col] = next_valid;
+				}
+				auto prev_valid = NO_VALID_HEIGHT;
+				for (unsigned col = 0; col < this->columns(); ++col)
+				{
+					auto index = this->locate(col, row);
+					if (is_valid_height(m_points[index]))
+						prev_valid = col;
+					else
+						m_points[index] = this->average_invalid_height(col, row, prev_valid, vRight[col], pTop[index], pBottom[index]);
+				}
 			}
-		}
-		for (rt = 1; rt <= row; ++rt)
+		});
+	}
+	//cl, cr, rt and rb are the columns and rows of the nearest valid points to the left, to the right, at the top and at the bottom
+	//of the point (col, row) respectively, or NO_VALID_HEIGHT if there is no such point.
+	short average_invalid_height(unsigned short col, unsigned short row, unsigned short cl, unsigned short cr, unsigned short rt, unsigned short rb) const
+	{
+		bool fHorizontal = cl != NO_VALID_HEIGHT && cr != NO_VALID_HEIGHT;
+		bool fVertical = rt != NO_VALID_HEIGHT && rb != NO_VALID_HEIGHT;
+		double eHorizontal = 0, eVertical = 0;
+		if (fHorizontal)
 		{
-			if (this->point_z(col, row - rt) >= MIN_VALID_HGT_VALUE)
-			{
-				rt = row - rt;
-				vt = this->point_z(col, rt);
-				break;
-			}
+			short vl = this->point_z(cl, row), vr = this->point_z(cr, row);
+			eHorizontal = double(vr - vl) / double(cr - cl) * (col - cl) + vl;
 		}
-		double eAve;
-		if (cr > cl)
+		if (fVertical)
 		{
-			eAve = double(vr - vl) / double(cr - cl) * (col - cl) + vl;
-			if (rb > rt)
-				return short((eAve + double(vb - vt) / double(rb - rt) * (row - rt) + vt) / 2);
-			return short(eAve);
+			short vt = this->point_z(col, rt), vb = this->point_z(col, rb);
+			eVertical = double(vb - vt) / double(rb - rt) * (row - rt) + vt;
 		}
-		return short(double(vb - vt) / double(rb - rt) * (row - rt) + vt);
+		if (fHorizontal && fVertical)
+			return short((eHorizontal + eVertical) / 2);
+		if (fHorizontal)
+			return short(eHorizontal);
+		if (fVertical)
+			return short(eVertical);
+		//a void touches the border of the raster: take the nearest valid point, if any
+		unsigned distance = std::numeric_limits<unsigned>::max();
+		short height = short();
+		if (cl != NO_VALID_HEIGHT && unsigned(col - cl) < distance)
+			std::tie(distance, height) = std::make_tuple(unsigned(col - cl), this->point_z(cl, row));
+		if (cr != NO_VALID_HEIGHT && unsigned(cr - col) < distance)
+			std::tie(distance, height) = std::make_tuple(unsigned(cr - col), this->point_z(cr, row));
+		if (rt != NO_VALID_HEIGHT && unsigned(row - rt) < distance)
+			std::tie(distance, height) = std::make_tuple(unsigned(row - rt), this->point_z(col, rt));
+		if (rb != NO_VALID_HEIGHT && unsigned(rb - row) < distance)
+			std::tie(distance, height) = std::make_tuple(unsigned(rb - row), this->point_z(col, rb));
+		return height;
 	}
 };
 
@@ -526,6 +564,7 @@ struct vertex_converting_iterator
 	vertex_converting_iterator& operator++()
 	{
 		++m_it;
+		m_fLastVal = false;
 		return *this;
 	}
 	vertex_converting_iterator operator++(int)
@@ -1309,103 +1348,196 @@ FaceSet parse_matrix(unsigned start_element /*= 0*/, unsigned end_element /*= g_
 	return set;
 }
 
-#include <ostream>
-
-static std::atomic_flag g_run = ATOMIC_FLAG_INIT;
-
-static unsigned convert_hgt_to_index_based_face(binary_ostream& os, short* pInput, unsigned short cColumns, unsigned short cRows, double eColumnResolution, double eRowResolution)
+//Right-triangulated irregular network (RTIN) over g_matrix. The matrix is embedded into a square grid of 2^k + 1 points which is
+//recursively split into right isosceles triangles at the middles of their hypotenuses. The error of a triangle is the maximal
+//vertical deviation of the matrix points covered by the triangle from its plane relative to the tolerance of the triangle,
+//accumulated over all nested triangles. A triangle is split if its error exceeds 1. Triangles sharing a hypotenuse accumulate their
+//errors in the same element, therefore they are split together and the resulting surface has no T-junctions even if the tolerance
+//varies over the matrix. Triangles crossing the matrix border have an infinite error and are always split.
+class RtinTriangulation
 {
-	std::list<std::future<FaceSet>> futures;
-	while (g_run.test_and_set(std::memory_order_acquire))
-		continue;
-	g_matrix = Matrix(pInput, cColumns, cRows, eColumnResolution, eRowResolution);
-	//auto cBlocks = unsigned(1);
-	auto cBlocks = unsigned(std::thread::hardware_concurrency());
-	auto cItemsTotal = unsigned(cColumns) * cRows;
-	auto cBlock = (cItemsTotal + cBlocks - 1) / cBlocks;
-	for (unsigned i = 0; i < cBlocks; ++i)
-		futures.emplace_back(std::async(std::launch::async, [i, cBlock, cItemsTotal]() -> auto
-		{
-			return parse_matrix(i * cBlock, std::min((i + 1) * cBlock, cItemsTotal));
-		}));
-	unsigned face_count = 0;
-	auto face_count_pos = os.tellp();
-	os.seekp(sizeof(unsigned), std::ios_base::cur);
-	for (auto& fut:futures)
+	struct Triangle
+	{
+		unsigned ax, ay, bx, by; //ends of the hypotenuse
+		unsigned cx, cy; //vertex with the right angle
+	};
+	unsigned m_cTile; //the grid has m_cTile + 1 points along each axis
+	std::vector<float> m_vErrors;
+
+	inline unsigned last_column() const noexcept
+	{
+		return unsigned(g_matrix.columns()) - 1;
+	}
+	inline unsigned last_row() const noexcept
+	{
+		return unsigned(g_matrix.rows()) - 1;
+	}
+	inline float& error(unsigned col, unsigned row) noexcept
 	{
-		auto set = fut.get();
-		face_count += unsigned(set.size());
-		for (const auto& face:set)
+		return m_vErrors[std::size_t(row) * (m_cTile + 1) + col];
+	}
+	inline float error(unsigned col, unsigned row) const noexcept
+	{
+		return m_vErrors[std::size_t(row) * (m_cTile + 1) + col];
+	}
+	inline bool is_outside(const Triangle& t) const noexcept
+	{
+		return std::min({t.ax, t.bx, t.cx}) >= this->last_column() || std::min({t.ay, t.by, t.cy}) >= this->last_row();
+	}
+	inline bool is_crossing_border(const Triangle& t) const noexcept
+	{
+		return std::max({t.ax, t.bx, t.cx}) > this->last_column() || std::max({t.ay, t.by, t.cy}) > this->last_row();
+	}
+	//the triangles are enumerated as nodes of a binary tree: 2 and 3 are the two halves of the grid, 2 * id and 2 * id + 1 are the
+	//halves of the triangle id, so that the triangles of a level with cLevel triangles have ids in [cLevel, 2 * cLevel)
+	Triangle root(std::size_t id) const noexcept
+	{
+		if (id == 2)
+			return Triangle{m_cTile, m_cTile, 0, 0, 0, m_cTile};
+		return Triangle{0, 0, m_cTile, m_cTile, m_cTile, 0};
+	}
+	static Triangle child(const Triangle& t, std::size_t id) noexcept
+	{
+		auto mx = (t.ax + t.bx) / 2, my = (t.ay + t.by) / 2;
+		if (id & 1)
+			return Triangle{t.cx, t.cy, t.ax, t.ay, mx, my};
+		return Triangle{t.bx, t.by, t.cx, t.cy, mx, my};
+	}
+	//calls func(id, t) for each triangle t of the level with cLevel triangles, which descends from the triangle t_parent with the
+	//specified id and is not outside the matrix
+	template <class Function>
+	void for_each_triangle(std::size_t id, const Triangle& t_parent, std::size_t cLevel, Function& func) const
+	{
+		if (this->is_outside(t_parent))
+			return;
+		if (id >= cLevel)
+			return func(id, t_parent);
+		this->for_each_triangle(2 * id, child(t_parent, 2 * id), cLevel, func);
+		this->for_each_triangle(2 * id + 1, child(t_parent, 2 * id + 1), cLevel, func);
+	}
+	template <class Function>
+	void for_each_triangle(std::size_t cLevel, Function&& func) const
+	{
+		this->for_each_triangle(2, this->root(2), cLevel, func);
+		this->for_each_triangle(3, this->root(3), cLevel, func);
+	}
+	float plane_deviation(const Triangle& t) const noexcept
+	{
+		auto za = double(g_matrix.point_z(t.ax, t.ay)), zb = double(g_matrix.point_z(t.bx, t.by)), zc = double(g_matrix.point_z(t.cx, t.cy));
+		auto ax = int(t.ax), ay = int(t.ay), bx = int(t.bx), by = int(t.by), cx = int(t.cx), cy = int(t.cy);
+		auto den = (by - cy) * (ax - cx) + (cx - bx) * (ay - cy);
+		double eDeviation = 0;
+		for (auto row = std::min({ay, by, cy}), max_row = std::max({ay, by, cy}); row <= max_row; ++row)
 		{
-			os << face.size();
-			for (auto pt:face)
-				os << g_matrix.point_x(pt) << g_matrix.point_y(pt) << g_matrix.point_z(pt);
+			for (auto col = std::min({ax, bx, cx}), max_col = std::max({ax, bx, cx}); col <= max_col; ++col)
+			{
+				auto wa = (by - cy) * (col - cx) + (cx - bx) * (row - cy);
+				auto wb = (cy - ay) * (col - cx) + (ax - cx) * (row - cy);
+				auto wc = den - wa - wb;
+				if (den > 0?wa < 0 || wb < 0 || wc < 0:wa > 0 || wb > 0 || wc > 0)
+					continue;
+				auto z = (wa * za + wb * zb + wc * zc) / den;
+				eDeviation = std::max(eDeviation, std::fabs(z - g_matrix.point_z((unsigned short) col, (unsigned short) row)));
+			}
 		}
+		return float(eDeviation);
+	}
+	//tolerance(min_col, min_row, max_col, max_row) returns the tolerance of the triangle with the specified bounding box
+	template <class ToleranceFunction>
+	float relative_error(const Triangle& t, ToleranceFunction& tolerance) const
+	{
+		if (this->is_crossing_border(t))
+			return std::numeric_limits<float>::infinity();
+		auto eDeviation = double(this->plane_deviation(t));
+		if (eDeviation == 0)
+			return 0;
+		auto eTolerance = tolerance(std::min({t.ax, t.bx, t.cx}), std::min({t.ay, t.by, t.cy}), std::max({t.ax, t.bx, t.cx}), std::max({t.ay, t.by, t.cy}));
+		if (eTolerance <= 0)
+			return std::numeric_limits<float>::infinity();
+		return float(eDeviation / eTolerance);
+	}
+	void add_triangle(FaceSet::Constructor& faces, const Triangle& t) const
+	{
+		//counterclockwise in the (column, row) plane, as the faces produced by parse_vertex
+		if (int(t.bx - t.ax) * int(t.cy - t.ay) - int(t.by - t.ay) * int(t.cx - t.ax) > 0)
+			faces.add_face(Face(g_matrix.locate(t.ax, t.ay), g_matrix.locate(t.bx, t.by), g_matrix.locate(t.cx, t.cy)));
+		else
+			faces.add_face(Face(g_matrix.locate(t.ax, t.ay), g_matrix.locate(t.cx, t.cy), g_matrix.locate(t.bx, t.by)));
 	}
-	g_run.clear(std::memory_order_release);
-	auto endp = os.tellp();
-	os.seekp(face_count_pos);
-	os << face_count;
-	os.seekp(endp);
-	return face_count;
-}
-
-
-
-//template <class Iterator>
-//void bswap_range(Iterator begin, Iterator end)
-//{
-//	for (auto it = begin; it != end; ++it)
-//		*it = bswap(*it);
-//}
-
-//static unsigned bswap_and_convert_hgt_to_index_based_face(binary_ostream& os, short* pInput, unsigned short cColumns, 
-//	unsigned short cRows, double eColumnResolution, double eRowResolution)
-//{
-//
-//	std::list<std::thread> threads;
-//	auto cBlocks = unsigned(std::thread::hardware_concurrency());
-//	auto cItemsTotal = unsigned(cColumns) * cRows;
-//	auto cBlock = (cItemsTotal + cBlocks - 1) / cBlocks;
-//	for (unsigned i = 0; i < cBlocks; ++i)
-//		threads.emplace_back([pInput, i, cBlock, cItemsTotal]() -> void
-//		{
-//			bswap_range(&pInput[i * cBlock], &pInput[std::min((i + 1) * cBlock, cItemsTotal)]);
-//		});
-//	for (auto& thr:threads)
-//		thr.join();
-//	return convert_hgt_to_index_based_face(os, pInput, cColumns, cRows, eColumnResolution, eRowResolution);
-//}
-
-#if FILESYSTEM_CPP17
-unsigned convert_hgt_to_index_based_face(std::filesystem::path input, std::filesystem::path output)
-{
-	auto os = binary_ofstream(output);
-	std::ifstream is(input, std::ios_base::in | std::ios_base::binary);
-	is.seekg(0, std::ios_base::end);
-	auto cb = is.tellg();
-	if (cb % sizeof(short) != 0)
-		throw std::invalid_argument("Unexpected HGT file size");
-	is.seekg(0, std::ios_base::beg);
-	switch (cb)
-	{
-	case HGT_1.cColumns * HGT_1.cRows * sizeof(short):
+	void triangulate(FaceSet::Constructor& faces, const Triangle& t) const
 	{
-		auto pInput = std::make_unique<short[]>(cb / sizeof(short));
-		is.read(reinterpret_cast<char*>(pInput.get()), cb);
-		return convert_hgt_to_index_based_face(os, pInput.get(), unsigned(HGT_1.cColumns), unsigned(HGT_1.cRows), HGT_1.dx, HGT_1.dy);
+		if (this->is_outside(t))
+			return;
+		auto mx = (t.ax + t.bx) / 2, my = (t.ay + t.by) / 2;
+		if ((t.ax > t.cx?t.ax - t.cx:t.cx - t.ax) + (t.ay > t.cy?t.ay - t.cy:t.cy - t.ay) > 1 && this->error(mx, my) > 1)
+		{
+			this->triangulate(faces, child(t, 0));
+			this->triangulate(faces, child(t, 1));
+		}else
+			this->add_triangle(faces, t);
 	}
-	case HGT_3.cColumns * HGT_3.cRows * sizeof(short):
+public:
+	template <class ToleranceFunction>
+	explicit RtinTriangulation(ToleranceFunction&& tolerance):m_cTile(1)
+	{
+		while (m_cTile < std::max(this->last_column(), this->last_row()))
+			m_cTile *= 2;
+		m_vErrors.resize(std::size_t(m_cTile + 1) * (m_cTile + 1));
+		//levels are processed from the smallest triangles: the triangles of a level do not overlap, so that their own errors are
+		//computed in parallel, and are merged with the errors of the neighbours and the children afterwards
+		auto cSmallest = std::size_t(m_cTile) * m_cTile;
+		for (auto cLevel = cSmallest; cLevel >= 2; cLevel /= 2)
+		{
+			std::vector<float> vLevelErrors(cLevel);
+			std::vector<std::pair<std::size_t, Triangle>> vSubtrees;
+			this->for_each_triangle(std::min(cLevel, std::size_t(64)), [&vSubtrees](std::size_t id, const Triangle& t) -> void
+			{
+				vSubtrees.emplace_back(id, t);
+			});
+			process_blocks_in_parallel(unsigned(vSubtrees.size()), [this, cLevel, &vSubtrees, &vLevelErrors, &tolerance](unsigned iBegin, unsigned iEnd) -> void
+			{
+				auto compute_error = [this, cLevel, &vLevelErrors, &tolerance](std::size_t id, const Triangle& t) -> void
+				{
+					vLevelErrors[id - cLevel] = this->relative_error(t, tolerance);
+				};
+				for (auto i = iBegin; i < iEnd; ++i)
+					this->for_each_triangle(vSubtrees[i].first, vSubtrees[i].second, cLevel, compute_error);
+			});
+			this->for_each_triangle(cLevel, [this, cLevel, cSmallest, &vLevelErrors](std::size_t id, const Triangle& t) -> void
+			{
+				auto& eError = this->error((t.ax + t.bx) / 2, (t.ay + t.by) / 2);
+				eError = std::max(eError, vLevelErrors[id - cLevel]);
+				if (cLevel < cSmallest)
+					eError = std::max({eError, this->error((t.ax + t.cx) / 2, (t.ay + t.cy) / 2), this->error((t.bx + t.cx) / 2, (t.by + t.cy) / 2)});
+			});
+		}
+	}
+	//returns faces of the triangulation which deviate from the matrix heights by no more than their tolerances
+	std::list<FaceSet> triangulate() const
 	{
-		auto pInput = std::make_unique<short[]>(cb / sizeof(short));
-		is.read(reinterpret_cast<char*>(pInput.get()), cb);
-		return convert_hgt_to_index_based_face(os, pInput.get(), unsigned(HGT_3.cColumns), unsigned(HGT_3.cRows), HGT_3.dx, HGT_3.dy);
+		std::list<std::future<FaceSet>> futures;
+		futures.emplace_back(std::async(std::launch::async, [this]() -> auto
+		{
+			FaceSet::Constructor faces;
+			this->triangulate(faces, this->root(2));
+			return FaceSet(std::move(faces));
+		}));
+		futures.emplace_back(std::async(std::launch::async, [this]() -> auto
+		{
+			FaceSet::Constructor faces;
+			this->triangulate(faces, this->root(3));
+			return FaceSet(std::move(faces));
+		}));
+		std::list<FaceSet> sets;
+		for (auto& fut:futures)
+			sets.emplace_back(fut.get());
+		return sets;
 	}
-	default:
-		throw std::invalid_argument("Unexpected HGT file size");
-	};
-}
-#endif //FILESYSTEM_CPP17
+};
+
+#include <ostream>
+
+static std::atomic_flag g_run = ATOMIC_FLAG_INIT;
 
 struct conversion_result
 {
@@ -1443,17 +1575,62 @@ private:
 	std::vector<face_t> m_LandFaces;
 };
 
+template <class T>
+inline static std::uint8_t* store_pod(std::uint8_t* pDest, const T& val) noexcept
+{
+	std::memcpy(pDest, std::addressof(val), sizeof(T));
+	return pDest + sizeof(T);
+}
+
+//Constant domain data of an HGT surface serialized once per conversion. Each face of the surface is terminated by the same
+//domain data, so that writing a face takes a single copy of face_suffix.
+struct serialized_surface_data
+{
+	std::vector<std::uint8_t> poly_header; //name, domain data and object type of the poly object
+	std::vector<std::uint8_t> face_suffix; //domain data of each face of the poly object
+
+	serialized_surface_data() = default;
+	serialized_surface_data(IDomainConverter& converter, ConstantDomainDataId id, std::string_view poly_name, ObjectTypeId poly_type = ObjectPoly)
+	{
+		buf_ostream os;
+		os << std::uint32_t(poly_name.size());
+		os.write(poly_name.data(), poly_name.size());
+		write_domain_data(os, converter.constant_poly_domain_data(id));
+		os << poly_type;
+		poly_header = std::move(os.get_vector());
+		os.clear_buffers();
+		write_domain_data(os, converter.constant_face_domain_data(id));
+		face_suffix = std::move(os.get_vector());
+	}
+private:
+	static void write_domain_data(binary_ostream& os, const domain_data_map& domain_data)
+	{
+		os << std::uint32_t(domain_data.size());
+		for (auto& prDomain:domain_data)
+		{
+			os << std::uint32_t(prDomain.first.size());
+			os.write(prDomain.first.data(), prDomain.first.size());
+			os << std::uint32_t(prDomain.second.size());
+			os.write(prDomain.second.data(), prDomain.second.size());
+		}
+	}
+};
+
 struct hgt_state
 {
-	void start(binary_ostream& os, IDomainConverter& converter, unsigned points_to_process_at_start)
-	{
-		assert(m_pOs == nullptr && m_faces.empty() && process_land_face_ptr == nullptr && process_water_face_ptr == nullptr);
-		m_pOs = &os;
-		m_face_water_domain_data = converter.constant_face_domain_data(ConstantDomainDataId::SurfaceWater);
-		m_poly_water_domain_data = converter.constant_poly_domain_data(ConstantDomainDataId::SurfaceWater);
-		m_face_land_domain_data = converter.constant_face_domain_data(ConstantDomainDataId::SurfaceLand);
-		m_poly_land_domain_data = converter.constant_poly_domain_data(ConstantDomainDataId::SurfaceLand);
+	//parse_time receives the duration of parsing the first points_to_process_at_start points
+	void start(const std::vector<HGT_OUTPUT>& outputs, unsigned points_to_process_at_start, double& parse_time)
+	{
+		assert(m_outputs.empty() && m_faces.empty() && process_land_face_ptr == nullptr && process_water_face_ptr == nullptr);
+		for (auto& output:outputs)
+		{
+			m_outputs.emplace_back(surface_output{output.pOs, 
+				serialized_surface_data(*output.pConverter, ConstantDomainDataId::SurfaceWater, hgt_surface_name(ConstantDomainDataId::SurfaceWater)),
+				serialized_surface_data(*output.pConverter, ConstantDomainDataId::SurfaceLand, hgt_surface_name(ConstantDomainDataId::SurfaceLand))});
+		}
+		auto parse_start = std::chrono::steady_clock::now();
 		auto internal_set = parse_matrix(0, points_to_process_at_start);
+		parse_time = seconds_since(parse_start);
 		process_land_face_ptr = &hgt_state::write_land_face_and_poly_header_to_stream;
 		process_water_face_ptr = &hgt_state::write_water_face_and_poly_header_to_stream;
 		std::vector<face_t> stored_faces;
@@ -1500,13 +1677,17 @@ struct hgt_state
 		if (res.max_height() > m_max_height)
 			m_max_height = res.max_height();
 	}
-	HGT_CONVERSION_STATS finalize()
+	//returns the statistics of each output
+	std::vector<HGT_CONVERSION_STATS> finalize()
 	{
 		if (m_face_count_land != 0)
 		{
-			m_pOs->seekp(m_face_count_pos);
-			*m_pOs << CAMaaS::size_type(m_face_count_land);
-			m_pOs->seekp(0, std::ios_base::end);
+			for (auto& output:m_outputs)
+			{
+				output.pOs->seekp(output.face_count_pos);
+				*output.pOs << CAMaaS::size_type(m_face_count_land);
+				output.pOs->seekp(0, std::ios_base::end);
+			}
 		}
 		if (m_face_count_water != 0)
 		{
@@ -1516,79 +1697,95 @@ struct hgt_state
 					this->process_water_face(std::move(face));
 			}
 		}
-		HGT_CONVERSION_STATS res{m_min_height, m_max_height, m_objects};
+		std::vector<HGT_CONVERSION_STATS> vStats;
+		for (auto& output:m_outputs)
+		{
+			HGT_CONVERSION_STATS res{m_min_height, m_max_height, m_objects};
+			res.face_count = std::uint64_t(m_face_count_land) + m_face_count_water;
+			res.vertex_count = m_vertex_count;
+			std::copy(std::begin(output.object_pos), std::end(output.object_pos), std::begin(res.object_pos));
+			std::copy(std::begin(m_object_surface), std::end(m_object_surface), std::begin(res.object_surface));
+			vStats.emplace_back(std::move(res));
+		}
 		*this = hgt_state();
-		return res;
+		return vStats;
 	}
 private:
+	//the surfaces are written to each output with its own constant domain data
+	struct surface_output
+	{
+		binary_ostream* pOs;
+		serialized_surface_data water_data, land_data;
+		binary_ostream::pos_type face_count_pos = 0;
+		std::uint64_t object_pos[2] = {};
+	};
 	short m_min_height = std::numeric_limits<short>::max(), m_max_height = std::numeric_limits<short>::min();
 	CAMaaS::size_type m_objects = 0;
-	binary_ostream* m_pOs = nullptr;
-	binary_ostream::pos_type m_face_count_pos = 0;
+	ConstantDomainDataId m_object_surface[2] = {};
+	std::vector<surface_output> m_outputs;
 	CAMaaS::size_type m_face_count_land = 0;
 	CAMaaS::size_type m_face_count_water = 0;
+	std::uint64_t m_vertex_count = 0;
 	std::list<std::vector<face_t>> m_faces;
 	void (hgt_state::*process_land_face_ptr)(face_t&& face) = nullptr;
 	void (hgt_state::*process_water_face_ptr)(face_t&& face) = nullptr;
-	domain_data_map m_face_water_domain_data, m_poly_water_domain_data, m_face_land_domain_data, m_poly_land_domain_data;
+	std::vector<std::uint8_t> m_face_buf;
 
-	void write_poly_header(std::string_view poly_name, const domain_data_map& domain_data)
+	void write_poly_header(serialized_surface_data surface_output::*pSurfaceData, ConstantDomainDataId surface, CAMaaS::size_type cFaces)
 	{
-		*m_pOs << std::uint32_t(poly_name.size());
-		m_pOs->write(poly_name.data(), poly_name.size());
-		*m_pOs << std::uint32_t(domain_data.size());
-		for (auto& prDomain:domain_data)
+		for (auto& output:m_outputs)
 		{
-			*m_pOs << std::uint32_t(prDomain.first.size());
-			m_pOs->write(prDomain.first.data(), prDomain.first.size());
-			*m_pOs << std::uint32_t(prDomain.second.size());
-			m_pOs->write(prDomain.second.data(), prDomain.second.size());
+			const auto& surface_data = output.*pSurfaceData;
+			output.object_pos[m_objects] = output.pOs->tellp();
+			output.pOs->write(surface_data.poly_header.data(), surface_data.poly_header.size());
+			output.face_count_pos = output.pOs->tellp();
+			*output.pOs << cFaces;
 		}
-		*m_pOs << ObjectPoly;
-		m_face_count_pos = m_pOs->tellp();
+		m_object_surface[m_objects] = surface;
+		++m_objects;
 	}
 	inline void write_land_poly_header()
 	{
-		this->write_poly_header("HGT land", m_poly_land_domain_data);
-		*m_pOs << m_face_count_land;
+		this->write_poly_header(&surface_output::land_data, ConstantDomainDataId::SurfaceLand, m_face_count_land);
 	}
 	void write_water_poly_header()
 	{
-		this->write_poly_header("HGT water", m_poly_water_domain_data);
-		*m_pOs << m_face_count_water;
+		this->write_poly_header(&surface_output::water_data, ConstantDomainDataId::SurfaceWater, m_face_count_water);
 	}
-	void write_face_to_stream(face_t&& face, const domain_data_map& domain_data)
+	//the vertices are serialized once and followed by the face domain data of each output
+	void write_face_to_stream(face_t&& face, serialized_surface_data surface_output::*pSurfaceData)
 	{
-		*m_pOs << std::uint32_t(face.size());
+		constexpr auto cbVertex = sizeof(std::uint32_t) + 3 * sizeof(double);
+		auto cbVertices = sizeof(std::uint32_t) + face.size() * cbVertex;
+		m_face_buf.resize(cbVertices);
+		auto pBuf = store_pod(m_face_buf.data(), std::uint32_t(face.size()));
 		for (auto& pt:face)
-			*m_pOs << std::uint32_t(3) << pt.x << pt.y << pt.z;
-		*m_pOs << std::uint32_t(domain_data.size());
-		for (auto& prDomain:domain_data)
+			pBuf = store_pod(store_pod(store_pod(store_pod(pBuf, std::uint32_t(3)), pt.x), pt.y), pt.z);
+		for (auto& output:m_outputs)
 		{
-			*m_pOs << std::uint32_t(prDomain.first.size());
-			m_pOs->write(prDomain.first.data(), prDomain.first.size());
-			*m_pOs << std::uint32_t(prDomain.second.size());
-			m_pOs->write(prDomain.second.data(), prDomain.second.size());
+			const auto& face_suffix = (output.*pSurfaceData).face_suffix;
+			m_face_buf.resize(cbVertices);
+			m_face_buf.insert(m_face_buf.end(), face_suffix.begin(), face_suffix.end());
+			output.pOs->write(m_face_buf.data(), m_face_buf.size());
 		}
+		m_vertex_count += face.size();
 	}
 	void write_water_face_to_stream(face_t&& face)
 	{
-		this->write_face_to_stream(std::move(face), m_face_water_domain_data);
+		this->write_face_to_stream(std::move(face), &surface_output::water_data);
 	}
 	void write_land_face_to_stream(face_t&& face)
 	{
-		this->write_face_to_stream(std::move(face), m_face_land_domain_data);
+		this->write_face_to_stream(std::move(face), &surface_output::land_data);
 	}
 	void write_water_face_and_poly_header_to_stream(face_t&& face)
 	{
-		++m_objects;
 		this->write_water_poly_header();
 		this->write_water_face_to_stream(std::move(face));
 		process_water_face_ptr = &hgt_state::write_water_face_to_stream;
 	}
 	void write_land_face_and_poly_header_to_stream(face_t&& face)
 	{
-		++m_objects;
 		this->write_land_poly_header();
 		this->write_land_face_to_stream(std::move(face));
 		process_land_face_ptr = &hgt_state::write_land_face_to_stream;
@@ -1603,8 +1800,8 @@ private:
 	}
 };
 
-static HGT_CONVERSION_STATS convert_hgt_to_external_poly_set(binary_ostream& os, short* pInput, unsigned short cColumns, unsigned short cRows, 
-	double eColumnResolution, double eRowResolution, IDomainConverter& converter)
+static std::vector<HGT_CONVERSION_STATS> convert_hgt_to_external_poly_set(const std::vector<HGT_OUTPUT>& outputs, short* pInput, 
+	unsigned short cColumns, unsigned short cRows, double eColumnResolution, double eRowResolution)
 {
 	auto cBlocks = unsigned(std::thread::hardware_concurrency());
 	auto cItemsTotal = unsigned(cColumns) * cRows;
@@ -1619,16 +1816,21 @@ static HGT_CONVERSION_STATS convert_hgt_to_external_poly_set(binary_ostream& os,
 		thr.join();*/
 
 	std::list<std::future<conversion_result>> futures;
+	std::vector<double> parse_times(cBlocks);
 	while (g_run.test_and_set(std::memory_order_acquire))
 		continue;
+	auto init_start = std::chrono::steady_clock::now();
 	g_matrix = Matrix(pInput, cColumns, cRows, eColumnResolution, eRowResolution);
+	auto matrix_init_time = seconds_since(init_start);
 	for (unsigned i = 1; i < cBlocks; ++i)
-		futures.emplace_back(std::async(std::launch::async, [i, cBlock, cItemsTotal]() -> auto
+		futures.emplace_back(std::async(std::launch::async, [i, cBlock, cItemsTotal, &parse_times]() -> auto
 		{
 			std::vector<face_t> land_faces, water_faces;
 			unsigned start_element = i * cBlock;
 			unsigned end_element = std::min(start_element + cBlock, cItemsTotal);
+			auto parse_start = std::chrono::steady_clock::now();
 			auto internal_set = parse_matrix(start_element, end_element);
+			parse_times[i] = seconds_since(parse_start);
 			auto max_height = std::numeric_limits<short>::min();
 			auto min_height = std::numeric_limits<short>::max();
 			land_faces.reserve(internal_set.size());
@@ -1660,14 +1862,283 @@ static HGT_CONVERSION_STATS convert_hgt_to_external_poly_set(binary_ostream& os,
 			return conversion_result(min_height, max_height, std::move(water_faces), std::move(land_faces));
 		}));
 	hgt_state face_converter;
-	face_converter.start(os, converter, std::min(cBlock, cItemsTotal));
+	face_converter.start(outputs, std::min(cBlock, cItemsTotal), parse_times[0]);
 	for (auto& fut:futures)
 		face_converter.add_results(fut.get());
 	g_run.clear(std::memory_order_release);
-	return face_converter.finalize();
+	auto vStats = face_converter.finalize();
+	for (auto& stats:vStats)
+	{
+		stats.matrix_init_time = matrix_init_time;
+		stats.parse_times = parse_times;
+	}
+	return vStats;
+}
+
+//Accumulates small pieces of serialized data and passes them to the output stream in large blocks
+class buffered_stream_writer
+{
+	static constexpr std::size_t FLUSH_SIZE = std::size_t(1) << 20;
+	binary_ostream* m_pOs;
+	std::vector<std::uint8_t> m_buf;
+public:
+	explicit buffered_stream_writer(binary_ostream& os):m_pOs(&os)
+	{
+		m_buf.reserve(FLUSH_SIZE);
+	}
+	~buffered_stream_writer()
+	{
+		this->flush();
+	}
+	template <class T>
+	inline buffered_stream_writer& operator<<(const T& val)
+	{
+		return this->write(std::addressof(val), sizeof(T));
+	}
+	buffered_stream_writer& write(const void* pData, std::size_t cbData)
+	{
+		auto pBytes = static_cast<const std::uint8_t*>(pData);
+		m_buf.insert(m_buf.end(), pBytes, pBytes + cbData);
+		if (m_buf.size() >= FLUSH_SIZE)
+			this->flush();
+		return *this;
+	}
+	void flush()
+	{
+		if (!m_buf.empty())
+		{
+			m_pOs->write(m_buf.data(), m_buf.size());
+			m_buf.clear();
+		}
+	}
+};
+
+static constexpr CAMaaS::size_type NO_VERTEX_INDEX = std::numeric_limits<CAMaaS::size_type>::max();
+
+//Writes the faces of all sets having the domain data id as an ObjectIndexedPoly object: a table of the vertices used by the faces
+//in the order of their first occurrence and the faces specified by the indices into the table. vIndexMap maps a matrix point to
+//its index in the table and must have all elements set to NO_VERTEX_INDEX on input and retains that state on output.
+//Returns the number of objects written, i.e. zero, if there are no faces with the domain data id.
+static CAMaaS::size_type write_indexed_surface(binary_ostream& os, const std::list<FaceSet>& sets, ConstantDomainDataId id, 
+	const serialized_surface_data& surface_data, std::vector<CAMaaS::size_type>& vIndexMap, HGT_CONVERSION_STATS& stats)
+{
+	std::vector<unsigned> vVertices;
+	CAMaaS::size_type cFaces = 0;
+	for (auto& set:sets)
+	{
+		for (auto& face:set)
+		{
+			if (GetFaceDomainDataId(face) != id)
+				continue;
+			++cFaces;
+			for (auto pt:face)
+			{
+				if (vIndexMap[pt] == NO_VERTEX_INDEX)
+				{
+					vIndexMap[pt] = CAMaaS::size_type(vVertices.size());
+					vVertices.emplace_back(pt);
+				}
+			}
+		}
+	}
+	if (cFaces == 0)
+		return 0;
+	stats.object_pos[stats.poly_count] = os.tellp();
+	stats.object_surface[stats.poly_count] = id;
+	buffered_stream_writer writer(os);
+	writer.write(surface_data.poly_header.data(), surface_data.poly_header.size());
+	writer << CAMaaS::size_type(vVertices.size());
+	for (auto pt:vVertices)
+	{
+		auto height = g_matrix.point_z(pt);
+		if (height < stats.min_height)
+			stats.min_height = height;
+		if (height > stats.max_height)
+			stats.max_height = height;
+		auto ptExt = g_matrix.get_external_point(pt);
+		writer << std::uint32_t(3) << ptExt.x << ptExt.y << ptExt.z;
+	}
+	writer << cFaces;
+	for (auto& set:sets)
+	{
+		for (auto& face:set)
+		{
+			if (GetFaceDomainDataId(face) != id)
+				continue;
+			writer << std::uint32_t(face.size());
+			for (auto pt:face)
+				writer << vIndexMap[pt];
+			writer.write(surface_data.face_suffix.data(), surface_data.face_suffix.size());
+		}
+	}
+	for (auto pt:vVertices)
+		vIndexMap[pt] = NO_VERTEX_INDEX;
+	stats.face_count += cFaces;
+	stats.vertex_count += vVertices.size();
+	return 1;
+}
+
+//Writes the faces of all sets having the domain data id as an ObjectPoly object. Returns the number of objects written.
+static CAMaaS::size_type write_surface(binary_ostream& os, const std::list<FaceSet>& sets, ConstantDomainDataId id, 
+	const serialized_surface_data& surface_data, HGT_CONVERSION_STATS& stats)
+{
+	CAMaaS::size_type cFaces = 0;
+	for (auto& set:sets)
+		cFaces += CAMaaS::size_type(std::count_if(set.begin(), set.end(), [id](const Face& face) {return GetFaceDomainDataId(face) == id;}));
+	if (cFaces == 0)
+		return 0;
+	stats.object_pos[stats.poly_count] = os.tellp();
+	stats.object_surface[stats.poly_count] = id;
+	buffered_stream_writer writer(os);
+	writer.write(surface_data.poly_header.data(), surface_data.poly_header.size());
+	writer << cFaces;
+	for (auto& set:sets)
+	{
+		for (auto& face:set)
+		{
+			if (GetFaceDomainDataId(face) != id)
+				continue;
+			writer << std::uint32_t(face.size());
+			stats.vertex_count += face.size();
+			for (auto pt:face)
+			{
+				auto height = g_matrix.point_z(pt);
+				if (height < stats.min_height)
+					stats.min_height = height;
+				if (height > stats.max_height)
+					stats.max_height = height;
+				auto ptExt = g_matrix.get_external_point(pt);
+				writer << std::uint32_t(3) << ptExt.x << ptExt.y << ptExt.z;
+			}
+			writer.write(surface_data.face_suffix.data(), surface_data.face_suffix.size());
+		}
+	}
+	stats.face_count += cFaces;
+	return 1;
+}
+
+static HGT_CONVERSION_STATS write_face_sets(binary_ostream& os, const std::list<FaceSet>& sets, IDomainConverter& converter, bool fIndexedFaces)
+{
+	HGT_CONVERSION_STATS stats{std::numeric_limits<short>::max(), std::numeric_limits<short>::min(), 0};
+	auto poly_type = fIndexedFaces?ObjectIndexedPoly:ObjectPoly;
+	auto land_data = serialized_surface_data(converter, ConstantDomainDataId::SurfaceLand, hgt_surface_name(ConstantDomainDataId::SurfaceLand), poly_type);
+	auto water_data = serialized_surface_data(converter, ConstantDomainDataId::SurfaceWater, hgt_surface_name(ConstantDomainDataId::SurfaceWater), poly_type);
+	if (fIndexedFaces)
+	{
+		std::vector<CAMaaS::size_type> vIndexMap(std::size_t(g_matrix.columns()) * g_matrix.rows(), NO_VERTEX_INDEX);
+		stats.poly_count += write_indexed_surface(os, sets, ConstantDomainDataId::SurfaceLand, land_data, vIndexMap, stats);
+		stats.poly_count += write_indexed_surface(os, sets, ConstantDomainDataId::SurfaceWater, water_data, vIndexMap, stats);
+	}else
+	{
+		stats.poly_count += write_surface(os, sets, ConstantDomainDataId::SurfaceLand, land_data, stats);
+		stats.poly_count += write_surface(os, sets, ConstantDomainDataId::SurfaceWater, water_data, stats);
+	}
+	return stats;
+}
+
+//the face sets are written to each output in turn
+static std::vector<HGT_CONVERSION_STATS> write_face_sets(const std::vector<HGT_OUTPUT>& outputs, const std::list<FaceSet>& sets, bool fIndexedFaces, 
+	double matrix_init_time, const std::vector<double>& parse_times)
+{
+	std::vector<HGT_CONVERSION_STATS> vStats;
+	for (auto& output:outputs)
+	{
+		auto& stats = vStats.emplace_back(write_face_sets(*output.pOs, sets, *output.pConverter, fIndexedFaces));
+		stats.matrix_init_time = matrix_init_time;
+		stats.parse_times = parse_times;
+	}
+	return vStats;
+}
+
+static std::vector<HGT_CONVERSION_STATS> convert_hgt_to_indexed_poly_set(const std::vector<HGT_OUTPUT>& outputs, short* pInput, 
+	unsigned short cColumns, unsigned short cRows, double eColumnResolution, double eRowResolution)
+{
+	auto cBlocks = unsigned(std::thread::hardware_concurrency());
+	auto cItemsTotal = unsigned(cColumns) * cRows;
+	auto cBlock = (cItemsTotal + cBlocks - 1) / cBlocks;
+	std::list<std::future<FaceSet>> futures;
+	std::vector<double> parse_times(cBlocks);
+	while (g_run.test_and_set(std::memory_order_acquire))
+		continue;
+	auto init_start = std::chrono::steady_clock::now();
+	g_matrix = Matrix(pInput, cColumns, cRows, eColumnResolution, eRowResolution);
+	auto matrix_init_time = seconds_since(init_start);
+	for (unsigned i = 0; i < cBlocks; ++i)
+		futures.emplace_back(std::async(std::launch::async, [i, cBlock, cItemsTotal, &parse_times]() -> auto
+		{
+			auto parse_start = std::chrono::steady_clock::now();
+			auto set = parse_matrix(std::min(i * cBlock, cItemsTotal), std::min((i + 1) * cBlock, cItemsTotal));
+			parse_times[i] = seconds_since(parse_start);
+			return set;
+		}));
+	std::list<FaceSet> sets;
+	for (auto& fut:futures)
+		sets.emplace_back(fut.get());
+	auto vStats = write_face_sets(outputs, sets, true, matrix_init_time, parse_times);
+	g_run.clear(std::memory_order_release);
+	return vStats;
+}
+
+//Instead of merging coplanar faces, approximates the surface by an RTIN with the vertical error bounded by the tolerance. If the
+//detail radius is specified, the faces closer than the radius to any of the detail areas keep the heights exactly.
+static std::vector<HGT_CONVERSION_STATS> convert_hgt_to_simplified_poly_set(const std::vector<HGT_OUTPUT>& outputs, short* pInput, 
+	unsigned short cColumns, unsigned short cRows, double eColumnResolution, double eRowResolution, const HGT_CONVERSION_OPTIONS& options, 
+	const std::vector<HGT_DETAIL_AREA>& detail_areas)
+{
+	auto tolerance = [&options, &detail_areas, eColumnResolution, eRowResolution]
+		(unsigned min_col, unsigned min_row, unsigned max_col, unsigned max_row) -> double
+	{
+		if (options.eDetailRadius > 0)
+		{
+			auto x_min = min_col * eColumnResolution, x_max = max_col * eColumnResolution;
+			auto y_min = min_row * eRowResolution, y_max = max_row * eRowResolution;
+			for (auto& area:detail_areas)
+			{
+				auto dx = std::max({0.0, area.x_min - x_max, x_min - area.x_max});
+				auto dy = std::max({0.0, area.y_min - y_max, y_min - area.y_max});
+				if (dx * dx + dy * dy < options.eDetailRadius * options.eDetailRadius)
+					return 0;
+			}
+		}
+		return options.eHeightTolerance;
+	};
+	while (g_run.test_and_set(std::memory_order_acquire))
+		continue;
+	auto init_start = std::chrono::steady_clock::now();
+	g_matrix = Matrix(pInput, cColumns, cRows, eColumnResolution, eRowResolution);
+	auto matrix_init_time = seconds_since(init_start);
+	auto parse_start = std::chrono::steady_clock::now();
+	auto sets = RtinTriangulation(tolerance).triangulate();
+	auto parse_time = seconds_since(parse_start);
+	auto vStats = write_face_sets(outputs, sets, options.fIndexedFaces, matrix_init_time, std::vector<double>(1, parse_time));
+	g_run.clear(std::memory_order_release);
+	return vStats;
+}
+
+static std::vector<HGT_CONVERSION_STATS> convert_hgt_to_poly_set(const std::vector<HGT_OUTPUT>& outputs, short* pInput, const HGT_RESOLUTION_DATA& resolution, 
+	const HGT_CONVERSION_OPTIONS& options, const std::vector<HGT_DETAIL_AREA>& detail_areas)
+{
+	auto cColumns = (unsigned short) resolution.cColumns, cRows = (unsigned short) resolution.cRows;
+	if (options.eHeightTolerance > 0)
+		return convert_hgt_to_simplified_poly_set(outputs, pInput, cColumns, cRows, resolution.dx, resolution.dy, options, detail_areas);
+	if (options.fIndexedFaces)
+		return convert_hgt_to_indexed_poly_set(outputs, pInput, cColumns, cRows, resolution.dx, resolution.dy);
+	return convert_hgt_to_external_poly_set(outputs, pInput, cColumns, cRows, resolution.dx, resolution.dy);
+}
+
+const char* hgt_surface_name(ConstantDomainDataId surface)
+{
+	return surface == ConstantDomainDataId::SurfaceLand?"HGT land":"HGT water";
 }
 
-HGT_CONVERSION_STATS convert_hgt(const HGT_RESOLUTION_DATA& resolution, std::istream& is_data, IDomainConverter& converter, binary_ostream& os)
+HGT_CONVERSION_STATS convert_hgt(const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, const std::vector<HGT_DETAIL_AREA>& detail_areas, 
+	std::istream& is_data, IDomainConverter& converter, binary_ostream& os)
+{
+	return convert_hgt(resolution, options, detail_areas, is_data, std::vector<HGT_OUTPUT>{HGT_OUTPUT{&converter, &os}}).front();
+}
+
+std::vector<HGT_CONVERSION_STATS> convert_hgt(const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, 
+	const std::vector<HGT_DETAIL_AREA>& detail_areas, std::istream& is_data, const std::vector<HGT_OUTPUT>& outputs)
 {
 	is_data.seekg(0, std::ios_base::end);
 	auto cb = is_data.tellg();
@@ -1678,17 +2149,27 @@ HGT_CONVERSION_STATS convert_hgt(const HGT_RESOLUTION_DATA& resolution, std::ist
 	{
 	case HGT_1.cColumns * HGT_1.cRows * sizeof(short):
 	{
+		auto load_start = std::chrono::steady_clock::now();
 		auto pInput = std::make_unique<short[]>(cb / sizeof(short));
 		is_data.read(reinterpret_cast<char*>(pInput.get()), cb);
-		return convert_hgt_to_external_poly_set(os, pInput.get(), unsigned(HGT_1.cColumns), unsigned(HGT_1.cRows), HGT_1.dx, HGT_1.dy, converter);
+		auto load_time = seconds_since(load_start);
+		auto vStats = convert_hgt_to_poly_set(outputs, pInput.get(), HGT_1, options, detail_areas);
+		for (auto& stats:vStats)
+			stats.load_time = load_time;
+		return vStats;
 	}
 	case HGT_3.cColumns * HGT_3.cRows * sizeof(short):
 	{
+		auto load_start = std::chrono::steady_clock::now();
 		auto pInput = std::make_unique<short[]>(cb / sizeof(short));
 		is_data.read(reinterpret_cast<char*>(pInput.get()), cb);
-		return convert_hgt_to_external_poly_set(os, pInput.get(), unsigned(HGT_3.cColumns), unsigned(HGT_3.cRows), HGT_3.dx, HGT_3.dy, converter);
+		auto load_time = seconds_since(load_start);
+		auto vStats = convert_hgt_to_poly_set(outputs, pInput.get(), HGT_3, options, detail_areas);
+		for (auto& stats:vStats)
+			stats.load_time = load_time;
+		return vStats;
 	}
 	default:
 		throw std::invalid_argument("Unexpected HGT file size");
 	};
-}
\ No newline at end of file
+}
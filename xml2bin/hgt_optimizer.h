@@ -1,3 +1,5 @@
+#include <cstdint>
+#include <vector>
 #include <binary_streams.h>
 #include "xml2bin.h"
 #include "domain_converter.h"
@@ -5,22 +7,56 @@
 #ifndef XML2BIN_HGTOPTIMIZER_H_
 #define XML2BIN_HGTOPTIMIZER_H_
 
-//returns a number of faces obtained
-//unsigned convert_hgt_to_index_based_face(binary_ostream& os, const short* pInput, unsigned short cColumns, unsigned short cRows, double eColumnResolution, double eRowResolution);
-
-#if FILESYSTEM_CPP17
-unsigned convert_hgt_to_index_based_face(std::filesystem::path input, std::filesystem::path output);
-#endif //FILESYSTEM_CPP17
+//identifies the output of convert_hgt for the same input and options. Must be incremented whenever the output changes, so that
+//the entries of the HGT cache (see hgt_cache.h) produced by the previous versions are not used.
+constexpr std::uint32_t HGT_OPTIMIZER_VERSION = 1;
 
 struct HGT_CONVERSION_STATS
 {
 	short min_height;
 	short max_height;
 	unsigned poly_count;
+	//positions of the poly objects in the output stream and their surfaces, the first poly_count elements are valid
+	std::uint64_t object_pos[2];
+	ConstantDomainDataId object_surface[2];
+	//faces of the poly objects and vertices written for them (the vertex table of the indexed objects, each vertex of each face
+	//otherwise)
+	std::uint64_t face_count = 0;
+	std::uint64_t vertex_count = 0;
+	//durations (in seconds) of the reading of the HGT file, of the initialization of the height matrix and of the parsing of the
+	//matrix by each worker (or of the RTIN triangulation). Not set, if the surfaces are replayed from the HGT cache.
+	double load_time = 0;
+	double matrix_init_time = 0;
+	std::vector<double> parse_times;
+	bool cached = false; //the surfaces are replayed from the HGT cache
 };
 
+//an axis-aligned rectangle in the model coordinates (e.g. a source position or an extent of a plain), near which the HGT surfaces
+//keep the full resolution, if HGT_CONVERSION_OPTIONS::eDetailRadius is set
+struct HGT_DETAIL_AREA
+{
+	double x_min, y_min;
+	double x_max, y_max;
+};
+
+//name of the poly object written for the surface
+const char* hgt_surface_name(ConstantDomainDataId surface);
+
 //returns min and max heights
-HGT_CONVERSION_STATS convert_hgt(const HGT_RESOLUTION_DATA& resolution, std::istream& is_data, IDomainConverter& converter, binary_ostream& os);
+HGT_CONVERSION_STATS convert_hgt(const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, const std::vector<HGT_DETAIL_AREA>& detail_areas, 
+	std::istream& is_data, IDomainConverter& converter, binary_ostream& os);
+
+//an output of the HGT surfaces, written with the constant domain data of the converter
+struct HGT_OUTPUT
+{
+	IDomainConverter* pConverter;
+	binary_ostream* pOs;
+};
+
+//Computes the surfaces once and writes them to each of the outputs, which differ in the constant domain data only. Returns the
+//statistics of each output.
+std::vector<HGT_CONVERSION_STATS> convert_hgt(const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, 
+	const std::vector<HGT_DETAIL_AREA>& detail_areas, std::istream& is_data, const std::vector<HGT_OUTPUT>& outputs);
 
 #endif //XML2BIN_HGTOPTIMIZER_H_
 
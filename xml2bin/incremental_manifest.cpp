@@ -0,0 +1,190 @@
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <binary_streams.h>
+#include "incremental_manifest.h"
+#include <content_hash.h>
+
+//Layout of a manifest: INCREMENTAL_MANIFEST_MAGIC, INCREMENTAL_MANIFEST_FORMAT_VERSION, domain, output size (uint64), input count
+//(uint32) followed by the inputs. Strings and byte sequences are prefixed by their sizes (uint32). The format version must be
+//changed whenever the serialization of the objects changes, since the manifest refers to the objects serialized by the program.
+static constexpr char INCREMENTAL_MANIFEST_MAGIC[4] = {'X', '2', 'B', 'M'};
+static constexpr std::uint32_t INCREMENTAL_MANIFEST_FORMAT_VERSION = 1;
+
+namespace
+{
+	class manifest_reader
+	{
+		const std::uint8_t* m_pCur;
+		const std::uint8_t* m_pEnd;
+	public:
+		manifest_reader(const void* pData, std::size_t cbData):m_pCur(static_cast<const std::uint8_t*>(pData)), m_pEnd(m_pCur + cbData) {}
+		bool read(void* pOut, std::size_t cb)
+		{
+			if (std::size_t(m_pEnd - m_pCur) < cb)
+				return false;
+			std::memcpy(pOut, m_pCur, cb);
+			m_pCur += cb;
+			return true;
+		}
+		template <class T>
+		auto read(T& val) -> std::enable_if_t<std::is_arithmetic_v<T>, bool>
+		{
+			return this->read(std::addressof(val), sizeof(T));
+		}
+		bool read(point_t& pt)
+		{
+			return this->read(pt.x) && this->read(pt.y) && this->read(pt.z);
+		}
+		template <class Cont>
+		auto read(Cont& cont) -> std::enable_if_t<std::is_same_v<typename Cont::value_type, char> || std::is_same_v<typename Cont::value_type, std::uint8_t>, bool>
+		{
+			std::uint32_t cb;
+			if (!this->read(cb) || std::size_t(m_pEnd - m_pCur) < cb)
+				return false;
+			cont.assign(m_pCur, m_pCur + cb);
+			m_pCur += cb;
+			return true;
+		}
+		bool at_end() const
+		{
+			return m_pCur == m_pEnd;
+		}
+	};
+
+	void write_sequence(binary_ostream& os, const void* pData, std::size_t cbData)
+	{
+		os << std::uint32_t(cbData);
+		os.write(pData, cbData);
+	}
+	void write_point(binary_ostream& os, const point_t& pt)
+	{
+		os << pt.x << pt.y << pt.z;
+	}
+}
+
+static bool read_incremental_object(manifest_reader& reader, INCREMENTAL_OBJECT& object)
+{
+	std::uint32_t type;
+	if (!reader.read(type) || !reader.read(object.name) || !reader.read(object.offset) || !reader.read(object.size))
+		return false;
+	switch (type)
+	{
+	case ObjectPoly:
+		object.type = ObjectPoly;
+		return true;
+	case ObjectSource:
+	case ObjectPlain:
+		object.type = ObjectTypeId(type);
+		return reader.read(object.geometry[0]) && reader.read(object.geometry[1]) && reader.read(object.geometry[2]);
+	default:
+		return false;
+	}
+}
+
+static bool read_incremental_input(manifest_reader& reader, INCREMENTAL_INPUT& input)
+{
+	std::uint32_t cDomainData, cObjects;
+	if (!reader.read(input.path) || !reader.read(input.hash) || !reader.read(input.model_size) || !reader.read(input.model_name) || !reader.read(cDomainData))
+		return false;
+	for (std::uint32_t i = 0; i < cDomainData; ++i)
+	{
+		std::string strDomain;
+		std::vector<std::uint8_t> vData;
+		if (!reader.read(strDomain) || !reader.read(vData) || !input.model_domain_data.emplace(std::move(strDomain), std::move(vData)).second)
+			return false;
+	}
+	if (!reader.read(cObjects))
+		return false;
+	for (std::uint32_t i = 0; i < cObjects; ++i)
+	{
+		if (!read_incremental_object(reader, input.objects.emplace_back()))
+			return false;
+	}
+	return true;
+}
+
+bool read_incremental_manifest(const std::string& strPath, INCREMENTAL_MANIFEST& manifest)
+{
+	std::ifstream is(strPath, std::ios_base::in | std::ios_base::binary);
+	if (!is)
+		return false;
+	std::vector<std::uint8_t> vData((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	return read_incremental_manifest(vData.data(), vData.size(), manifest);
+}
+
+bool read_incremental_manifest(const void* pData, std::size_t cbData, INCREMENTAL_MANIFEST& manifest)
+{
+	manifest_reader reader(pData, cbData);
+	char magic[sizeof(INCREMENTAL_MANIFEST_MAGIC)];
+	std::uint32_t format_version, cInputs;
+	if (!reader.read(magic, sizeof(magic)) || std::memcmp(magic, INCREMENTAL_MANIFEST_MAGIC, sizeof(magic)) != 0
+		|| !reader.read(format_version) || format_version != INCREMENTAL_MANIFEST_FORMAT_VERSION)
+		return false;
+	INCREMENTAL_MANIFEST result;
+	if (!reader.read(result.domain) || !reader.read(result.output_size) || !reader.read(cInputs))
+		return false;
+	for (std::uint32_t i = 0; i < cInputs; ++i)
+	{
+		if (!read_incremental_input(reader, result.inputs.emplace_back()))
+			return false;
+	}
+	if (!reader.at_end())
+		return false;
+	manifest = std::move(result);
+	return true;
+}
+
+void write_incremental_manifest(const std::string& strPath, const INCREMENTAL_MANIFEST& manifest)
+{
+	binary_ofstream os(strPath, true);
+	if (os.fail())
+		throw std::runtime_error("Failed to create the manifest \"" + strPath + "\"");
+	write_incremental_manifest(os, manifest);
+	if (os.fail())
+		throw std::runtime_error("Failed to write the manifest \"" + strPath + "\"");
+}
+
+void write_incremental_manifest(binary_ostream& os, const INCREMENTAL_MANIFEST& manifest)
+{
+	os.write(INCREMENTAL_MANIFEST_MAGIC, sizeof(INCREMENTAL_MANIFEST_MAGIC));
+	os << INCREMENTAL_MANIFEST_FORMAT_VERSION;
+	write_sequence(os, manifest.domain.data(), manifest.domain.size());
+	os << manifest.output_size << std::uint32_t(manifest.inputs.size());
+	for (auto& input:manifest.inputs)
+	{
+		write_sequence(os, input.path.data(), input.path.size());
+		os << input.hash;
+		write_point(os, input.model_size);
+		write_sequence(os, input.model_name.data(), input.model_name.size());
+		os << std::uint32_t(input.model_domain_data.size());
+		for (auto& prDomain:input.model_domain_data)
+		{
+			write_sequence(os, prDomain.first.data(), prDomain.first.size());
+			write_sequence(os, prDomain.second.data(), prDomain.second.size());
+		}
+		os << std::uint32_t(input.objects.size());
+		for (auto& object:input.objects)
+		{
+			os << std::uint32_t(object.type);
+			write_sequence(os, object.name.data(), object.name.size());
+			os << object.offset << object.size;
+			if (object.type != ObjectPoly)
+			{
+				for (auto& pt:object.geometry)
+					write_point(os, pt);
+			}
+		}
+	}
+}
+
+std::uint64_t incremental_input_hash(const std::string& strPath)
+{
+	std::ifstream is(strPath, std::ios_base::in | std::ios_base::binary);
+	if (!is)
+		throw std::runtime_error("Failed to open the file \"" + strPath + "\".");
+	return content_hash().add(is).value();
+}
@@ -0,0 +1,48 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <basedefs.h>
+#include <point.h>
+#include <binary_streams.h>
+
+#ifndef XML2BIN_INCREMENTAL_MANIFEST_H_
+#define XML2BIN_INCREMENTAL_MANIFEST_H_
+
+//A manifest describes an output binary model in terms of the input XML files it has been converted from, so that a later
+//conversion can copy the serialized objects of the unchanged files from the output instead of parsing the files again.
+
+struct INCREMENTAL_OBJECT
+{
+	ObjectTypeId type;
+	std::string name;
+	std::uint64_t offset; //position of the serialized object in the output
+	std::uint64_t size; //size of the serialized object in bytes
+	point_t geometry[3]; //position and the two vectors of a source or a plain (they define the HGT detail areas), unused for polys
+};
+
+struct INCREMENTAL_INPUT
+{
+	std::string path;
+	std::uint64_t hash; //hash of the file contents
+	point_t model_size; //coordinates of the model size specified by the file, infinity if not specified
+	std::string model_name; //empty, if the file does not specify the model name
+	std::map<std::string, std::vector<std::uint8_t>> model_domain_data; //model domain data specified by the file
+	std::vector<INCREMENTAL_OBJECT> objects; //objects specified by the file in the order of the output
+};
+
+struct INCREMENTAL_MANIFEST
+{
+	std::string domain;
+	std::uint64_t output_size;
+	std::vector<INCREMENTAL_INPUT> inputs;
+};
+
+//returns false, if the file does not exist, is damaged or has been written by an incompatible version of the program
+bool read_incremental_manifest(const std::string& strPath, INCREMENTAL_MANIFEST& manifest);
+bool read_incremental_manifest(const void* pData, std::size_t cbData, INCREMENTAL_MANIFEST& manifest);
+void write_incremental_manifest(const std::string& strPath, const INCREMENTAL_MANIFEST& manifest);
+void write_incremental_manifest(binary_ostream& os, const INCREMENTAL_MANIFEST& manifest);
+std::uint64_t incremental_input_hash(const std::string& strPath);
+
+#endif //XML2BIN_INCREMENTAL_MANIFEST_H_
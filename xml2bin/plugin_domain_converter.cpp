@@ -0,0 +1,283 @@
+#include "plugin_domain_converter.h"
+#include <xml_exceptions.h>
+#include <stdexcept>
+#include <new>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace
+{
+	//the output of a plugin appended to the vector, which the plugin writes to in place
+	struct vector_output
+	{
+		std::vector<std::uint8_t>* pData;
+		bool fOutOfMemory = false;
+
+		explicit vector_output(std::vector<std::uint8_t>& vData):pData(&vData) {}
+		//no exception may leave the plugin
+		static unsigned char* append(void* context, size_t cb) noexcept
+		{
+			auto& output = *static_cast<vector_output*>(context);
+			try
+			{
+				auto cbData = output.pData->size();
+				output.pData->resize(cbData + cb);
+				return output.pData->data() + cbData;
+			}catch (...)
+			{
+				output.fOutOfMemory = true;
+				return nullptr;
+			}
+		}
+		camaas_domain_output c_output() noexcept
+		{
+			return camaas_domain_output{this, &vector_output::append};
+		}
+	};
+}
+
+#ifdef _WIN32
+static void* load_module(const std::string& strPath)
+{
+	return LoadLibraryA(strPath.c_str());
+}
+static void* module_symbol(void* hModule, const char* pszName)
+{
+	return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(hModule), pszName));
+}
+static void unload_module(void* hModule)
+{
+	FreeLibrary(static_cast<HMODULE>(hModule));
+}
+//the description of the last failure of load_module or module_symbol
+static std::string module_error()
+{
+	auto dwError = GetLastError();
+	char* pszMessage = nullptr;
+	auto cchMessage = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, nullptr, dwError,
+		0, reinterpret_cast<char*>(&pszMessage), 0, nullptr);
+	std::string strMessage = "Error " + std::to_string(dwError);
+	if (cchMessage != 0)
+	{
+		auto strText = std::string(pszMessage, cchMessage);
+		strText.erase(strText.find_last_not_of(" \r\n.") + 1);
+		strMessage += ": " + strText;
+	}
+	LocalFree(pszMessage);
+	return strMessage;
+}
+#else
+static void* load_module(const std::string& strPath)
+{
+	return dlopen(strPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+}
+static void* module_symbol(void* hModule, const char* pszName)
+{
+	return dlsym(hModule, pszName);
+}
+static void unload_module(void* hModule)
+{
+	dlclose(hModule);
+}
+//the description of the last failure of load_module or module_symbol
+static std::string module_error()
+{
+	auto pszError = dlerror();
+	return pszError != nullptr?pszError:"Unknown error";
+}
+#endif //_WIN32
+
+static std::uint32_t constant_id(ConstantDomainDataId id)
+{
+	return id == ConstantDomainDataId::SurfaceLand?CAMAAS_CONSTANT_SURFACE_LAND:CAMAAS_CONSTANT_SURFACE_WATER;
+}
+
+plugin_domain_converter::plugin_domain_converter(const std::string& strPath):m_strPath(strPath)
+{
+	m_hModule = load_module(strPath);
+	if (m_hModule == nullptr)
+		throw std::runtime_error("Failed to load the domain plugin \"" + strPath + "\": " + module_error() + ".");
+	auto entry = reinterpret_cast<camaas_domain_plugin_entry_fn>(module_symbol(m_hModule, CAMAAS_DOMAIN_PLUGIN_ENTRY));
+	if (entry == nullptr)
+	{
+		auto strError = module_error();
+		unload_module(m_hModule);
+		throw std::runtime_error("The domain plugin \"" + strPath + "\" does not export " CAMAAS_DOMAIN_PLUGIN_ENTRY ": " + strError + ".");
+	}
+	if (entry(CAMAAS_DOMAIN_PLUGIN_ABI_VERSION, &m_plugin) != 0)
+	{
+		unload_module(m_hModule);
+		throw std::runtime_error("The domain plugin \"" + strPath + "\" does not implement the version "
+			+ std::to_string(CAMAAS_DOMAIN_PLUGIN_ABI_VERSION) + " of the interface.");
+	}
+	if (m_plugin.domain_name == nullptr || *m_plugin.domain_name == 0)
+	{
+		this->unload();
+		throw std::runtime_error("The domain plugin \"" + strPath + "\" does not specify the domain name.");
+	}
+	m_strDomain = m_plugin.domain_name;
+}
+
+plugin_domain_converter::~plugin_domain_converter()
+{
+	this->unload();
+}
+
+void plugin_domain_converter::unload() noexcept
+{
+	if (m_plugin.release != nullptr)
+		m_plugin.release(m_plugin.converter);
+	unload_module(m_hModule);
+}
+
+const std::string& plugin_domain_converter::domain_name() const
+{
+	return m_strDomain;
+}
+
+bool plugin_domain_converter::is_deterministic() const
+{
+	return (m_plugin.flags & CAMAAS_DOMAIN_PLUGIN_DETERMINISTIC) != 0;
+}
+
+camaas_convert_fn plugin_domain_converter::convert_function(DomainDataKind kind) const
+{
+	switch (kind)
+	{
+	case DomainDataKind::Model:
+		return m_plugin.model_domain_data;
+	case DomainDataKind::Poly:
+		return m_plugin.poly_domain_data;
+	case DomainDataKind::Face:
+		return m_plugin.face_domain_data;
+	case DomainDataKind::Source:
+		return m_plugin.source_domain_data;
+	default:
+		return m_plugin.plain_domain_data;
+	}
+}
+
+std::string plugin_domain_converter::invalid_data_message() const
+{
+	auto pszError = m_plugin.last_error != nullptr?m_plugin.last_error(m_plugin.converter):nullptr;
+	if (pszError == nullptr || *pszError == 0)
+		return "Invalid " + m_strDomain + " domain data";
+	return "Invalid " + m_strDomain + " domain data: " + pszError;
+}
+
+bool plugin_domain_converter::convert_domain_data(DomainDataKind kind, const xml::tag&, text_istream& is, std::vector<std::uint8_t>& vData)
+{
+	auto convert = this->convert_function(kind);
+	if (convert == nullptr)
+	{
+		skip_xml_domain_data(is);
+		return false;
+	}
+	auto strText = read_xml_domain_text(is, m_strScratch);
+	vData.clear();
+	vector_output output(vData);
+	auto c_output = output.c_output();
+	auto result = convert(m_plugin.converter, camaas_text{strText.data(), strText.size()}, &c_output);
+	if (output.fOutOfMemory)
+		throw std::bad_alloc();
+	if (result == CAMAAS_DOMAIN_DATA_INVALID)
+		throw invalid_xml_model(is.get_resource_locator(), this->invalid_data_message());
+	if (result != CAMAAS_DOMAIN_DATA_CONVERTED && result != CAMAAS_DOMAIN_DATA_UNSUPPORTED)
+		throw std::runtime_error("The domain plugin \"" + m_strPath + "\" has returned an unknown result.");
+	return result == CAMAAS_DOMAIN_DATA_CONVERTED;
+}
+
+bool plugin_domain_converter::write_domain_data(DomainDataKind kind, std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+{
+	if (strDomainName != m_strDomain)
+	{
+		skip_xml_domain_data(is);
+		return false;
+	}
+	if (!this->convert_domain_data(kind, domain_opening_tag, is, m_vData))
+		return false;
+	os.write(m_vData.data(), m_vData.size());
+	return true;
+}
+
+bool plugin_domain_converter::model_domain_data(std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+{
+	return this->write_domain_data(DomainDataKind::Model, strDomainName, domain_opening_tag, is, os);
+}
+bool plugin_domain_converter::poly_domain_data(std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+{
+	return this->write_domain_data(DomainDataKind::Poly, strDomainName, domain_opening_tag, is, os);
+}
+bool plugin_domain_converter::face_domain_data(std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+{
+	return this->write_domain_data(DomainDataKind::Face, strDomainName, domain_opening_tag, is, os);
+}
+bool plugin_domain_converter::source_domain_data(std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+{
+	return this->write_domain_data(DomainDataKind::Source, strDomainName, domain_opening_tag, is, os);
+}
+bool plugin_domain_converter::plain_domain_data(std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os)
+{
+	return this->write_domain_data(DomainDataKind::Plain, strDomainName, domain_opening_tag, is, os);
+}
+
+std::optional<domain_datum> plugin_domain_converter::constant_domain_data(camaas_constant_fn constant, std::string_view strDomainName, ConstantDomainDataId id)
+{
+	if (constant == nullptr || strDomainName != m_strDomain)
+		return std::optional<domain_datum>();
+	std::vector<std::uint8_t> vData;
+	vector_output output(vData);
+	auto c_output = output.c_output();
+	auto result = constant(m_plugin.converter, constant_id(id), &c_output);
+	if (output.fOutOfMemory)
+		throw std::bad_alloc();
+	if (result == CAMAAS_DOMAIN_DATA_UNSUPPORTED)
+		return std::optional<domain_datum>();
+	if (result != CAMAAS_DOMAIN_DATA_CONVERTED)
+		throw std::runtime_error(this->invalid_data_message());
+	return domain_datum(std::move(vData));
+}
+
+domain_data_map plugin_domain_converter::constant_domain_data_map(camaas_constant_fn constant, ConstantDomainDataId id)
+{
+	auto domain_data = this->constant_domain_data(constant, m_strDomain, id);
+	return domain_data.has_value()?domain_data_map{{m_strDomain, std::move(domain_data.value())}}:domain_data_map{};
+}
+
+std::optional<domain_datum> plugin_domain_converter::constant_face_domain_data(std::string_view strDomainName, ConstantDomainDataId id)
+{
+	return this->constant_domain_data(m_plugin.constant_face_domain_data, strDomainName, id);
+}
+domain_data_map plugin_domain_converter::constant_face_domain_data(ConstantDomainDataId id)
+{
+	return this->constant_domain_data_map(m_plugin.constant_face_domain_data, id);
+}
+std::optional<domain_datum> plugin_domain_converter::constant_poly_domain_data(std::string_view strDomainName, ConstantDomainDataId id)
+{
+	return this->constant_domain_data(m_plugin.constant_poly_domain_data, strDomainName, id);
+}
+domain_data_map plugin_domain_converter::constant_poly_domain_data(ConstantDomainDataId id)
+{
+	return this->constant_domain_data_map(m_plugin.constant_poly_domain_data, id);
+}
+std::optional<domain_datum> plugin_domain_converter::constant_source_domain_data(std::string_view strDomainName, ConstantDomainDataId id)
+{
+	return this->constant_domain_data(m_plugin.constant_source_domain_data, strDomainName, id);
+}
+domain_data_map plugin_domain_converter::constant_source_domain_data(ConstantDomainDataId id)
+{
+	return this->constant_domain_data_map(m_plugin.constant_source_domain_data, id);
+}
+std::optional<domain_datum> plugin_domain_converter::constant_plain_domain_data(std::string_view strDomainName, ConstantDomainDataId id)
+{
+	return this->constant_domain_data(m_plugin.constant_plain_domain_data, strDomainName, id);
+}
+domain_data_map plugin_domain_converter::constant_plain_domain_data(ConstantDomainDataId id)
+{
+	return this->constant_domain_data_map(m_plugin.constant_plain_domain_data, id);
+}
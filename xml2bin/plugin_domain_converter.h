@@ -0,0 +1,60 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <domain_plugin.h>
+#include "domain_converter.h"
+
+#ifndef XML2BIN_PLUGIN_DOMAIN_CONVERTER_H_
+#define XML2BIN_PLUGIN_DOMAIN_CONVERTER_H_
+
+//Converter of the domain implemented by a shared object loaded at runtime (see domain_plugin.h). The constructor throws
+//std::runtime_error with the error of the system, if the shared object cannot be loaded or does not export CAMAAS_DOMAIN_PLUGIN_ENTRY,
+//and if it does not implement CAMAAS_DOMAIN_PLUGIN_ABI_VERSION of the interface.
+//The plugin converts the text of the domain data without copying it, if it is buffered entirely, and writes the converted data
+//to the memory of the output vector directly. The identical domain data are converted once only by the plugins declaring
+//CAMAAS_DOMAIN_PLUGIN_DETERMINISTIC.
+class plugin_domain_converter:public IRuntimeDomainConverter
+{
+public:
+	explicit plugin_domain_converter(const std::string& strPath);
+	plugin_domain_converter(const plugin_domain_converter&) = delete;
+	plugin_domain_converter& operator=(const plugin_domain_converter&) = delete;
+	virtual ~plugin_domain_converter();
+
+	virtual const std::string& domain_name() const;
+	virtual bool convert_domain_data(DomainDataKind kind, const xml::tag& domain_opening_tag, text_istream& is, std::vector<std::uint8_t>& vData);
+	virtual bool is_deterministic() const;
+
+	virtual bool model_domain_data(std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os);
+	virtual bool poly_domain_data(std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os);
+	virtual bool face_domain_data(std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os);
+	virtual bool source_domain_data(std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os);
+	virtual bool plain_domain_data(std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os);
+
+	virtual std::optional<domain_datum> constant_face_domain_data(std::string_view strDomainName, ConstantDomainDataId id);
+	virtual domain_data_map constant_face_domain_data(ConstantDomainDataId id);
+	virtual std::optional<domain_datum> constant_poly_domain_data(std::string_view strDomainName, ConstantDomainDataId id);
+	virtual domain_data_map constant_poly_domain_data(ConstantDomainDataId id);
+	virtual std::optional<domain_datum> constant_source_domain_data(std::string_view strDomainName, ConstantDomainDataId id);
+	virtual domain_data_map constant_source_domain_data(ConstantDomainDataId id);
+	virtual std::optional<domain_datum> constant_plain_domain_data(std::string_view strDomainName, ConstantDomainDataId id);
+	virtual domain_data_map constant_plain_domain_data(ConstantDomainDataId id);
+private:
+	std::string m_strPath;
+	void* m_hModule = nullptr;
+	camaas_domain_plugin m_plugin = {};
+	std::string m_strDomain;
+	std::string m_strScratch; //the text of the domain data split between the buffered blocks of the input
+	std::vector<std::uint8_t> m_vData; //the data converted to a binary_ostream
+
+	camaas_convert_fn convert_function(DomainDataKind kind) const;
+	bool write_domain_data(DomainDataKind kind, std::string_view strDomainName, const xml::tag& domain_opening_tag, text_istream& is, binary_ostream& os);
+	std::optional<domain_datum> constant_domain_data(camaas_constant_fn constant, std::string_view strDomainName, ConstantDomainDataId id);
+	domain_data_map constant_domain_data_map(camaas_constant_fn constant, ConstantDomainDataId id);
+	std::string invalid_data_message() const;
+	void unload() noexcept;
+};
+
+#endif //XML2BIN_PLUGIN_DOMAIN_CONVERTER_H_
@@ -0,0 +1,60 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "precompiled_model.h"
+
+//Layout of a precompiled model: PRECOMPILED_MODEL_MAGIC, PRECOMPILED_MODEL_FORMAT_VERSION, position and size of the manifest
+//(uint64 each) followed by the serialized objects and the manifest
+static constexpr char PRECOMPILED_MODEL_MAGIC[4] = {'X', '2', 'B', 'P'};
+static constexpr std::uint32_t PRECOMPILED_MODEL_FORMAT_VERSION = 1;
+static constexpr std::size_t PRECOMPILED_MODEL_MANIFEST_POS_OFFSET = sizeof(PRECOMPILED_MODEL_MAGIC) + sizeof(std::uint32_t);
+static constexpr std::size_t PRECOMPILED_MODEL_HEADER_SIZE = PRECOMPILED_MODEL_MANIFEST_POS_OFFSET + 2 * sizeof(std::uint64_t);
+
+precompiled_model::precompiled_model(const std::string& strPath):m_file(strPath)
+{
+	auto invalid_model = [&strPath]() -> std::runtime_error
+	{
+		return std::runtime_error("Invalid precompiled model \"" + strPath + "\".");
+	};
+	if (m_file.size() < PRECOMPILED_MODEL_HEADER_SIZE || std::memcmp(m_file.data(), PRECOMPILED_MODEL_MAGIC, sizeof(PRECOMPILED_MODEL_MAGIC)) != 0)
+		throw invalid_model();
+	std::uint32_t format_version;
+	std::uint64_t manifest_pos, cbManifest;
+	std::memcpy(&format_version, m_file.data() + sizeof(PRECOMPILED_MODEL_MAGIC), sizeof(format_version));
+	std::memcpy(&manifest_pos, m_file.data() + PRECOMPILED_MODEL_MANIFEST_POS_OFFSET, sizeof(manifest_pos));
+	std::memcpy(&cbManifest, m_file.data() + PRECOMPILED_MODEL_MANIFEST_POS_OFFSET + sizeof(manifest_pos), sizeof(cbManifest));
+	if (format_version != PRECOMPILED_MODEL_FORMAT_VERSION)
+		throw std::runtime_error("The precompiled model \"" + strPath + "\" has been created by an incompatible version of the program.");
+	if (manifest_pos < PRECOMPILED_MODEL_HEADER_SIZE || manifest_pos > m_file.size() || cbManifest != m_file.size() - manifest_pos
+		|| !read_incremental_manifest(m_file.data() + manifest_pos, std::size_t(cbManifest), m_manifest)
+		|| m_manifest.inputs.size() != 1 || m_manifest.output_size != manifest_pos)
+		throw invalid_model();
+	for (const auto& object:m_manifest.inputs.front().objects)
+	{
+		if (object.offset < PRECOMPILED_MODEL_HEADER_SIZE || object.offset > manifest_pos || object.size > manifest_pos - object.offset)
+			throw invalid_model();
+	}
+}
+
+bool precompiled_model::is_precompiled_model(const std::string& strPath)
+{
+	std::ifstream is(strPath, std::ios_base::in | std::ios_base::binary);
+	char magic[sizeof(PRECOMPILED_MODEL_MAGIC)];
+	return is.read(magic, sizeof(magic)) && std::memcmp(magic, PRECOMPILED_MODEL_MAGIC, sizeof(magic)) == 0;
+}
+
+void begin_precompiled_model(binary_ostream& os)
+{
+	os.write(PRECOMPILED_MODEL_MAGIC, sizeof(PRECOMPILED_MODEL_MAGIC));
+	os << PRECOMPILED_MODEL_FORMAT_VERSION << std::uint64_t() << std::uint64_t();
+}
+
+void end_precompiled_model(binary_ostream& os, binary_ostream::pos_type header_pos, const std::string& strDomain, const INCREMENTAL_INPUT& contents)
+{
+	auto manifest_pos = os.tellp();
+	write_incremental_manifest(os, INCREMENTAL_MANIFEST{strDomain, std::uint64_t(manifest_pos - header_pos), {contents}});
+	auto end_pos = os.tellp();
+	os.seekp(header_pos + PRECOMPILED_MODEL_MANIFEST_POS_OFFSET);
+	os << std::uint64_t(manifest_pos - header_pos) << std::uint64_t(end_pos - manifest_pos);
+	os.seekp(end_pos);
+}
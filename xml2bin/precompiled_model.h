@@ -0,0 +1,39 @@
+#include <string>
+#include <binary_streams.h>
+#include <mapped_file.h>
+#include "incremental_manifest.h"
+
+#ifndef XML2BIN_PRECOMPILED_MODEL_H_
+#define XML2BIN_PRECOMPILED_MODEL_H_
+
+//A precompiled model holds the model attributes and the serialized objects specified by a set of XML files converted for a domain.
+//It is mapped to memory, and its objects are written to the output as they are, so that the XML files need not be parsed again.
+//The objects are described by an embedded manifest with a single input (see incremental_manifest.h).
+class precompiled_model
+{
+	mapped_file m_file;
+	INCREMENTAL_MANIFEST m_manifest;
+public:
+	explicit precompiled_model(const std::string& strPath); //throws std::runtime_error, if the file is not a valid precompiled model
+	static bool is_precompiled_model(const std::string& strPath);
+	inline const std::string& domain() const
+	{
+		return m_manifest.domain;
+	}
+	//offsets of the objects are relative to data()
+	inline const INCREMENTAL_INPUT& contents() const
+	{
+		return m_manifest.inputs.front();
+	}
+	inline const std::uint8_t* data() const
+	{
+		return m_file.data();
+	}
+};
+
+//Writes a precompiled model to os: the header is written by begin_precompiled_model, then the caller writes the serialized objects,
+//and end_precompiled_model writes the manifest. Offsets of the objects in contents are relative to the header position.
+void begin_precompiled_model(binary_ostream& os);
+void end_precompiled_model(binary_ostream& os, binary_ostream::pos_type header_pos, const std::string& strDomain, const INCREMENTAL_INPUT& contents);
+
+#endif //XML2BIN_PRECOMPILED_MODEL_H_
@@ -156,7 +156,7 @@ struct AntennaTypeDefinition
 	{
 		std::string m_strExpr;
 		ExpressionFrequencyResponse() = default;
-		explicit ExpressionFrequencyResponse(const std::wstring& expr):m_strExpr(encode_string(expr)) {}
+		explicit ExpressionFrequencyResponse(const std::string& expr):m_strExpr(expr) {}
 	};
 	struct TableFrequencyResponse:FrequencyResponseGeneric
 	{
@@ -173,7 +173,7 @@ struct AntennaTypeDefinition
 	{
 		std::string m_strExpr;
 		ExpressionRadiationPattern() = default;
-		explicit ExpressionRadiationPattern(const std::wstring& expr):m_strExpr(encode_string(expr)) {}
+		explicit ExpressionRadiationPattern(const std::string& expr):m_strExpr(expr) {}
 	};
 	struct TableRadiationPattern:RadiationPatternGeneric
 	{
@@ -269,41 +269,41 @@ static MediumDefinition LoadMediumData(text_istream& is, const xml::tag& opening
 
 	bool fPermittivity = false, fPermeability = false, fConductivity = false,
 		fElectricLoss = false, fMagneticLoss = false;
-	assert(opening_tag.name() == L"medium");
+	assert(opening_tag.name() == "medium");
 	while (true)
 	{
 		auto tag = xml::tag(is);
 		if (tag.is_comment())
 			continue;
-		else if (tag.name() == L"permittivity")
+		else if (tag.name() == "permittivity")
 		{
 			medium.ePermittivity = xml::get_tag_value<double>(is, tag);
 			if (fPermittivity)
-				throw ambiguous_specification(is.get_resource_locator(), L"permittivity");
+				throw ambiguous_specification(is.get_resource_locator(), "permittivity");
 			fPermittivity = true;
-		}else if (tag.name() == L"permeability")
+		}else if (tag.name() == "permeability")
 		{
 			medium.ePermeability = xml::get_tag_value<double>(is, tag);
 			if (fPermeability)
-				throw ambiguous_specification(is.get_resource_locator(), L"permeability");
+				throw ambiguous_specification(is.get_resource_locator(), "permeability");
 			fPermeability = true;
-		}else if (tag.name() == L"conductivity")
+		}else if (tag.name() == "conductivity")
 		{
 			medium.eConductivity = xml::get_tag_value<double>(is, tag);
 			if (fConductivity)
-				throw ambiguous_specification(is.get_resource_locator(), L"conductivity");
+				throw ambiguous_specification(is.get_resource_locator(), "conductivity");
 			fConductivity = true;
-		}else if (tag.name() == L"electricLoss")
+		}else if (tag.name() == "electricLoss")
 		{
 			medium.eElectricLoss = xml::get_tag_value<double>(is, tag);
 			if (fElectricLoss)
-				throw ambiguous_specification(is.get_resource_locator(), L"electricLoss");
+				throw ambiguous_specification(is.get_resource_locator(), "electricLoss");
 			fElectricLoss = true;
-		}else if (tag.name() == L"magneticLoss")
+		}else if (tag.name() == "magneticLoss")
 		{
 			medium.eMagneticLoss = xml::get_tag_value<double>(is, tag);
 			if (fMagneticLoss)
-				throw ambiguous_specification(is.get_resource_locator(), L"magneticLoss");
+				throw ambiguous_specification(is.get_resource_locator(), "magneticLoss");
 			fMagneticLoss = true;
 		}else if (tag.name() == opening_tag.name() && tag.is_closing_tag() && !tag.is_unary_tag())
 			break;
@@ -326,33 +326,33 @@ static ModelMediumDefinition LoadModelMediumData(text_istream& is, const xml::ta
 {
 	bool fRefractionChange = false, fMedium = false;
 	ModelMediumDefinition result;
-	assert(opening_tag.name() == L"modelMedium");
+	assert(opening_tag.name() == "modelMedium");
 	while (true)
 	{
 		auto tag = xml::tag(is);
 		if (tag.is_comment())
 			continue;
-		else if (tag.name() == L"refractionChange")
+		else if (tag.name() == "refractionChange")
 		{
 			result.eRefractionChange = xml::get_tag_value<double>(is, tag);
 			if (fRefractionChange)
-				throw ambiguous_specification(is.get_resource_locator(), L"refractionChange");
+				throw ambiguous_specification(is.get_resource_locator(), "refractionChange");
 			fRefractionChange = true;
-		}else if (tag.name() == L"medium")
+		}else if (tag.name() == "medium")
 		{
 			if (fMedium)
-				throw ambiguous_specification(is.get_resource_locator(), L"medium");
+				throw ambiguous_specification(is.get_resource_locator(), "medium");
 			result.medium = LoadMediumData(is, tag);
 			fMedium = true;
-		}else if (tag.name() == L"modelMedium" && tag.is_closing_tag() && !tag.is_unary_tag())
+		}else if (tag.name() == "modelMedium" && tag.is_closing_tag() && !tag.is_unary_tag())
 			break;
 		else if (!tag.is_comment())
 			throw improper_xml_tag(is.get_resource_locator(), tag.name());
 	}
 	if (!fRefractionChange)
-		throw xml_tag_not_found(is.get_resource_locator(), L"refractionChange");
+		throw xml_tag_not_found(is.get_resource_locator(), "refractionChange");
 	if (!fMedium)
-		throw xml_tag_not_found(is.get_resource_locator(), L"medium");
+		throw xml_tag_not_found(is.get_resource_locator(), "medium");
 	return result;
 }
 
@@ -372,39 +372,39 @@ static ModelDomainData LoadModelDomainData(text_istream& is, const xml::tag& ope
 		auto tag = xml::tag(is);
 		if (tag.is_comment())
 			continue;
-		else if (tag.name() == L"minimalFieldAmplitude")
+		else if (tag.name() == "minimalFieldAmplitude")
 		{
 			result.SetMinimalFieldAmplitude(xml::get_tag_value<double>(is, tag));
 			if (fMinimalFieldAmplitude)
-				throw ambiguous_specification(is.get_resource_locator(), L"minimalFieldAmplitude");
+				throw ambiguous_specification(is.get_resource_locator(), "minimalFieldAmplitude");
 			fMinimalFieldAmplitude = true;
-		}else if (tag.name() == L"iterationAverageResultingChange")
+		}else if (tag.name() == "iterationAverageResultingChange")
 		{
 			result.SetIterationChange(xml::get_tag_value<double>(is, tag));
 			if (fAverageIterationChange)
-				throw ambiguous_specification(is.get_resource_locator(), L"iterationAverageResultingChange");
+				throw ambiguous_specification(is.get_resource_locator(), "iterationAverageResultingChange");
 			fAverageIterationChange = true;
-		}else if (tag.name() == L"iterationAverageResultingStep")
+		}else if (tag.name() == "iterationAverageResultingStep")
 		{
 			result.SetIterationStep(xml::get_tag_value<unsigned>(is, tag));
 			if (fIterationCheckStep)
-				throw ambiguous_specification(is.get_resource_locator(), L"iterationAverageResultingChange");
+				throw ambiguous_specification(is.get_resource_locator(), "iterationAverageResultingChange");
 			fIterationCheckStep = true;
-		}else if (tag.name() == L"frequencySet")
+		}else if (tag.name() == "frequencySet")
 		{
 			if (tag.is_closing_tag() || tag.is_unary_tag())
 				throw improper_xml_tag(is.get_resource_locator(), tag.name());
 			if (fSpectrum)
-				throw ambiguous_specification(is.get_resource_locator(), L"frequencySet");
+				throw ambiguous_specification(is.get_resource_locator(), "frequencySet");
 			std::list<double> lstSpectrum;
 			while (true)
 			{
 				tag = xml::tag(is);
 				if (tag.is_comment())
 					continue;
-				else if (tag.name() == L"frequency")
+				else if (tag.name() == "frequency")
 					lstSpectrum.emplace_back(xml::get_tag_value<double>(is, tag));
-				else if (tag.name() == L"frequencySet")
+				else if (tag.name() == "frequencySet")
 				{
 					if (!tag.is_closing_tag())
 						throw improper_xml_tag(is.get_resource_locator(), tag.name());
@@ -413,57 +413,57 @@ static ModelDomainData LoadModelDomainData(text_istream& is, const xml::tag& ope
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 			}
 			if (lstSpectrum.empty())
-				throw improper_xml_tag(is.get_resource_locator(), L"frequencySet");
+				throw improper_xml_tag(is.get_resource_locator(), "frequencySet");
 			result.SetFrequencySet(ModelDomainData::FrequencySet(std::move(lstSpectrum)));
 			fSpectrum = true;
-		}else if (tag.name() == L"frequencyRange")
+		}else if (tag.name() == "frequencyRange")
 		{
 			bool fRangeMin = false, fRangeMax = false, fRangeStep = false;
 			double eRangeMin, eRangeMax, eRangeStep;
 			if (tag.is_closing_tag() || tag.is_unary_tag())
 				throw improper_xml_tag(is.get_resource_locator(), tag.name());
 			if (fSpectrum)
-				throw ambiguous_specification(is.get_resource_locator(), L"frequencyRange");
+				throw ambiguous_specification(is.get_resource_locator(), "frequencyRange");
 			while (true)
 			{
 				tag = xml::tag(is);
 				if (tag.is_comment())
 					continue;
-				else if (tag.name() == L"min")
+				else if (tag.name() == "min")
 				{
 					if (fRangeMin)
-						throw ambiguous_specification(is.get_resource_locator(), L"min");
+						throw ambiguous_specification(is.get_resource_locator(), "min");
 					eRangeMin = xml::get_tag_value<double>(is, tag);
 					fRangeMin = true;
-				}else if (tag.name() == L"max")
+				}else if (tag.name() == "max")
 				{
 					if (fRangeMax)
-						throw ambiguous_specification(is.get_resource_locator(), L"max");
+						throw ambiguous_specification(is.get_resource_locator(), "max");
 					eRangeMax = xml::get_tag_value<double>(is, tag);
 					fRangeMax = true;
-				}else if (tag.name() == L"step")
+				}else if (tag.name() == "step")
 				{
 					if (fRangeStep)
-						throw ambiguous_specification(is.get_resource_locator(), L"step");
+						throw ambiguous_specification(is.get_resource_locator(), "step");
 					eRangeStep = xml::get_tag_value<double>(is, tag);
 					fRangeStep = true;
-				}else if (tag.name() == L"frequencyRange" && tag.is_closing_tag() && !tag.is_unary_tag())
+				}else if (tag.name() == "frequencyRange" && tag.is_closing_tag() && !tag.is_unary_tag())
 					break;
 				else if (!tag.is_comment())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 			}
 			if (!fRangeMin)
-				throw xml_tag_not_found(is.get_resource_locator(), L"min");
+				throw xml_tag_not_found(is.get_resource_locator(), "min");
 			if (!fRangeMax)
-				throw xml_tag_not_found(is.get_resource_locator(), L"max");
+				throw xml_tag_not_found(is.get_resource_locator(), "max");
 			if (!fRangeStep)
-				throw xml_tag_not_found(is.get_resource_locator(), L"step");
+				throw xml_tag_not_found(is.get_resource_locator(), "step");
 			result.SetFrequencySet(ModelDomainData::FrequencyRange{eRangeMin, eRangeMax, eRangeStep});
 			fSpectrum = true;
-		}else if (tag.name() == L"modelMedium")
+		}else if (tag.name() == "modelMedium")
 		{
 			if (fModelMedium)
-				throw ambiguous_specification(is.get_resource_locator(), L"modelMedium");
+				throw ambiguous_specification(is.get_resource_locator(), "modelMedium");
 			result.SetModelDomainDefinition(LoadModelMediumData(is, tag));
 			fModelMedium = true;
 		}else if (tag.name() == opening_tag.name() && tag.is_closing_tag() && !tag.is_unary_tag())
@@ -472,15 +472,15 @@ static ModelDomainData LoadModelDomainData(text_istream& is, const xml::tag& ope
 			throw improper_xml_tag(is.get_resource_locator(), tag.name());
 	};
 	if (!fMinimalFieldAmplitude)
-		throw xml_tag_not_found(is.get_resource_locator(), L"minimalFieldAmplitude");
+		throw xml_tag_not_found(is.get_resource_locator(), "minimalFieldAmplitude");
 	if (!fAverageIterationChange)
-		throw xml_tag_not_found(is.get_resource_locator(), L"iterationAverageResultingChange");
+		throw xml_tag_not_found(is.get_resource_locator(), "iterationAverageResultingChange");
 	if (!fIterationCheckStep)
-		throw xml_tag_not_found(is.get_resource_locator(), L"iterationAverageResultingStep");
+		throw xml_tag_not_found(is.get_resource_locator(), "iterationAverageResultingStep");
 	if (!fSpectrum)
-		throw xml_tag_not_found(is.get_resource_locator(), L"frequencySet or frequencyRange");
+		throw xml_tag_not_found(is.get_resource_locator(), "frequencySet or frequencyRange");
 	if (!fModelMedium)
-		throw xml_tag_not_found(is.get_resource_locator(), L"modelMedium");
+		throw xml_tag_not_found(is.get_resource_locator(), "modelMedium");
 	return result;
 }
 
@@ -507,107 +507,107 @@ static binary_ostream& operator<<(binary_ostream& os, const ModelDomainData& def
 static AntennaTypeDefinition LoadAntennaType(text_istream& is, const xml::tag& opening_tag)
 {
 	bool fFrequencyResponseSpecified = false, fRadiationPatternSpecified = false, fAntennaGainSpecified = false, fPolarizationSpecified = false;
-	assert(opening_tag.name() == L"antenna_type");
+	assert(opening_tag.name() == "antenna_type");
 	AntennaTypeDefinition result;
 	while (true)
 	{
 		auto tag = xml::tag(is);
 		if (tag.is_comment())
 			continue;
-		else if (tag.name() == L"frequency_response")
+		else if (tag.name() == "frequency_response")
 		{
 			if (fFrequencyResponseSpecified)
-				throw ambiguous_specification(is.get_resource_locator(), L"frequency_response");
+				throw ambiguous_specification(is.get_resource_locator(), "frequency_response");
 			while (true)
 			{
 				tag = xml::tag(is);
 				if (tag.is_comment())
 					continue;
-				else if (tag.name() == L"expressionFrequencyResponse")
+				else if (tag.name() == "expressionFrequencyResponse")
 				{
 					if (fFrequencyResponseSpecified)
-						throw ambiguous_specification(is.get_resource_locator(), L"frequency_response");
-					result.SetFrequencyResponse(AntennaTypeDefinition::ExpressionFrequencyResponse(xml::get_tag_value<std::wstring>(is, tag)));
+						throw ambiguous_specification(is.get_resource_locator(), "frequency_response");
+					result.SetFrequencyResponse(AntennaTypeDefinition::ExpressionFrequencyResponse(xml::get_tag_value<std::string>(is, tag)));
 					fFrequencyResponseSpecified = true;
-				}else if (tag.name() == L"tableFrequencyResponse")
+				}else if (tag.name() == "tableFrequencyResponse")
 				{
 					if (fFrequencyResponseSpecified)
-						throw ambiguous_specification(is.get_resource_locator(), L"frequency_response");
+						throw ambiguous_specification(is.get_resource_locator(), "frequency_response");
 					AntennaTypeDefinition::TableFrequencyResponse::map_type fr;
 					while (true)
 					{
 						tag = xml::tag(is);
 						if (tag.is_comment())
 							continue;
-						else if (tag.name() == L"fr_row")
+						else if (tag.name() == "fr_row")
 						{
-							auto freq = tag.attribute(L"frequency");
+							auto freq = tag.attribute("frequency");
 							if (freq.empty())
-								throw xml_attribute_not_found(is.get_resource_locator(), L"frequency");
+								throw xml_attribute_not_found(is.get_resource_locator(), "frequency");
 							auto value = xml::get_tag_value<double>(is, tag);
 							if (!fr.emplace(std::stod(freq), value).second)
-								throw ambiguous_specification(is.get_resource_locator(), L"fr_row");
-						}else if (tag.name() == L"tableFrequencyResponse" && tag.is_closing_tag() && !tag.is_unary_tag())
+								throw ambiguous_specification(is.get_resource_locator(), "fr_row");
+						}else if (tag.name() == "tableFrequencyResponse" && tag.is_closing_tag() && !tag.is_unary_tag())
 							break;
 						else
 							throw improper_xml_tag(is.get_resource_locator(), tag.name());
 					}
 					result.SetFrequencyResponse(AntennaTypeDefinition::TableFrequencyResponse(std::move(fr)));
 					fFrequencyResponseSpecified = true;
-				}else if (tag.name() == L"frequency_response" && tag.is_closing_tag() && !tag.is_unary_tag())
+				}else if (tag.name() == "frequency_response" && tag.is_closing_tag() && !tag.is_unary_tag())
 					break;
 				else
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 			};
 			if (!fFrequencyResponseSpecified)
-				throw xml_tag_not_found(is.get_resource_locator(), L"expressionFrequencyResponse or tableFrequencyResponse");
-		}else if (tag.name() == L"radiation_pattern")
+				throw xml_tag_not_found(is.get_resource_locator(), "expressionFrequencyResponse or tableFrequencyResponse");
+		}else if (tag.name() == "radiation_pattern")
 		{
 			if (fRadiationPatternSpecified)
-				throw ambiguous_specification(is.get_resource_locator(), L"radiation_pattern");
+				throw ambiguous_specification(is.get_resource_locator(), "radiation_pattern");
 			while (true)
 			{
 				tag = xml::tag(is);
 				if (tag.is_comment())
 					continue;
-				else if (tag.name() == L"expressionRadiationPattern")
+				else if (tag.name() == "expressionRadiationPattern")
 				{
 					if (fRadiationPatternSpecified)
-						throw ambiguous_specification(is.get_resource_locator(), L"radiation_pattern");
-					result.SetRadiationPattern(AntennaTypeDefinition::ExpressionRadiationPattern(xml::get_tag_value<std::wstring>(is, tag)));
+						throw ambiguous_specification(is.get_resource_locator(), "radiation_pattern");
+					result.SetRadiationPattern(AntennaTypeDefinition::ExpressionRadiationPattern(xml::get_tag_value<std::string>(is, tag)));
 					fRadiationPatternSpecified = true;
-				}else if (tag.name() == L"tableRadiationPattern")
+				}else if (tag.name() == "tableRadiationPattern")
 				{
 					if (fRadiationPatternSpecified)
-						throw ambiguous_specification(is.get_resource_locator(), L"radiation_pattern");
+						throw ambiguous_specification(is.get_resource_locator(), "radiation_pattern");
 					AntennaTypeDefinition::TableRadiationPattern::map_type rp;
 					while (true)
 					{
 						tag = xml::tag(is);
 						if (tag.is_comment())
 							continue;
-						else if (tag.name() == L"rp_row")
+						else if (tag.name() == "rp_row")
 						{
-							auto freq = tag.attribute(L"frequency");
+							auto freq = tag.attribute("frequency");
 							if (freq.empty())
-								throw xml_attribute_not_found(is.get_resource_locator(), L"frequency");
-							auto az = tag.attribute(L"azimuth");
+								throw xml_attribute_not_found(is.get_resource_locator(), "frequency");
+							auto az = tag.attribute("azimuth");
 							if (az.empty())
-								throw xml_attribute_not_found(is.get_resource_locator(), L"azimuth");
-							auto zn = tag.attribute(L"zenith");
+								throw xml_attribute_not_found(is.get_resource_locator(), "azimuth");
+							auto zn = tag.attribute("zenith");
 							if (zn.empty())
-								throw xml_attribute_not_found(is.get_resource_locator(), L"zenith");
+								throw xml_attribute_not_found(is.get_resource_locator(), "zenith");
 							auto value = xml::get_tag_value<double>(is, tag);
 							if (!rp.emplace(std::make_tuple(std::stod(freq), std::stod(az), std::stod(zn)), value).second)
-								throw ambiguous_specification(is.get_resource_locator(), L"rp_row");
-						}else if (tag.name() == L"tableRadiationPattern" && tag.is_closing_tag() && !tag.is_unary_tag())
+								throw ambiguous_specification(is.get_resource_locator(), "rp_row");
+						}else if (tag.name() == "tableRadiationPattern" && tag.is_closing_tag() && !tag.is_unary_tag())
 							break;
 						else
 							throw improper_xml_tag(is.get_resource_locator(), tag.name());
 					}
 					result.SetRadiationPattern(AntennaTypeDefinition::TableRadiationPattern(std::move(rp)));
 					fRadiationPatternSpecified = true;
-				}else if (tag.name() == L"radiation_pattern")
+				}else if (tag.name() == "radiation_pattern")
 				{
 					if (!tag.is_closing_tag() || tag.is_unary_tag())
 						throw improper_xml_tag(is.get_resource_locator(), tag.name());
@@ -616,8 +616,8 @@ static AntennaTypeDefinition LoadAntennaType(text_istream& is, const xml::tag& o
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 			};
 			if (!fRadiationPatternSpecified)
-				throw xml_tag_not_found(is.get_resource_locator(), L"expressionRadiationPattern or tableRadiationPattern");
-		}else if (tag.name() == L"antenna_gain")
+				throw xml_tag_not_found(is.get_resource_locator(), "expressionRadiationPattern or tableRadiationPattern");
+		}else if (tag.name() == "antenna_gain")
 		{
 			if (fAntennaGainSpecified)
 				throw ambiguous_specification(is.get_resource_locator(), tag.name());
@@ -628,44 +628,44 @@ static AntennaTypeDefinition LoadAntennaType(text_istream& is, const xml::tag& o
 				tag = xml::tag(is);
 				if (tag.is_comment())
 					continue;
-				else if (tag.name() == L"magnitude")
+				else if (tag.name() == "magnitude")
 				{
 					if (fMagnitudeSpecified)
 						throw ambiguous_specification(is.get_resource_locator(), tag.name());
 					eMagnitude = xml::get_tag_value<double>(is, tag);
 					fMagnitudeSpecified = true;
-				}else if (tag.name() == L"phase")
+				}else if (tag.name() == "phase")
 				{
 					if (fPhaseSpecified)
 						throw ambiguous_specification(is.get_resource_locator(), tag.name());
 					ePhase = xml::get_tag_value<double>(is, tag);
 					fPhaseSpecified = true;
-				}else if (tag.name() == L"antenna_gain" && tag.is_closing_tag() && !tag.is_unary_tag())
+				}else if (tag.name() == "antenna_gain" && tag.is_closing_tag() && !tag.is_unary_tag())
 					break;
 				else
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 			};
 			result.SetGainAmplitude(eMagnitude).SetGainPhase(ePhase);
 			fAntennaGainSpecified = true;
-		}else if (tag.name() == L"polarization_angle")
+		}else if (tag.name() == "polarization_angle")
 		{
 			if (fPolarizationSpecified)
 				throw ambiguous_specification(is.get_resource_locator(), tag.name());
 			result.SetPolarization(xml::get_tag_value<double>(is, tag));
 			fPolarizationSpecified = true;
-		}else if (tag.name() == L"antenna_type" && tag.is_closing_tag() && !tag.is_unary_tag())
+		}else if (tag.name() == "antenna_type" && tag.is_closing_tag() && !tag.is_unary_tag())
 			break;
 		else
 			throw improper_xml_tag(is.get_resource_locator(), tag.name());
 	}
 	if (!fFrequencyResponseSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"frequency_response");
+		throw xml_tag_not_found(is.get_resource_locator(), "frequency_response");
 	if (!fRadiationPatternSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"radiation_pattern");
+		throw xml_tag_not_found(is.get_resource_locator(), "radiation_pattern");
 	if (!fAntennaGainSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"antenna_gain");
+		throw xml_tag_not_found(is.get_resource_locator(), "antenna_gain");
 	if (!fPolarizationSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"polarization_angle");
+		throw xml_tag_not_found(is.get_resource_locator(), "polarization_angle");
 	return result;
 }
 
@@ -708,25 +708,25 @@ static AntennaDefinition LoadAntenna(text_istream& is, const xml::tag& opening_t
 {
 	AntennaDefinition result;
 	bool fAntennaTypeSpecified = false;
-	assert(opening_tag.name() == L"antenna");
+	assert(opening_tag.name() == "antenna");
 	while (true)
 	{
 		auto tag = xml::tag(is);
 		if (tag.is_comment())
 			continue;
-		else if (tag.name() == L"antenna_type")
+		else if (tag.name() == "antenna_type")
 		{
 			if (fAntennaTypeSpecified)
 				throw ambiguous_specification(is.get_resource_locator(), tag.name());
 			result.m_type = LoadAntennaType(is, tag);
 			fAntennaTypeSpecified = true;
-		}else if (tag.name() == L"antenna" && tag.is_closing_tag() && !tag.is_unary_tag())
+		}else if (tag.name() == "antenna" && tag.is_closing_tag() && !tag.is_unary_tag())
 			break;
 		else
 			throw improper_xml_tag(is.get_resource_locator(), tag.name());
 	}
 	if (!fAntennaTypeSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"antenna_type");
+		throw xml_tag_not_found(is.get_resource_locator(), "antenna_type");
 	return result;
 }
 
@@ -744,13 +744,13 @@ static SourceDomainDataDefinition LoadSourceDomainData(text_istream& is, const x
 		auto tag = xml::tag(is);
 		if (tag.is_comment())
 			continue;
-		else if (tag.name() == L"antenna")
+		else if (tag.name() == "antenna")
 		{
 			if (fAntennaSpecified)
 				throw ambiguous_specification(is.get_resource_locator(), tag.name());
 			result.antenna = LoadAntenna(is, tag);
 			fAntennaSpecified = true;
-		}else if (tag.name() == L"input_power")
+		}else if (tag.name() == "input_power")
 		{
 			if (fPowerSpecified)
 				throw ambiguous_specification(is.get_resource_locator(), tag.name());
@@ -762,9 +762,9 @@ static SourceDomainDataDefinition LoadSourceDomainData(text_istream& is, const x
 			throw improper_xml_tag(is.get_resource_locator(), tag.name());
 	}
 	if (!fAntennaSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"antenna");
+		throw xml_tag_not_found(is.get_resource_locator(), "antenna");
 	if (!fPowerSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"input_power");
+		throw xml_tag_not_found(is.get_resource_locator(), "input_power");
 	return result;
 }
 
@@ -782,7 +782,7 @@ static PolyDomainDataDefinition LoadPolyDomainData(text_istream& is, const xml::
 		auto tag = xml::tag(is);
 		if (tag.is_comment())
 			continue;
-		else if (tag.name() == L"medium")
+		else if (tag.name() == "medium")
 		{
 			if (fMediumSpecified)
 				throw ambiguous_specification(is.get_resource_locator(), tag.name());
@@ -794,7 +794,7 @@ static PolyDomainDataDefinition LoadPolyDomainData(text_istream& is, const xml::
 			throw improper_xml_tag(is.get_resource_locator(), tag.name());
 	}
 	if (!fMediumSpecified)
-		throw xml_tag_not_found(is.get_resource_locator(), L"medium");
+		throw xml_tag_not_found(is.get_resource_locator(), "medium");
 	return result;
 }
 
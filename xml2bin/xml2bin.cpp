@@ -4,18 +4,27 @@
 #include <list>
 #include <fstream>
 #include <optional>
-#include <codecvt>
-#include <locale>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cctype>
 #include <basedefs.h>
 #include "xml2bin.h"
 #include "radio_hf_domain_xml2bin.h"
 #include "arch_ac_domain_xml2bin.h"
 #include "domain_converter.h"
 #include "hgt_optimizer.h"
+#include "hgt_cache.h"
+#include "incremental_manifest.h"
+#include "precompiled_model.h"
+#include "conversion_stats.h"
+#include "plugin_domain_converter.h"
+#include <model_index.h>
 #include <xml_parser.h>
 #include <binary_streams.h>
 #include <text_streams.h>
 #include <point.h>
+#include <report_format.h>
 #if CPP17_FILESYSTEM_SUPPORT
 #include <filesystem>
 #endif
@@ -60,11 +69,19 @@ class conversion_state_impl:public Implementation::conversion_state
 	binary_ostream* m_pOs = nullptr;
 	std::istream* m_pHgt = nullptr;
 	HGT_RESOLUTION_DATA m_hgt_res = {double(), double(), std::size_t(), std::size_t()};
+	HGT_CONVERSION_OPTIONS m_hgt_options;
 	point_t m_size = unspecified_point();
 	std::string m_strModelName;
 
-	typedef std::map<std::string, std::vector<std::uint8_t>> domain_data_map;
-	domain_data_map m_mapDomainData;
+	std::map<std::string, std::vector<std::uint8_t>> m_mapDomainData; //of the model
+
+	//a serialized object of an unchanged input (a range of the previous output) or of a precompiled model (a block of its mapping)
+	struct serialized_object
+	{
+		const std::uint8_t* pData; //null, if the object is in the previous output
+		std::uint64_t offset; //position in the previous output
+		std::uint64_t size;
+	};
 
 	struct poly_data
 	{
@@ -76,6 +93,8 @@ class conversion_state_impl:public Implementation::conversion_state
 		std::string name;
 		std::list<face_data> lstFaces;
 		domain_data_map mapDomainData;
+		std::size_t iInput = 0; //index of the input specifying the object
+		std::optional<serialized_object> serialized; //set, if the object is written as it is
 	};
 	std::map<std::string, poly_data> m_polyNamedMap;
 	std::list<poly_data> m_polyUnnamedList;
@@ -87,6 +106,8 @@ class conversion_state_impl:public Implementation::conversion_state
 		point_t top = unspecified_point();
 		domain_data_map mapDomainData;
 		std::string name;
+		std::size_t iInput = 0;
+		std::optional<serialized_object> serialized;
 	};
 	std::map<std::string, source_data> m_srcNamedMap;
 	std::list<source_data> m_srcUnnamedList;
@@ -98,132 +119,649 @@ class conversion_state_impl:public Implementation::conversion_state
 		point_t v2 = unspecified_point();
 		domain_data_map mapDomainData;
 		std::string name;
+		std::size_t iInput = 0;
+		std::optional<serialized_object> serialized;
 	};
 	std::map<std::string, plain_data> m_plainNamedMap;
 	std::list<plain_data> m_plainUnnamedList;
-	std::unique_ptr<IDomainConverter> m_pConv;
+	typedef converter_registry<radio_hf_convert, arch_ac_convert> converters_type;
+	converters_type m_converters; //converts the domain data of the objects
+	std::vector<std::shared_ptr<plugin_domain_converter>> m_vPlugins; //the converters of m_converters loaded at runtime
+	domain_data_cache m_domain_data_cache; //the domain data converted, shared by the objects
+	struct domain_output
+	{
+		std::string domain;
+		binary_ostream* pOs;
+		std::shared_ptr<IDomainConverter> pConv; //writes the constant domain data
+	};
+	std::vector<domain_output> m_vOutputs; //of each domain converted
+	std::string m_strDomain; //of the output being written (m_pOs)
+
+	std::vector<INCREMENTAL_INPUT> m_vInputs; //describe the output being written
+	bool m_fIncremental = false;
+	INCREMENTAL_MANIFEST m_previous; //describes the previous output, if the incremental conversion is performed
+	std::ifstream m_isPrevious;
+	std::list<precompiled_model> m_lstPrecompiled;
+	std::unique_ptr<char[]> m_pCopyBuf;
+	std::uint64_t m_cbOutput = 0;
+	MODEL_OUTPUT_OPTIONS m_output_options;
+	CONVERSION_STATS* m_pStats = nullptr; //if set, the statistics of the conversion are collected
+	static constexpr std::size_t PREVIOUS_OUTPUT_COPY_BLOCK = std::size_t(1) << 20;
 public:
-	conversion_state_impl(std::string_view domain, binary_ostream& os):m_pOs(std::addressof(os))
+	conversion_state_impl(std::string_view domain, binary_ostream& os, const MODEL_OUTPUT_OPTIONS& output_options = MODEL_OUTPUT_OPTIONS())
+		:m_pOs(std::addressof(os)), m_strDomain(domain), m_output_options(output_options), m_pStats(output_options.pStats)
 	{
-		if (domain == radio_hf_convert::domain_name())
-			m_pConv.reset(new ConverterImpl<radio_hf_convert>(radio_hf_convert()));
-		else if (domain == arch_ac_convert::domain_name())
-			m_pConv.reset(new ConverterImpl<arch_ac_convert>(arch_ac_convert()));
-		else
-			throw std::invalid_argument("Unknown domain name");
+		this->load_domain_plugins();
+		m_converters.enable_only(this->add_output(domain, os));
 	}
-	explicit conversion_state_impl(binary_ostream& os):m_pOs(std::addressof(os))
+	//the inputs are converted for each domain of the outputs at once
+	conversion_state_impl(const std::vector<DOMAIN_OUTPUT>& outputs, const MODEL_OUTPUT_OPTIONS& output_options)
+		:m_output_options(output_options), m_pStats(output_options.pStats)
 	{
-		m_pConv.reset(new generalized_converter(std::make_tuple(
-			radio_hf_convert::domain_name(),	radio_hf_convert(),
-			arch_ac_convert::domain_name(),		arch_ac_convert()
-		)));
+		if (outputs.empty())
+			throw std::invalid_argument("No domain is specified");
+		this->load_domain_plugins();
+		for (const auto& output:outputs)
+		{
+			if (std::any_of(m_vOutputs.begin(), m_vOutputs.end(), [&output](const domain_output& added) -> bool {return added.domain == output.domain;}))
+				throw std::invalid_argument("The domain \"" + output.domain + "\" is specified more than once.");
+			auto iConverter = this->add_output(output.domain, *output.pOs);
+			if (m_vOutputs.size() == 1)
+				m_converters.enable_only(iConverter);
+			else
+				m_converters.enable(iConverter);
+		}
+		this->select_output(m_vOutputs.front());
 	}
 	conversion_state_impl(const conversion_state_impl&) = delete;
 	conversion_state_impl& operator=(const conversion_state_impl&) = delete;
 
 	void next_xml(text_istream& is)
+	{
+		this->next_xml(is, std::chrono::steady_clock::now());
+	}
+	//open_start is the time the opening of the input has started at
+	void next_xml(text_istream& is, std::chrono::steady_clock::time_point open_start)
 	{
 		using namespace std;
 		xml::tag tag;
-		const std::pair<TextEncoding, std::wstring> pTestEncoding[] =
-		{
-			{TextEncoding::UTF8, std::wstring(L"UTF-8")},
-			{TextEncoding::UTF16LE, std::wstring(L"UTF-16LE")},
-			{TextEncoding::UTF16BE, std::wstring(L"UTF-16BE")},
-			{TextEncoding::Windows_1251, std::wstring(L"windows-1251")}
-		};
-		auto start_pos = is.tellg();
-		int cur_enc;
-		tag = xml::tag(is, xml::tag::nothrow);
-		if (is.fail())
-		{
-			cur_enc = 0;
-			do
-			{
-				is.clear();
-				is.seekg(start_pos);
-				if (is.fail())
-					throw xml_invalid_syntax();
-				if (!is.set_encoding(pTestEncoding[cur_enc++].first).fail())
-				{
-					tag = xml::tag(is, xml::tag::nothrow);
-					if (!is.fail())
-						break;
-				}
-			}while (cur_enc < int(sizeof(pTestEncoding) / sizeof(TextEncoding)));
-		}
+		m_vInputs.emplace_back(INCREMENTAL_INPUT{std::string(), 0, unspecified_point()});
+		if (m_pStats)
+			m_pStats->inputs.emplace_back(CONVERSION_STATS::INPUT{std::string(), "xml"});
+		//the text is decoded from the start in the encoding detected from its bytes (see text_istream::use_bom) or specified by the
+		//caller, which the XML declaration must agree with
+		tag = xml::tag(is);
 		while (tag.is_comment())
 			tag = xml::tag(is);
 		if (!tag.is_header())
-			throw invalid_xml_model(L"XML header is not specified");
-		for (cur_enc = 0; cur_enc < int(sizeof(pTestEncoding) / sizeof(TextEncoding)); ++cur_enc)
-		{
-			const auto& enc1 = tag.attribute(L"encoding");
-			const auto& enc2 = pTestEncoding[cur_enc].second;
-			if (std::equal(std::begin(enc1), std::end(enc1), std::begin(enc2), std::end(enc2), 
-				[](wchar_t chl, wchar_t chr) -> bool {return std::towupper(chl) == std::towupper(chr);})) 
-			{
-				is.set_encoding(pTestEncoding[cur_enc].first);
-				break;
-			}
-		}
-		if (cur_enc == int(sizeof(pTestEncoding) / sizeof(TextEncoding)))
-			throw invalid_xml_model(is.get_resource_locator(), L"Unknown or unspecified XML encoding");
+			throw invalid_xml_model("XML header is not specified");
+		const auto& strEncoding = tag.attribute("encoding");
+		auto encoding = xml_encoding_by_name(strEncoding);
+		if (!encoding)
+			throw invalid_xml_model(is.get_resource_locator(), "Unknown or unspecified XML encoding");
+		if (xml_encoding_name(*encoding) != xml_encoding_name(is.encoding()))
+			throw invalid_xml_model(is.get_resource_locator(), "The XML encoding \"" + strEncoding + "\" differs from the encoding of the text (" 
+				+ std::string(xml_encoding_name(is.encoding())) + ")");
 		while ((tag = xml::tag(is)).is_comment()) continue;
-		if (tag.name() != L"model")
+		if (tag.name() != "model")
 			throw improper_xml_tag(is.get_resource_locator(), tag.name());
+		if (!m_pStats)
+		{
+			this->convert_model(tag, is);
+			return;
+		}
+		auto& input = m_pStats->inputs.back();
+		input.encoding = xml_encoding_name(*encoding);
+		input.open_time = seconds_since(open_start);
+		auto parse_start = std::chrono::steady_clock::now();
 		this->convert_model(tag, is);
+		m_pStats->inputs.back().parse_time = seconds_since(parse_start);
 	}
-	void next_hgt(const HGT_RESOLUTION_DATA& resolution, std::istream& is)
+	void next_hgt(const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, std::istream& is)
 	{
 		m_pHgt = std::addressof(is); //do it in finalize directly to pOs
 		m_hgt_res = resolution;
+		m_hgt_options = options;
+	}
+	//the previous output is used only if it is the one described by the manifest
+	void load_manifest(const std::string& strManifest, const std::string& strPreviousOutput)
+	{
+		if (m_vOutputs.size() > 1)
+			throw std::invalid_argument("The incremental conversion cannot be performed for several domains at once.");
+		m_fIncremental = true;
+		INCREMENTAL_MANIFEST manifest;
+		if (!read_incremental_manifest(strManifest, manifest) || manifest.domain != m_strDomain)
+			return;
+		std::error_code ec;
+		auto cbPrevious = std::filesystem::file_size(strPreviousOutput, ec);
+		if (ec || cbPrevious != manifest.output_size)
+			return;
+		m_isPrevious.open(strPreviousOutput, std::ios_base::in | std::ios_base::binary);
+		if (m_isPrevious.fail())
+			return;
+		m_previous = std::move(manifest);
+	}
+	//the file is either an XML file or a precompiled model. In the incremental conversion the objects of an unchanged file are copied
+	//from the previous output.
+	void next_file(const std::string& strPath)
+	{
+		auto open_start = std::chrono::steady_clock::now();
+		std::uint64_t hash = 0;
+		if (m_fIncremental)
+		{
+			hash = incremental_input_hash(strPath);
+			auto itPrevious = std::find_if(m_previous.inputs.begin(), m_previous.inputs.end(), 
+				[&strPath, hash](const INCREMENTAL_INPUT& input) -> bool {return input.hash == hash && input.path == strPath;});
+			if (itPrevious != m_previous.inputs.end())
+			{
+				this->next_serialized_input(*itPrevious, nullptr, open_start);
+				this->describe_input_file(strPath);
+				return;
+			}
+		}
+		if (precompiled_model::is_precompiled_model(strPath))
+		{
+			if (m_vOutputs.size() > 1)
+				throw std::invalid_argument("The precompiled model \"" + strPath + "\" cannot be converted for several domains at once.");
+			const auto& model = m_lstPrecompiled.emplace_back(strPath);
+			if (model.domain() != m_strDomain)
+				throw std::invalid_argument("The precompiled model \"" + strPath + "\" has been created for a different domain.");
+			this->next_serialized_input(model.contents(), model.data(), open_start);
+		}else
+		{
+			text_ifstream is(std::string_view{strPath});
+			if (is.fail())
+				throw std::runtime_error("Failed to open the file \"" + strPath + "\".");
+			this->next_xml(is, open_start);
+		}
+		m_vInputs.back().path = strPath;
+		m_vInputs.back().hash = hash;
+		this->describe_input_file(strPath);
+	}
+	INCREMENTAL_MANIFEST incremental_manifest() const
+	{
+		return INCREMENTAL_MANIFEST{m_strDomain, m_cbOutput, m_vInputs};
 	}
+	//writes the model of each domain to its output. The HGT surfaces are computed once for all outputs.
 	void finalize()
 	{
 		if (!this->is_model_ready())
 			throw input_not_ready();
+		auto serialization_start = std::chrono::steady_clock::now();
+		std::vector<model_layout> vLayouts;
+		for (const auto& output:m_vOutputs)
+			vLayouts.emplace_back(this->write_model(output));
+		m_isPrevious.close();
+		auto serialization_time = seconds_since(serialization_start);
+		if (m_pHgt)
+		{
+			auto hgt_start = std::chrono::steady_clock::now();
+			std::vector<HGT_OUTPUT> hgt_outputs;
+			for (const auto& output:m_vOutputs)
+				hgt_outputs.emplace_back(HGT_OUTPUT{output.pConv.get(), output.pOs});
+			auto vHgtStats = convert_hgt_cached(m_hgt_res, m_hgt_options, this->hgt_detail_areas(), *m_pHgt, hgt_outputs);
+			if (m_pStats)
+				this->describe_hgt(vHgtStats.front(), seconds_since(hgt_start));
+			auto fHgtSize = !is_specified(m_size);
+			if (fHgtSize)
+			{
+				m_size.x = m_hgt_res.cColumns * m_hgt_res.dx;
+				m_size.y = m_hgt_res.cRows * m_hgt_res.dy;
+				m_size.z = vHgtStats.front().max_height;
+			}
+			for (std::size_t iOutput = 0; iOutput < m_vOutputs.size(); ++iOutput)
+			{
+				this->select_output(m_vOutputs[iOutput]);
+				this->complete_hgt_model(vLayouts[iOutput], vHgtStats[iOutput], fHgtSize);
+			}
+		}
+		std::uint64_t cbModels = 0;
+		for (std::size_t iOutput = 0; iOutput < m_vOutputs.size(); ++iOutput)
+		{
+			this->select_output(m_vOutputs[iOutput]);
+			if (m_output_options.fObjectIndex)
+			{
+				auto index_start = std::chrono::steady_clock::now();
+				this->write_object_index(vLayouts[iOutput].model_pos, vLayouts[iOutput].vIndex);
+				serialization_time += seconds_since(index_start);
+			}
+			cbModels += std::uint64_t(m_pOs->tellp()) - std::uint64_t(vLayouts[iOutput].model_pos);
+		}
+		m_cbOutput = m_vOutputs.front().pOs->tellp();
+		if (m_pStats)
+			this->describe_output(serialization_time, cbModels);
+	}
+	//writes a precompiled model of the inputs instead of the binary model. The model attributes need not be specified.
+	void precompile()
+	{
+		if (m_vOutputs.size() > 1)
+			throw std::invalid_argument("A precompiled model cannot be written for several domains at once.");
+		auto serialization_start = std::chrono::steady_clock::now();
 		auto& os = *m_pOs;
+		auto header_pos = os.tellp();
+		begin_precompiled_model(os);
+		INCREMENTAL_INPUT contents{std::string(), 0, m_size, m_strModelName, m_mapDomainData};
+		this->write_objects([&contents, header_pos](std::size_t, INCREMENTAL_OBJECT&& object) -> void
+		{
+			object.offset -= header_pos;
+			contents.objects.emplace_back(std::move(object));
+		});
+		end_precompiled_model(os, header_pos, m_strDomain, contents);
+		m_isPrevious.close();
+		if (m_pStats)
+			this->describe_output(seconds_since(serialization_start), std::uint64_t(os.tellp()) - std::uint64_t(header_pos));
+	}
+private:
+	struct indexed_object
+	{
+		std::string name;
+		std::uint64_t offset; //position in the output stream
+		std::uint64_t size;
+	};
+	//positions in the output of the model and the objects written to it
+	struct model_layout
+	{
+		binary_ostream::pos_type model_pos;
+		binary_ostream::pos_type model_size_pos;
+		binary_ostream::pos_type object_count_pos;
+		std::uint32_t object_count;
+		std::vector<indexed_object> vIndex;
+	};
+	//the domains of the plugins are converted in addition to the built-in ones
+	void load_domain_plugins()
+	{
+		for (const auto& strPath:m_output_options.vDomainPlugins)
+		{
+			auto pPlugin = std::make_shared<plugin_domain_converter>(strPath);
+			if (m_converters.index_of(pPlugin->domain_name()) != converters_type::npos)
+				throw std::invalid_argument("The domain \"" + pPlugin->domain_name() + "\" of the plugin \"" + strPath + "\" is already defined.");
+			m_converters.add(*pPlugin);
+			m_vPlugins.emplace_back(std::move(pPlugin));
+		}
+	}
+	//returns the index of the converter of the domain in m_converters
+	std::size_t add_output(std::string_view domain, binary_ostream& os)
+	{
+		std::shared_ptr<IDomainConverter> pConv;
+		if (domain == radio_hf_convert::domain_name())
+			pConv = std::make_shared<ConverterImpl<radio_hf_convert>>(radio_hf_convert());
+		else if (domain == arch_ac_convert::domain_name())
+			pConv = std::make_shared<ConverterImpl<arch_ac_convert>>(arch_ac_convert());
+		else
+		{
+			auto itPlugin = std::find_if(m_vPlugins.begin(), m_vPlugins.end(), 
+				[domain](const std::shared_ptr<plugin_domain_converter>& pPlugin) -> bool {return pPlugin->domain_name() == domain;});
+			if (itPlugin == m_vPlugins.end())
+				throw std::invalid_argument("Unknown domain name");
+			pConv = *itPlugin;
+		}
+		m_vOutputs.emplace_back(domain_output{std::string(domain), std::addressof(os), std::move(pConv)});
+		return m_converters.index_of(domain);
+	}
+	void select_output(const domain_output& output)
+	{
+		m_pOs = output.pOs;
+		m_strDomain = output.domain;
+	}
+	//writes the model attributes and the objects to the output, which becomes the one being written. The objects of the inputs
+	//describe the first output.
+	model_layout write_model(const domain_output& output)
+	{
+		this->select_output(output);
+		auto& os = *m_pOs;
+		model_layout layout;
+		layout.model_pos = os.tellp();
 		this->write_sequence(m_strModelName);
 		this->write(CHU_METERS);
-		auto model_size_pos = os.tellp();
+		layout.model_size_pos = os.tellp();
 		this->write(m_size);
 		this->write(m_mapDomainData);
-		auto object_count = std::uint32_t(this->poly_count() + this->source_count() + this->plain_count());
-		auto object_count_pos = os.tellp();
-		os << object_count;
+		layout.object_count = std::uint32_t(this->poly_count() + this->source_count() + this->plain_count());
+		layout.object_count_pos = os.tellp();
+		os << layout.object_count;
+		auto fDescribe = std::addressof(output) == std::addressof(m_vOutputs.front());
+		this->write_objects([this, &layout, fDescribe](std::size_t iInput, INCREMENTAL_OBJECT&& object) -> void
+		{
+			if (m_output_options.fObjectIndex)
+				layout.vIndex.emplace_back(indexed_object{object.name, object.offset, object.size});
+			if (fDescribe)
+				m_vInputs[iInput].objects.emplace_back(std::move(object));
+		});
+		return layout;
+	}
+	//accounts for the HGT surfaces written after the model, the size of which is set by the surfaces, if fHgtSize is set
+	void complete_hgt_model(model_layout& layout, const HGT_CONVERSION_STATS& hgt_stats, bool fHgtSize)
+	{
+		auto& os = *m_pOs;
+		auto old_pos = os.tellp();
+		if (m_output_options.fObjectIndex)
+		{
+			for (unsigned iObject = 0; iObject < hgt_stats.poly_count; ++iObject)
+			{
+				auto end_pos = iObject + 1 < hgt_stats.poly_count?hgt_stats.object_pos[iObject + 1]:std::uint64_t(old_pos);
+				layout.vIndex.emplace_back(indexed_object{hgt_surface_name(hgt_stats.object_surface[iObject]), 
+					hgt_stats.object_pos[iObject], end_pos - hgt_stats.object_pos[iObject]});
+			}
+		}
+		if (fHgtSize)
+		{
+			os.seekp(layout.model_size_pos);
+			this->write(m_size);
+		}
+		os.seekp(layout.object_count_pos);
+		os << layout.object_count + std::uint32_t(hgt_stats.poly_count);
+		os.seekp(old_pos);
+	}
+	//appends the index of the objects written at the end of the output (see model_index.h)
+	void write_object_index(binary_ostream::pos_type model_pos, const std::vector<indexed_object>& vObjects)
+	{
+		auto cNamed = std::count_if(vObjects.begin(), vObjects.end(), [](const indexed_object& object) -> bool {return !object.name.empty();});
+		auto cBuckets = model_index_bucket_count(std::size_t(cNamed));
+		std::vector<std::uint32_t> vBuckets(cBuckets);
+		buf_ostream index;
+		for (std::size_t iObject = 0; iObject < vObjects.size(); ++iObject)
+		{
+			auto& object = vObjects[iObject];
+			index << std::uint64_t(object.offset - model_pos) << object.size;
+			if (object.name.empty())
+				continue;
+			auto iBucket = std::size_t(model_index_name_hash(object.name) & (cBuckets - 1));
+			while (vBuckets[iBucket] != 0)
+				iBucket = (iBucket + 1) & (cBuckets - 1);
+			vBuckets[iBucket] = std::uint32_t(iObject + 1);
+		}
+		index.write(vBuckets.data(), vBuckets.size() * MODEL_INDEX_BUCKET_SIZE);
+		index << std::uint64_t(m_pOs->tellp() - model_pos) << std::uint32_t(vObjects.size()) << cBuckets << MODEL_INDEX_FORMAT_VERSION;
+		index.write(MODEL_INDEX_MAGIC, sizeof(MODEL_INDEX_MAGIC));
+		m_pOs->write(index.data(), index.size());
+	}
+	//adds the model attributes and the objects described by the input, the objects being serialized at pData or in the previous
+	//output, if pData is null
+	void next_serialized_input(const INCREMENTAL_INPUT& input, const std::uint8_t* pData, std::chrono::steady_clock::time_point open_start)
+	{
+		auto iInput = m_vInputs.size();
+		m_vInputs.emplace_back(INCREMENTAL_INPUT{input.path, input.hash, input.model_size, input.model_name, input.model_domain_data});
+		auto parse_start = std::chrono::steady_clock::now();
+		if (m_pStats)
+		{
+			m_pStats->inputs.emplace_back(CONVERSION_STATS::INPUT{std::string(), pData?"precompiled":"unchanged"});
+			m_pStats->inputs.back().open_time = std::chrono::duration<double>(parse_start - open_start).count();
+		}
+		auto set_size = [](double& size, double val, std::string_view strAttribute) -> void
+		{
+			if (!is_specified(val))
+				return;
+			if (is_specified(size))
+				throw ambiguous_specification(strAttribute);
+			size = val;
+		};
+		set_size(m_size.x, input.model_size.x, "cx");
+		set_size(m_size.y, input.model_size.y, "cy");
+		set_size(m_size.z, input.model_size.z, "cz");
+		if (!input.model_name.empty())
+		{
+			if (!m_strModelName.empty())
+				throw ambiguous_specification("name");
+			m_strModelName = input.model_name;
+		}
+		for (const auto& prDomainData:input.model_domain_data)
+		{
+			if (!m_mapDomainData.emplace(prDomainData).second)
+				throw ambiguous_specification("domain");
+		}
+		for (const auto& object:input.objects)
+		{
+			bool fAdded;
+			switch (object.type)
+			{
+			case ObjectPoly:
+			{
+				poly_data poly;
+				poly.name = object.name;
+				poly.iInput = iInput;
+				poly.serialized = serialized_object{pData?pData + object.offset:nullptr, object.offset, object.size};
+				fAdded = this->add_object(std::move(poly));
+				break;
+			}
+			case ObjectSource:
+			{
+				source_data source;
+				source.pos = object.geometry[0];
+				source.dir = object.geometry[1];
+				source.top = object.geometry[2];
+				source.name = object.name;
+				source.iInput = iInput;
+				source.serialized = serialized_object{pData?pData + object.offset:nullptr, object.offset, object.size};
+				fAdded = this->add_object(std::move(source));
+				break;
+			}
+			default:
+			{
+				plain_data plain;
+				plain.pos = object.geometry[0];
+				plain.v1 = object.geometry[1];
+				plain.v2 = object.geometry[2];
+				plain.name = object.name;
+				plain.iInput = iInput;
+				plain.serialized = serialized_object{pData?pData + object.offset:nullptr, object.offset, object.size};
+				fAdded = this->add_object(std::move(plain));
+				break;
+			}
+			}
+			if (!fAdded)
+				throw ambiguous_specification(object.type == ObjectPoly?"polyobject":object.type == ObjectSource?"sourceobject":"plainobject");
+			if (m_pStats)
+			{
+				auto& counts = m_pStats->inputs.back().objects;
+				++(object.type == ObjectPoly?counts.poly_objects:object.type == ObjectSource?counts.source_objects:counts.plain_objects);
+			}
+		}
+		if (m_pStats)
+			m_pStats->inputs.back().parse_time = seconds_since(parse_start);
+	}
+	//returns false, if an object with the same name has already been specified
+	template <class ObjectData>
+	static bool add_object(std::map<std::string, ObjectData>& mapNamed, std::list<ObjectData>& lstUnnamed, ObjectData&& object)
+	{
+		if (object.name.empty())
+		{
+			lstUnnamed.emplace_back(std::move(object));
+			return true;
+		}
+		auto name = object.name;
+		return mapNamed.emplace(std::move(name), std::move(object)).second;
+	}
+	bool add_object(poly_data&& poly)
+	{
+		return add_object(m_polyNamedMap, m_polyUnnamedList, std::move(poly));
+	}
+	bool add_object(source_data&& source)
+	{
+		return add_object(m_srcNamedMap, m_srcUnnamedList, std::move(source));
+	}
+	bool add_object(plain_data&& plain)
+	{
+		return add_object(m_plainNamedMap, m_plainUnnamedList, std::move(plain));
+	}
+	static void describe_object(INCREMENTAL_OBJECT& object, const poly_data&)
+	{
+		object.type = ObjectPoly;
+	}
+	static void describe_object(INCREMENTAL_OBJECT& object, const source_data& source)
+	{
+		object.type = ObjectSource;
+		object.geometry[0] = source.pos;
+		object.geometry[1] = source.dir;
+		object.geometry[2] = source.top;
+	}
+	static void describe_object(INCREMENTAL_OBJECT& object, const plain_data& plain)
+	{
+		object.type = ObjectPlain;
+		object.geometry[0] = plain.pos;
+		object.geometry[1] = plain.v1;
+		object.geometry[2] = plain.v2;
+	}
+	//writes the object and returns the description of its range in the output
+	template <class ObjectData>
+	INCREMENTAL_OBJECT write_object(const ObjectData& object)
+	{
+		INCREMENTAL_OBJECT description;
+		auto offset = m_pOs->tellp();
+		if (!object.serialized)
+			this->write(object);
+		else if (object.serialized->pData)
+			m_pOs->write(object.serialized->pData, std::size_t(object.serialized->size));
+		else
+			this->copy_previous(*object.serialized);
+		description.name = object.name;
+		description.offset = offset;
+		description.size = m_pOs->tellp() - offset;
+		describe_object(description, object);
+		return description;
+	}
+	//writes all objects in the order of the output and passes the index of the input and the description of each object to the sink
+	template <class DescriptionSink>
+	void write_objects(DescriptionSink sink)
+	{
 		for (const auto& poly:m_polyNamedMap)
-			this->write(poly.second);
+			sink(poly.second.iInput, this->write_object(poly.second));
 		for (const auto& poly:m_polyUnnamedList)
-			this->write(poly);
+			sink(poly.iInput, this->write_object(poly));
 		for (const auto& src:m_srcNamedMap)
-			this->write(src.second);
+			sink(src.second.iInput, this->write_object(src.second));
 		for (const auto& src:m_srcUnnamedList)
-			this->write(src);
+			sink(src.iInput, this->write_object(src));
 		for (const auto& plain:m_plainNamedMap)
-			this->write(plain.second);
+			sink(plain.second.iInput, this->write_object(plain.second));
 		for (const auto& plain:m_plainUnnamedList)
-			this->write(plain);
-		if (m_pHgt)
+			sink(plain.iInput, this->write_object(plain));
+	}
+	void copy_previous(const serialized_object& range)
+	{
+		if (!m_pCopyBuf)
+			m_pCopyBuf = std::make_unique<char[]>(PREVIOUS_OUTPUT_COPY_BLOCK);
+		m_isPrevious.seekg(std::streamoff(range.offset));
+		for (auto cbLeft = range.size; cbLeft != 0; )
 		{
-			auto hgt_stats = convert_hgt(m_hgt_res, *m_pHgt, *m_pConv, os);
-			auto old_pos = os.tellp();
-			if (!is_specified(m_size))
+			auto cbBlock = std::size_t(std::min(cbLeft, std::uint64_t(PREVIOUS_OUTPUT_COPY_BLOCK)));
+			if (!m_isPrevious.read(m_pCopyBuf.get(), cbBlock))
+				throw std::runtime_error("Failed to read an object from the previous output");
+			m_pOs->write(m_pCopyBuf.get(), cbBlock);
+			cbLeft -= cbBlock;
+		}
+	}
+	std::vector<HGT_DETAIL_AREA> hgt_detail_areas() const
+	{
+		std::vector<HGT_DETAIL_AREA> areas;
+		auto add_source = [&areas](const source_data& src) -> void
+		{
+			areas.emplace_back(HGT_DETAIL_AREA{src.pos.x, src.pos.y, src.pos.x, src.pos.y});
+		};
+		auto add_plain = [&areas](const plain_data& plain) -> void
+		{
+			auto x = {plain.pos.x, plain.pos.x + plain.v1.x, plain.pos.x + plain.v2.x, plain.pos.x + plain.v1.x + plain.v2.x};
+			auto y = {plain.pos.y, plain.pos.y + plain.v1.y, plain.pos.y + plain.v2.y, plain.pos.y + plain.v1.y + plain.v2.y};
+			areas.emplace_back(HGT_DETAIL_AREA{std::min(x), std::min(y), std::max(x), std::max(y)});
+		};
+		for (const auto& src:m_srcNamedMap)
+			add_source(src.second);
+		for (const auto& src:m_srcUnnamedList)
+			add_source(src);
+		for (const auto& plain:m_plainNamedMap)
+			add_plain(plain.second);
+		for (const auto& plain:m_plainUnnamedList)
+			add_plain(plain);
+		return areas;
+	}
+	//calls the converter of the domain data, accounting for the call in the statistics, if they are collected
+	template <class ConvertFn>
+	bool convert_domain_data(const std::string& strDomain, ConvertFn convert)
+	{
+		if (!m_pStats)
+			return convert();
+		auto start = std::chrono::steady_clock::now();
+		auto fConverted = convert();
+		auto& domain = m_pStats->domains[strDomain];
+		domain.time += seconds_since(start);
+		++(fConverted?domain.converted_blocks:domain.discarded_blocks);
+		return fConverted;
+	}
+	//The domain data identical to the ones converted before are not converted again, the datum converted is shared instead. Only
+	//the domain data buffered entirely are looked up, so that the text need not be copied, unless the domain data are converted.
+	template <DomainDataKind kind>
+	bool convert_shared_domain_data(const std::string& strDomain, const xml::tag& tag, text_istream& is, domain_datum& datum)
+	{
+		std::string_view strElement;
+		if (m_domain_data_cache.is_worth_lookup(kind) && m_converters.is_deterministic(strDomain))
+			strElement = peek_xml_domain_element(is);
+		if (!strElement.empty())
+		{
+			auto pShared = m_domain_data_cache.find(kind, strDomain, strElement);
+			if (pShared != nullptr)
 			{
-				m_size.x = m_hgt_res.cColumns * m_hgt_res.dx;
-				m_size.y = m_hgt_res.cRows * m_hgt_res.dy;
-				m_size.z = hgt_stats.max_height;
-				os.seekp(model_size_pos);
-				this->write(m_size);
-
+				is.rdbuf()->consume(strElement.size());
+				datum = *pShared;
+				if (m_pStats)
+					++m_pStats->domains[strDomain].shared_blocks;
+				return true;
 			}
-			os.seekp(object_count_pos);
-			os << object_count + std::uint32_t(hgt_stats.poly_count);
-			os.seekp(old_pos);
+		}
+		std::string strKey(strElement); //the conversion can read the next buffered block
+		std::vector<std::uint8_t> vData;
+		if (!m_converters.convert<kind>(strDomain, tag, is, vData))
+			return false;
+		datum = domain_datum(std::move(vData));
+		if (!strKey.empty())
+			m_domain_data_cache.insert(kind, strDomain, std::move(strKey), datum);
+		return true;
+	}
+	void count_object(const poly_data& poly)
+	{
+		auto& counts = m_pStats->inputs.back().objects;
+		++counts.poly_objects;
+		counts.faces += poly.lstFaces.size();
+		for (const auto& face:poly.lstFaces)
+			counts.vertices += face.lstVertices.size();
+	}
+	void describe_input_file(const std::string& strPath)
+	{
+		if (!m_pStats)
+			return;
+		auto& input = m_pStats->inputs.back();
+		input.path = strPath;
+		std::error_code ec;
+		auto cb = std::filesystem::file_size(strPath, ec);
+		input.bytes = ec?0:std::uint64_t(cb);
+	}
+	void describe_hgt(const HGT_CONVERSION_STATS& hgt_stats, double time)
+	{
+		auto& hgt = m_pStats->hgt;
+		hgt.converted = true;
+		hgt.cached = hgt_stats.cached;
+		hgt.bytes = std::uint64_t(m_hgt_res.cColumns) * m_hgt_res.cRows * sizeof(std::int16_t);
+		hgt.time = time;
+		hgt.load_time = hgt_stats.load_time;
+		hgt.matrix_init_time = hgt_stats.matrix_init_time;
+		hgt.parse_matrix_times = hgt_stats.parse_times;
+		hgt.objects.poly_objects = hgt_stats.poly_count;
+		hgt.objects.faces = hgt_stats.face_count;
+		hgt.objects.vertices = hgt_stats.vertex_count;
+	}
+	void describe_output(double serialization_time, std::uint64_t cbModel)
+	{
+		m_pStats->serialization_time = serialization_time;
+		m_pStats->model_bytes = cbModel;
+		auto& total = m_pStats->objects;
+		total = m_pStats->hgt.objects;
+		for (const auto& input:m_pStats->inputs)
+		{
+			total.poly_objects += input.objects.poly_objects;
+			total.faces += input.objects.faces;
+			total.vertices += input.objects.vertices;
+			total.source_objects += input.objects.source_objects;
+			total.plain_objects += input.objects.plain_objects;
 		}
 	}
-private:
 	poly_data::face_data convert_face(const xml::tag& rTag, text_istream& is)
 	{
 		poly_data::face_data face;
@@ -233,36 +771,36 @@ private:
 			while ((tag = xml::tag(is)).is_comment()) continue;
 			if (tag.is_comment())
 				continue;
-			else if (tag.name() == L"domain")
+			else if (tag.name() == "domain")
 			{
 				if (tag.is_closing_tag() || tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto strDomain = encode_string(tag.attribute(L"name"));
+				auto strDomain = tag.attribute("name");
 				if (strDomain.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"name");
-				buf_ostream os_buf;
-				if (m_pConv->face_domain_data(strDomain, tag, is, os_buf) 
-					&& !face.mapDomainData.emplace(std::move(strDomain), std::move(os_buf.get_vector())).second)
-					throw ambiguous_specification(is.get_resource_locator(), L"domain");
-			}else if (tag.name() == L"vertex")
+					throw xml_attribute_not_found(is.get_resource_locator(), "name");
+				domain_datum datum;
+				if (this->convert_domain_data(strDomain, [this, &strDomain, &tag, &is, &datum]() -> bool {return this->convert_shared_domain_data<DomainDataKind::Face>(strDomain, tag, is, datum);}) 
+					&& !face.mapDomainData.emplace(std::move(strDomain), std::move(datum)).second)
+					throw ambiguous_specification(is.get_resource_locator(), "domain");
+			}else if (tag.name() == "vertex")
 			{
 				if (!tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 				point_t v;
-				const auto& x = tag.attribute(L"x");
+				const auto& x = tag.attribute("x");
 				if (x.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"x");
+					throw xml_attribute_not_found(is.get_resource_locator(), "x");
 				v.x = std::stod(x);
-				const auto& y = tag.attribute(L"y");
+				const auto& y = tag.attribute("y");
 				if (y.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"y");
+					throw xml_attribute_not_found(is.get_resource_locator(), "y");
 				v.y = std::stod(y);
-				const auto& z = tag.attribute(L"z");
+				const auto& z = tag.attribute("z");
 				if (z.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"z");
+					throw xml_attribute_not_found(is.get_resource_locator(), "z");
 				v.z = std::stod(z);
 				face.lstVertices.emplace_back(std::move(v));
-			}else if (tag.name() == L"face" && tag.is_closing_tag())
+			}else if (tag.name() == "face" && tag.is_closing_tag())
 				break;
 			else
 				throw improper_xml_tag(is.get_resource_locator(), tag.name());
@@ -272,29 +810,29 @@ private:
 	poly_data convert_poly(const xml::tag& rTag, text_istream& is)
 	{
 		poly_data poly;
-		poly.name = encode_string(rTag.attribute(L"name"));
+		poly.name = rTag.attribute("name");
 		while (true)
 		{
 			auto tag = xml::tag(is);
 			if (tag.is_comment())
 				continue;
-			else if (tag.name() == L"domain")
+			else if (tag.name() == "domain")
 			{
 				if (tag.is_closing_tag() || tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto strDomain = encode_string(tag.attribute(L"name"));
+				auto strDomain = tag.attribute("name");
 				if (strDomain.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"name");
-				buf_ostream os_buf;
-				if (m_pConv->poly_domain_data(strDomain, tag, is, os_buf)
-					&& !poly.mapDomainData.emplace(std::move(strDomain), std::move(os_buf.get_vector())).second)
-					throw ambiguous_specification(is.get_resource_locator(), L"domain");
-			}else if (tag.name() == L"face")
+					throw xml_attribute_not_found(is.get_resource_locator(), "name");
+				domain_datum datum;
+				if (this->convert_domain_data(strDomain, [this, &strDomain, &tag, &is, &datum]() -> bool {return this->convert_shared_domain_data<DomainDataKind::Poly>(strDomain, tag, is, datum);})
+					&& !poly.mapDomainData.emplace(std::move(strDomain), std::move(datum)).second)
+					throw ambiguous_specification(is.get_resource_locator(), "domain");
+			}else if (tag.name() == "face")
 			{
 				if (tag.is_closing_tag() || tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 				poly.lstFaces.emplace_back(convert_face(tag, is));
-			}else if (tag.name() == L"polyobject" && tag.is_closing_tag())
+			}else if (tag.name() == "polyobject" && tag.is_closing_tag())
 				break;
 			else
 				throw improper_xml_tag(is.get_resource_locator(), tag.name());
@@ -304,72 +842,72 @@ private:
 	source_data convert_source(const xml::tag& rTag, text_istream& is)
 	{
 		source_data source;
-		source.name = encode_string(rTag.attribute(L"name"));
+		source.name = rTag.attribute("name");
 		while (true)
 		{
 			auto tag = xml::tag(is);
 			if (tag.is_comment())
 				continue;
-			else if (tag.name() == L"domain")
+			else if (tag.name() == "domain")
 			{
 				if (tag.is_closing_tag() || tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto strDomain = encode_string(tag.attribute(L"name"));
+				auto strDomain = tag.attribute("name");
 				if (strDomain.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"name");
-				buf_ostream os_buf;
-				if (m_pConv->source_domain_data(strDomain, tag, is, os_buf)
-					&& !source.mapDomainData.emplace(std::move(strDomain), std::move(os_buf.get_vector())).second)
-					throw ambiguous_specification(is.get_resource_locator(), L"domain");
-			}else if (tag.name() == L"position")
+					throw xml_attribute_not_found(is.get_resource_locator(), "name");
+				domain_datum datum;
+				if (this->convert_domain_data(strDomain, [this, &strDomain, &tag, &is, &datum]() -> bool {return this->convert_shared_domain_data<DomainDataKind::Source>(strDomain, tag, is, datum);})
+					&& !source.mapDomainData.emplace(std::move(strDomain), std::move(datum)).second)
+					throw ambiguous_specification(is.get_resource_locator(), "domain");
+			}else if (tag.name() == "position")
 			{
 				if (!tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto coord = tag.attribute(L"x");
+				auto coord = tag.attribute("x");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"x");
+					throw xml_attribute_not_found(is.get_resource_locator(), "x");
 				source.pos.x = std::stod(coord);
-				coord = tag.attribute(L"y");
+				coord = tag.attribute("y");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"y");
+					throw xml_attribute_not_found(is.get_resource_locator(), "y");
 				source.pos.y = std::stod(coord);
-				coord = tag.attribute(L"z");
+				coord = tag.attribute("z");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"z");
+					throw xml_attribute_not_found(is.get_resource_locator(), "z");
 				source.pos.z = std::stod(coord);
-			}else if (tag.name() == L"direction")
+			}else if (tag.name() == "direction")
 			{
 				if (!tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto coord = tag.attribute(L"x");
+				auto coord = tag.attribute("x");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"x");
+					throw xml_attribute_not_found(is.get_resource_locator(), "x");
 				source.dir.x = std::stod(coord);
-				coord = tag.attribute(L"y");
+				coord = tag.attribute("y");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"y");
+					throw xml_attribute_not_found(is.get_resource_locator(), "y");
 				source.dir.y = std::stod(coord);
-				coord = tag.attribute(L"z");
+				coord = tag.attribute("z");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"z");
+					throw xml_attribute_not_found(is.get_resource_locator(), "z");
 				source.dir.z = std::stod(coord);
-			}else if (tag.name() == L"top")
+			}else if (tag.name() == "top")
 			{
 				if (!tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto coord = tag.attribute(L"x");
+				auto coord = tag.attribute("x");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"x");
+					throw xml_attribute_not_found(is.get_resource_locator(), "x");
 				source.top.x = std::stod(coord);
-				coord = tag.attribute(L"y");
+				coord = tag.attribute("y");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"y");
+					throw xml_attribute_not_found(is.get_resource_locator(), "y");
 				source.top.y = std::stod(coord);
-				coord = tag.attribute(L"z");
+				coord = tag.attribute("z");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"z");
+					throw xml_attribute_not_found(is.get_resource_locator(), "z");
 				source.top.z = std::stod(coord);
-			}else if (tag.name() == L"sourceobject" && tag.is_closing_tag())
+			}else if (tag.name() == "sourceobject" && tag.is_closing_tag())
 				break;
 			else
 				throw improper_xml_tag(is.get_resource_locator(), tag.name());
@@ -379,72 +917,72 @@ private:
 	plain_data convert_plain(const xml::tag& rTag, text_istream& is)
 	{
 		plain_data plain;
-		plain.name = encode_string(rTag.attribute(L"name"));
+		plain.name = rTag.attribute("name");
 		while (true)
 		{
 			auto tag = xml::tag(is);
 			if (tag.is_comment())
 				continue;
-			else if (tag.name() == L"domain")
+			else if (tag.name() == "domain")
 			{
 				if (tag.is_closing_tag() || tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto strDomain = encode_string(tag.attribute(L"name"));
+				auto strDomain = tag.attribute("name");
 				if (strDomain.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"name");
-				buf_ostream os_buf;
-				if (m_pConv->plain_domain_data(strDomain, tag, is, os_buf)
-					&& !plain.mapDomainData.emplace(std::move(strDomain), std::move(os_buf.get_vector())).second)
-					throw ambiguous_specification(is.get_resource_locator(), L"domain");
-			}else if (tag.name() == L"position")
+					throw xml_attribute_not_found(is.get_resource_locator(), "name");
+				domain_datum datum;
+				if (this->convert_domain_data(strDomain, [this, &strDomain, &tag, &is, &datum]() -> bool {return this->convert_shared_domain_data<DomainDataKind::Plain>(strDomain, tag, is, datum);})
+					&& !plain.mapDomainData.emplace(std::move(strDomain), std::move(datum)).second)
+					throw ambiguous_specification(is.get_resource_locator(), "domain");
+			}else if (tag.name() == "position")
 			{
 				if (!tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto coord = tag.attribute(L"x");
+				auto coord = tag.attribute("x");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"x");
+					throw xml_attribute_not_found(is.get_resource_locator(), "x");
 				plain.pos.x = std::stod(coord);
-				coord = tag.attribute(L"y");
+				coord = tag.attribute("y");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"y");
+					throw xml_attribute_not_found(is.get_resource_locator(), "y");
 				plain.pos.y = std::stod(coord);
-				coord = tag.attribute(L"z");
+				coord = tag.attribute("z");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"z");
+					throw xml_attribute_not_found(is.get_resource_locator(), "z");
 				plain.pos.z = std::stod(coord);
-			}else if (tag.name() == L"v1")
+			}else if (tag.name() == "v1")
 			{
 				if (!tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto coord = tag.attribute(L"x");
+				auto coord = tag.attribute("x");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"x");
+					throw xml_attribute_not_found(is.get_resource_locator(), "x");
 				plain.v1.x = std::stod(coord);
-				coord = tag.attribute(L"y");
+				coord = tag.attribute("y");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"y");
+					throw xml_attribute_not_found(is.get_resource_locator(), "y");
 				plain.v1.y = std::stod(coord);
-				coord = tag.attribute(L"z");
+				coord = tag.attribute("z");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"z");
+					throw xml_attribute_not_found(is.get_resource_locator(), "z");
 				plain.v1.z = std::stod(coord);
-			}else if (tag.name() == L"v2")
+			}else if (tag.name() == "v2")
 			{
 				if (!tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto coord = tag.attribute(L"x");
+				auto coord = tag.attribute("x");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"x");
+					throw xml_attribute_not_found(is.get_resource_locator(), "x");
 				plain.v2.x = std::stod(coord);
-				coord = tag.attribute(L"y");
+				coord = tag.attribute("y");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"y");
+					throw xml_attribute_not_found(is.get_resource_locator(), "y");
 				plain.v2.y = std::stod(coord);
-				coord = tag.attribute(L"z");
+				coord = tag.attribute("z");
 				if (coord.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"z");
+					throw xml_attribute_not_found(is.get_resource_locator(), "z");
 				plain.v2.z = std::stod(coord);
-			}else if (tag.name() == L"plainobject" && tag.is_closing_tag())
+			}else if (tag.name() == "plainobject" && tag.is_closing_tag())
 				break;
 			else
 				throw improper_xml_tag(is.get_resource_locator(), tag.name());
@@ -453,90 +991,85 @@ private:
 	}
 	void convert_model(const xml::tag& rModelTag, text_istream& is)
 	{
-		auto strAttr = rModelTag.attribute(L"cx");
+		auto strAttr = rModelTag.attribute("cx");
 		if (!strAttr.empty())
 		{
 			if (is_specified(m_size.x))
-				throw ambiguous_specification(is.get_resource_locator(), L"cx");
-			m_size.x = std::stod(strAttr);
+				throw ambiguous_specification(is.get_resource_locator(), "cx");
+			m_vInputs.back().model_size.x = m_size.x = std::stod(strAttr);
 		}
-		strAttr = rModelTag.attribute(L"cy");
+		strAttr = rModelTag.attribute("cy");
 		if (!strAttr.empty())
 		{
 			if (is_specified(m_size.y))
-				throw ambiguous_specification(is.get_resource_locator(), L"cy");
-			m_size.y = std::stod(strAttr);
+				throw ambiguous_specification(is.get_resource_locator(), "cy");
+			m_vInputs.back().model_size.y = m_size.y = std::stod(strAttr);
 		}
-		strAttr = rModelTag.attribute(L"cz");
+		strAttr = rModelTag.attribute("cz");
 		if (!strAttr.empty())
 		{
 			if (is_specified(m_size.z))
-				throw ambiguous_specification(is.get_resource_locator(), L"cz");
-			m_size.z = std::stod(strAttr);
+				throw ambiguous_specification(is.get_resource_locator(), "cz");
+			m_vInputs.back().model_size.z = m_size.z = std::stod(strAttr);
 		}
-		strAttr = rModelTag.attribute(L"name");
+		strAttr = rModelTag.attribute("name");
 		if (!strAttr.empty())
 		{
 			if (!m_strModelName.empty())
-				throw ambiguous_specification(is.get_resource_locator(), L"name");
-			m_strModelName = encode_string(strAttr);
+				throw ambiguous_specification(is.get_resource_locator(), "name");
+			m_vInputs.back().model_name = m_strModelName = strAttr;
 		}
 		while (true)
 		{
 			auto tag = xml::tag(is);
 			if (tag.is_comment())
 				continue;
-			else if (tag.name() == L"domain")
+			else if (tag.name() == "domain")
 			{
 				if (tag.is_closing_tag() || tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
-				auto strDomain = encode_string(tag.attribute(L"name"));
+				auto strDomain = tag.attribute("name");
 				if (strDomain.empty())
-					throw xml_attribute_not_found(is.get_resource_locator(), L"name");
-				buf_ostream os_buf;
-				if (m_pConv->model_domain_data(strDomain, tag, is, os_buf) 
-					&& !m_mapDomainData.emplace(std::move(strDomain), std::move(os_buf.get_vector())).second)
-					throw ambiguous_specification(is.get_resource_locator(), L"domain");
-			}else if (tag.name() == L"polyobject")
+					throw xml_attribute_not_found(is.get_resource_locator(), "name");
+				std::vector<std::uint8_t> vData;
+				if (this->convert_domain_data(strDomain, [this, &strDomain, &tag, &is, &vData]() -> bool {return m_converters.convert<DomainDataKind::Model>(strDomain, tag, is, vData);}))
+				{
+					auto prInserted = m_mapDomainData.emplace(std::move(strDomain), std::move(vData));
+					if (!prInserted.second)
+						throw ambiguous_specification(is.get_resource_locator(), "domain");
+					m_vInputs.back().model_domain_data.emplace(*prInserted.first);
+				}
+			}else if (tag.name() == "polyobject")
 			{
 				if (tag.is_closing_tag() || tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 				auto poly = convert_poly(tag, is);
-				if (poly.name.empty())
-					m_polyUnnamedList.emplace_back(std::move(poly));
-				else
-				{
-					auto name = poly.name;
-					if (!m_polyNamedMap.emplace(std::move(name), std::move(poly)).second)
-						throw ambiguous_specification(is.get_resource_locator(), tag.name());
-				}
-			}else if (tag.name() == L"sourceobject")
+				poly.iInput = m_vInputs.size() - 1;
+				if (m_pStats)
+					this->count_object(poly);
+				if (!this->add_object(std::move(poly)))
+					throw ambiguous_specification(is.get_resource_locator(), tag.name());
+			}else if (tag.name() == "sourceobject")
 			{
 				if (tag.is_closing_tag() || tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 				auto source = convert_source(tag, is);
-				if (source.name.empty())
-					m_srcUnnamedList.emplace_back(std::move(source));
-				else
-				{
-					auto name = source.name;
-					if (!m_srcNamedMap.emplace(std::move(name), std::move(source)).second)
-						throw ambiguous_specification(is.get_resource_locator(), tag.name());
-				}
-			}else if (tag.name() == L"plainobject")
+				source.iInput = m_vInputs.size() - 1;
+				if (m_pStats)
+					++m_pStats->inputs.back().objects.source_objects;
+				if (!this->add_object(std::move(source)))
+					throw ambiguous_specification(is.get_resource_locator(), tag.name());
+			}else if (tag.name() == "plainobject")
 			{
 				if (tag.is_closing_tag() || tag.is_unary_tag())
 					throw improper_xml_tag(is.get_resource_locator(), tag.name());
 				auto plain = convert_plain(tag, is);
-				if (plain.name.empty())
-					m_plainUnnamedList.emplace_back(std::move(plain));
-				else
-				{
-					auto name = plain.name;
-					if (!m_plainNamedMap.emplace(std::move(name), std::move(plain)).second)
-						throw ambiguous_specification(is.get_resource_locator(), tag.name());
-				}
-			}else if (tag.name() == L"model" && tag.is_closing_tag())
+				plain.iInput = m_vInputs.size() - 1;
+				if (m_pStats)
+					++m_pStats->inputs.back().objects.plain_objects;
+				if (!this->add_object(std::move(plain)))
+					throw ambiguous_specification(is.get_resource_locator(), tag.name());
+			}else if (tag.name() == "model" && tag.is_closing_tag())
 				break;
 			else
 				throw improper_xml_tag(is.get_resource_locator(), tag.name());
@@ -568,14 +1101,19 @@ private:
 		for (const auto& elem:cont)
 			this->write(os, elem);
 	}
-	void write(binary_ostream& os, const domain_data_map& mpDomainData) const
+	//only the domain data of the domain of the output being written are written
+	template <class DomainData>
+	void write(binary_ostream& os, const std::map<std::string, DomainData>& mpDomainData) const
 	{
-		os << std::uint32_t(mpDomainData.size());
-		for (const auto& prDomainData:mpDomainData)
+		auto itDomainData = mpDomainData.find(m_strDomain);
+		if (itDomainData == mpDomainData.end())
 		{
-			this->write_sequence(os, prDomainData.first);
-			this->write_sequence(os, prDomainData.second);
+			os << std::uint32_t(0);
+			return;
 		}
+		os << std::uint32_t(1);
+		this->write_sequence(os, itDomainData->first);
+		this->write_sequence(os, itDomainData->second);
 	}
 	void write_object_generic_part(binary_ostream& os, std::string_view strObjectName, const domain_data_map& mpDomainData, ObjectTypeId type_id) const
 	{
@@ -643,20 +1181,70 @@ private:
 
 namespace Implementation
 {
-	std::unique_ptr<conversion_state> xml2bin_set(const std::string& domain, binary_ostream& os)
+	std::unique_ptr<conversion_state> xml2bin_set(const std::string& domain, binary_ostream& os, const MODEL_OUTPUT_OPTIONS& output_options)
+	{
+		return std::unique_ptr<conversion_state>(new conversion_state_impl(domain, os, output_options));
+	}
+	std::unique_ptr<conversion_state> xml2bin_set(const std::vector<DOMAIN_OUTPUT>& outputs, const MODEL_OUTPUT_OPTIONS& output_options)
 	{
-		return std::unique_ptr<conversion_state>(new conversion_state_impl(domain, os));
+		return std::unique_ptr<conversion_state>(new conversion_state_impl(outputs, output_options));
 	}
 	void xml2bin_next_xml(const std::unique_ptr<conversion_state>& state, text_istream& is)
 	{
 		static_cast<conversion_state_impl*>(state.get())->next_xml(is);
 	}
-	void xml2bin_next_hgt(const std::unique_ptr<conversion_state>& state, const HGT_RESOLUTION_DATA& resolution, std::istream& is)
+	void xml2bin_next_hgt(const std::unique_ptr<conversion_state>& state, const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, std::istream& is)
 	{
-		static_cast<conversion_state_impl*>(state.get())->next_hgt(resolution, is);
+		static_cast<conversion_state_impl*>(state.get())->next_hgt(resolution, options, is);
 	}
 	void xml2bin_finalize(const std::unique_ptr<conversion_state>& state)
 	{
 		static_cast<conversion_state_impl*>(state.get())->finalize();
 	}
+	void xml2bin_next_file(const std::unique_ptr<conversion_state>& state, const std::string& strPath)
+	{
+		static_cast<conversion_state_impl*>(state.get())->next_file(strPath);
+	}
+	void xml2bin_precompile(const std::unique_ptr<conversion_state>& state)
+	{
+		static_cast<conversion_state_impl*>(state.get())->precompile();
+	}
+	void xml2bin_incremental(const std::string& strDomain, const std::string& strManifest, const std::vector<std::string>& vXml, 
+		const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, std::istream* pHgt, const std::string& strOutput, 
+		const MODEL_OUTPUT_OPTIONS& output_options)
+	{
+		//the previous output is read while the new one is written, hence the new one replaces it afterwards
+		auto strTempOutput = strOutput + '.' + std::to_string(std::random_device()()) + ".tmp";
+		INCREMENTAL_MANIFEST manifest;
+		try
+		{
+			binary_ofstream os(strTempOutput, true);
+			if (os.fail())
+				throw std::runtime_error("Failed to create the file \"" + strTempOutput + "\".");
+			conversion_state_impl state(strDomain, os, output_options);
+			state.load_manifest(strManifest, strOutput);
+			for (const auto& strXml:vXml)
+				state.next_file(strXml);
+			if (pHgt)
+				state.next_hgt(resolution, options, *pHgt);
+			state.finalize();
+			if (os.fail())
+				throw std::runtime_error("Failed to write the file \"" + strTempOutput + "\".");
+			manifest = state.incremental_manifest();
+		}catch (...)
+		{
+			std::remove(strTempOutput.c_str());
+			throw;
+		}
+		//a manifest must never describe an output other than the one it was written for
+		std::remove(strManifest.c_str());
+		std::error_code ec;
+		std::filesystem::rename(strTempOutput, strOutput, ec);
+		if (ec)
+		{
+			std::remove(strTempOutput.c_str());
+			throw std::runtime_error("Failed to replace the file \"" + strOutput + "\".");
+		}
+		write_incremental_manifest(strManifest, manifest);
+	}
 } //Implementation
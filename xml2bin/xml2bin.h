@@ -7,6 +7,7 @@
 #include <memory>
 #include <fstream>
 #include <stack>
+#include <vector>
 #include <binary_streams.h>
 #include <text_streams.h>
 
@@ -24,18 +25,67 @@ struct HGT_RESOLUTION_DATA
 static constexpr HGT_RESOLUTION_DATA HGT_1 = {30, 30, 3601, 3601};
 static constexpr HGT_RESOLUTION_DATA HGT_3 = {90, 90, 1201, 1201};
 
+struct HGT_CONVERSION_OPTIONS
+{
+	//if set, each HGT surface is written as an ObjectIndexedPoly object: a table of unique vertices followed by the faces
+	//specified by the indices into the table. Otherwise each face specifies the coordinates of its vertices (ObjectPoly).
+	bool fIndexedFaces = false;
+	//if positive, the surfaces are approximated by a right-triangulated irregular network with the vertical error (in meters) not
+	//exceeding the tolerance. Otherwise only the exactly coplanar faces are merged.
+	double eHeightTolerance = 0;
+	//if positive, together with eHeightTolerance, the surfaces keep the full resolution within the radius (in meters) around the
+	//sources and the plains, and are simplified with eHeightTolerance further out
+	double eDetailRadius = 0;
+	//if not empty, specifies a directory of the persistent cache of the converted HGT data
+	std::string strCacheDirectory;
+};
+
+struct CONVERSION_STATS; //conversion_stats.h
+
+struct MODEL_OUTPUT_OPTIONS
+{
+	//if set, an index of the objects (see model_index.h) is appended to the binary model, so that readers can locate the objects
+	//and find them by names without walking through the model
+	bool fObjectIndex = false;
+	//if not null, receives the counters and the durations of the stages of the conversion
+	CONVERSION_STATS* pStats = nullptr;
+	//paths of the shared objects implementing the converters of the domains in addition to the built-in ones (see domain_plugin.h)
+	std::vector<std::string> vDomainPlugins;
+};
+
+//an output of the conversion performed for several domains at once
+struct DOMAIN_OUTPUT
+{
+	std::string domain;
+	binary_ostream* pOs;
+};
+
 namespace Implementation
 {
 	struct conversion_state {virtual inline ~conversion_state() {}};
-	std::unique_ptr<conversion_state> xml2bin_set(const std::string& domain, binary_ostream& os);
+	std::unique_ptr<conversion_state> xml2bin_set(const std::string& domain, binary_ostream& os, const MODEL_OUTPUT_OPTIONS& output_options = MODEL_OUTPUT_OPTIONS());
+	//the inputs are parsed once, and the model of each domain is written to its output. Precompiled models cannot be the inputs, and
+	//neither the precompilation nor the incremental conversion is supported.
+	std::unique_ptr<conversion_state> xml2bin_set(const std::vector<DOMAIN_OUTPUT>& outputs, const MODEL_OUTPUT_OPTIONS& output_options = MODEL_OUTPUT_OPTIONS());
 	void xml2bin_next_xml(const std::unique_ptr<conversion_state>& state, text_istream& is);
-	void xml2bin_next_hgt(const std::unique_ptr<conversion_state>& state, const HGT_RESOLUTION_DATA& resolution, std::istream& is);
+	void xml2bin_next_hgt(const std::unique_ptr<conversion_state>& state, const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, std::istream& is);
 	void xml2bin_finalize(const std::unique_ptr<conversion_state>& state);
+	//the file is either an XML file or a precompiled model
+	void xml2bin_next_file(const std::unique_ptr<conversion_state>& state, const std::string& strPath);
+	//writes a precompiled model of the inputs instead of finalizing the binary model
+	void xml2bin_precompile(const std::unique_ptr<conversion_state>& state);
+	//converts the XML files to the output and updates the manifest describing it. The objects of the files which are unchanged
+	//since the conversion described by the manifest are copied from the previous output rather than converted again.
+	void xml2bin_incremental(const std::string& strDomain, const std::string& strManifest, const std::vector<std::string>& vXml, 
+		const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, std::istream* pHgt, const std::string& strOutput, 
+		const MODEL_OUTPUT_OPTIONS& output_options);
 
 	template <class T>
 	struct is_input_stream:std::is_base_of<std::istream, T> {};
 	template <class T>
 	struct is_text_input_stream:std::is_base_of<text_istream, T> {};
+	template <class T>
+	struct is_path:std::is_convertible<const T&, std::string> {};
 }
 
 template <class DomainString, class InputIteratorXmlBegin, class InputIteratorXmlEnd>
@@ -53,7 +103,8 @@ auto xml2bin(const DomainString& strDomain, InputIteratorXmlBegin xml_is_begin,
 }
 
 template <class DomainString, class InputIteratorXmlBegin, class InputIteratorXmlEnd>
-auto hgtxml2bin(const DomainString& strDomain, const HGT_RESOLUTION_DATA& resolution, std::istream& isHgt, InputIteratorXmlBegin xml_is_begin, InputIteratorXmlEnd xml_is_end, binary_ostream& os)
+auto hgtxml2bin(const DomainString& strDomain, const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, std::istream& isHgt, 
+		InputIteratorXmlBegin xml_is_begin, InputIteratorXmlEnd xml_is_end, binary_ostream& os)
 	-> std::enable_if_t<
 		Implementation::is_text_input_stream<typename std::iterator_traits<InputIteratorXmlBegin>::value_type>::value &&
 		Implementation::is_text_input_stream<typename std::iterator_traits<InputIteratorXmlEnd>::value_type>::value
@@ -63,8 +114,117 @@ auto hgtxml2bin(const DomainString& strDomain, const HGT_RESOLUTION_DATA& resolu
 	auto state = xml2bin_set(strDomain, os);
 	for (std::common_type_t<InputIteratorXmlBegin, InputIteratorXmlEnd> it = xml_is_begin; it != xml_is_end; ++it)
 		xml2bin_next_xml(state, *it);
-	xml2bin_next_hgt(state, resolution, isHgt);
+	xml2bin_next_hgt(state, resolution, options, isHgt);
 	xml2bin_finalize(state);
 }
 
+template <class DomainString, class InputIteratorXmlBegin, class InputIteratorXmlEnd>
+auto hgtxml2bin(const DomainString& strDomain, const HGT_RESOLUTION_DATA& resolution, std::istream& isHgt, InputIteratorXmlBegin xml_is_begin, InputIteratorXmlEnd xml_is_end, binary_ostream& os)
+	-> std::enable_if_t<
+		Implementation::is_text_input_stream<typename std::iterator_traits<InputIteratorXmlBegin>::value_type>::value &&
+		Implementation::is_text_input_stream<typename std::iterator_traits<InputIteratorXmlEnd>::value_type>::value
+	>
+{
+	hgtxml2bin(strDomain, resolution, HGT_CONVERSION_OPTIONS(), isHgt, xml_is_begin, xml_is_end, os);
+}
+
+//the paths specify XML files and/or precompiled models
+template <class DomainString, class InputIteratorPathBegin, class InputIteratorPathEnd>
+auto xml2bin(const DomainString& strDomain, InputIteratorPathBegin path_begin, InputIteratorPathEnd path_end, binary_ostream& os, 
+		const MODEL_OUTPUT_OPTIONS& output_options = MODEL_OUTPUT_OPTIONS())
+	-> std::enable_if_t<
+		Implementation::is_path<typename std::iterator_traits<InputIteratorPathBegin>::value_type>::value &&
+		Implementation::is_path<typename std::iterator_traits<InputIteratorPathEnd>::value_type>::value
+	>
+{
+	using namespace Implementation;
+	auto state = xml2bin_set(strDomain, os, output_options);
+	for (std::common_type_t<InputIteratorPathBegin, InputIteratorPathEnd> it = path_begin; it != path_end; ++it)
+		xml2bin_next_file(state, *it);
+	xml2bin_finalize(state);
+}
+
+template <class DomainString, class InputIteratorPathBegin, class InputIteratorPathEnd>
+auto hgtxml2bin(const DomainString& strDomain, const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, std::istream& isHgt, 
+		InputIteratorPathBegin path_begin, InputIteratorPathEnd path_end, binary_ostream& os, const MODEL_OUTPUT_OPTIONS& output_options = MODEL_OUTPUT_OPTIONS())
+	-> std::enable_if_t<
+		Implementation::is_path<typename std::iterator_traits<InputIteratorPathBegin>::value_type>::value &&
+		Implementation::is_path<typename std::iterator_traits<InputIteratorPathEnd>::value_type>::value
+	>
+{
+	using namespace Implementation;
+	auto state = xml2bin_set(strDomain, os, output_options);
+	for (std::common_type_t<InputIteratorPathBegin, InputIteratorPathEnd> it = path_begin; it != path_end; ++it)
+		xml2bin_next_file(state, *it);
+	xml2bin_next_hgt(state, resolution, options, isHgt);
+	xml2bin_finalize(state);
+}
+
+//Converts the XML files for several domains at once: the files are parsed once, and the model of each domain is written to its
+//output. The geometry of the objects and the HGT surfaces are shared by the outputs, which differ in the domain data only.
+template <class InputIteratorPathBegin, class InputIteratorPathEnd>
+auto xml2bin_domains(const std::vector<DOMAIN_OUTPUT>& outputs, InputIteratorPathBegin path_begin, InputIteratorPathEnd path_end, 
+		const MODEL_OUTPUT_OPTIONS& output_options = MODEL_OUTPUT_OPTIONS())
+	-> std::enable_if_t<
+		Implementation::is_path<typename std::iterator_traits<InputIteratorPathBegin>::value_type>::value &&
+		Implementation::is_path<typename std::iterator_traits<InputIteratorPathEnd>::value_type>::value
+	>
+{
+	using namespace Implementation;
+	auto state = xml2bin_set(outputs, output_options);
+	for (std::common_type_t<InputIteratorPathBegin, InputIteratorPathEnd> it = path_begin; it != path_end; ++it)
+		xml2bin_next_file(state, *it);
+	xml2bin_finalize(state);
+}
+
+template <class InputIteratorPathBegin, class InputIteratorPathEnd>
+auto hgtxml2bin_domains(const std::vector<DOMAIN_OUTPUT>& outputs, const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, 
+		std::istream& isHgt, InputIteratorPathBegin path_begin, InputIteratorPathEnd path_end, const MODEL_OUTPUT_OPTIONS& output_options = MODEL_OUTPUT_OPTIONS())
+	-> std::enable_if_t<
+		Implementation::is_path<typename std::iterator_traits<InputIteratorPathBegin>::value_type>::value &&
+		Implementation::is_path<typename std::iterator_traits<InputIteratorPathEnd>::value_type>::value
+	>
+{
+	using namespace Implementation;
+	auto state = xml2bin_set(outputs, output_options);
+	for (std::common_type_t<InputIteratorPathBegin, InputIteratorPathEnd> it = path_begin; it != path_end; ++it)
+		xml2bin_next_file(state, *it);
+	xml2bin_next_hgt(state, resolution, options, isHgt);
+	xml2bin_finalize(state);
+}
+
+//writes a precompiled model of the objects and the model attributes specified by the files, which can be passed to the conversion
+//instead of the files later on
+template <class DomainString, class InputIteratorPathBegin, class InputIteratorPathEnd>
+auto xml2bin_precompile(const DomainString& strDomain, InputIteratorPathBegin path_begin, InputIteratorPathEnd path_end, binary_ostream& os, 
+		const MODEL_OUTPUT_OPTIONS& output_options = MODEL_OUTPUT_OPTIONS())
+	-> std::enable_if_t<
+		Implementation::is_path<typename std::iterator_traits<InputIteratorPathBegin>::value_type>::value &&
+		Implementation::is_path<typename std::iterator_traits<InputIteratorPathEnd>::value_type>::value
+	>
+{
+	using namespace Implementation;
+	auto state = xml2bin_set(strDomain, os, output_options);
+	for (std::common_type_t<InputIteratorPathBegin, InputIteratorPathEnd> it = path_begin; it != path_end; ++it)
+		xml2bin_next_file(state, *it);
+	xml2bin_precompile(state);
+}
+
+template <class DomainString, class InputIteratorPathBegin, class InputIteratorPathEnd>
+void xml2bin_incremental(const DomainString& strDomain, const std::string& strManifest, InputIteratorPathBegin xml_path_begin, InputIteratorPathEnd xml_path_end, 
+	const std::string& strOutput, const MODEL_OUTPUT_OPTIONS& output_options = MODEL_OUTPUT_OPTIONS())
+{
+	Implementation::xml2bin_incremental(strDomain, strManifest, std::vector<std::string>(xml_path_begin, xml_path_end), 
+		HGT_RESOLUTION_DATA(), HGT_CONVERSION_OPTIONS(), nullptr, strOutput, output_options);
+}
+
+template <class DomainString, class InputIteratorPathBegin, class InputIteratorPathEnd>
+void hgtxml2bin_incremental(const DomainString& strDomain, const std::string& strManifest, const HGT_RESOLUTION_DATA& resolution, const HGT_CONVERSION_OPTIONS& options, 
+	std::istream& isHgt, InputIteratorPathBegin xml_path_begin, InputIteratorPathEnd xml_path_end, const std::string& strOutput, 
+	const MODEL_OUTPUT_OPTIONS& output_options = MODEL_OUTPUT_OPTIONS())
+{
+	Implementation::xml2bin_incremental(strDomain, strManifest, std::vector<std::string>(xml_path_begin, xml_path_end), 
+		resolution, options, std::addressof(isHgt), strOutput, output_options);
+}
+
 #endif //BIN2TEXT_H_